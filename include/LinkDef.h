@@ -42,6 +42,7 @@
 #pragma link C++ namespace TCConfig;
 #pragma link C++ namespace TCUtils;
 #pragma link C++ namespace TCFitUtils;
+#pragma link C++ namespace TCThreadPool;
 #pragma link C++ class TCFileManager+;
 #pragma link C++ class TCReadConfig+;
 #pragma link C++ class TCConfigElement+;
@@ -59,6 +60,14 @@
 #pragma link C++ class TCCalibration+;
 #pragma link C++ class TCCalibData+;
 #pragma link C++ class TCCalibType+;
+#pragma link C++ class TCSetCatalog+;
+#pragma link C++ class TCCalibSnapshot+;
+#pragma link C++ class TCRunHistoStore+;
+#pragma link C++ class TCElementStore+;
+#pragma link C++ class TCHistoRows+;
+#pragma link C++ class TCCalibClient+;
+#pragma link C++ class TCQueryStats+;
+#pragma link C++ class TCBufferedResult+;
 #pragma link C++ class TCCalib+;
 #pragma link C++ class TCCalibPed+;
 #pragma link C++ class TCCalibDiscrThr+;
@@ -118,6 +127,7 @@
 // Run calibration classes
 #pragma link C++ class TCARFileLoader+;
 #pragma link C++ class TCARHistoLoader+;
+#pragma link C++ class TCARKeyIndex+;
 #pragma link C++ class TCBadElement+;
 #pragma link C++ class TCBadScRElement+;
 #pragma link C++ class TCCalibRun+;
@@ -20,6 +20,7 @@
 #include "TString.h"
 
 class TFile;
+class TCARKeyIndex;
 
 class TCARFileLoader
 {
@@ -32,20 +33,33 @@ protected:
 
     Int_t fNFiles;                      // number of files (= number of runs)
     TFile** fFiles;          //[fNRuns]    list of files
-    Int_t fNOpenFiles;                  // number of files opend
+    Int_t fNOpenFiles;                  // number of files opend (or available in pool mode)
+
+    Int_t fMaxOpenFiles;                // maximum number of open files (0: unlimited, -1: from config)
+    Int_t fNPooledFiles;                // number of currently open files in pool mode
+    Bool_t* fFileAvail;      //[fNFiles]   file availability flags (pool mode)
+    Long64_t* fFileAccess;   //[fNFiles]   last access of the files (pool mode)
+    Long64_t fNFileAccess;              // file access counter (pool mode)
+    Bool_t fKeepKeyIndex;               // keep the key index of closed files (pool mode)
+    TCARKeyIndex** fKeyIndex; //[fNFiles]  key indices of the files
 
     void ResetInputFilePathPatt() { if (fInputFilePathPatt) delete fInputFilePathPatt; fInputFilePathPatt = 0; };
     void ResetRunsList() { if (fRuns) delete [] fRuns; fNRuns = 0; fRuns = 0; };
     void ResetFileList();
 
     Bool_t CreateFileList();
+    void CloseLeastRecentFile();
+    Bool_t MayContainKey(Int_t index, const Char_t* name) const;
 
 public:
     TCARFileLoader()
       : fInputFilePathPatt(0),
         fNRuns(0), fRuns(0),
         fNFiles(0), fFiles(0),
-        fNOpenFiles(0) { };
+        fNOpenFiles(0),
+        fMaxOpenFiles(-1), fNPooledFiles(0),
+        fFileAvail(0), fFileAccess(0), fNFileAccess(0),
+        fKeepKeyIndex(kFALSE), fKeyIndex(0) { };
     TCARFileLoader(const Char_t* inputfilepathpatt);
     TCARFileLoader(Int_t nruns, const Int_t* runs, const Char_t* inputfilepathpatt = 0);
     virtual ~TCARFileLoader();
@@ -70,8 +84,17 @@ public:
     Int_t GetNRuns() const { return fNRuns; };
     const Int_t* GetRuns() const { return fRuns; };
 
+    void SetMaxOpenFiles(Int_t n) { fMaxOpenFiles = n > 0 ? n : 0; };
+    Int_t GetMaxOpenFiles() const { return fMaxOpenFiles; };
+    void SetKeepKeyIndex(Bool_t keep) { fKeepKeyIndex = keep; };
+    Bool_t GetKeepKeyIndex() const { return fKeepKeyIndex; };
+    Bool_t IsPoolMode() const { return fMaxOpenFiles > 0; };
+
     Int_t GetNFiles() const { return fNFiles; };
-    TFile * const * GetFiles() const { return fFiles; };
+    TFile * const * GetFiles() const;
+    TFile* GetFile(Int_t index);
+    Bool_t IsFileAvailable(Int_t index) const;
+    TCARKeyIndex* GetKeyIndex(Int_t index);
     Int_t GetNOpenFiles() const { return fNOpenFiles; };
 
     Bool_t LoadFiles() { return fFiles ? kTRUE : CreateFileList(); };
@@ -19,30 +19,39 @@
 #include "TCARFileLoader.h"
 
 class TH1;
+class TH1D;
 class TH2D;
+class TObjArray;
 
 class TCARHistoLoader : public TCARFileLoader
 {
 
 private:
     TDirectory* fHistoDirectory;        // histo ownership
+    TString fElementFilePathPatt;       // element-sliced file path pattern
+    Bool_t fStreamProj;                 // streaming projection mode
+
+    TH1D** ProjectAll(const Char_t* hname, Int_t axis, Int_t fbin1, Int_t lbin1,
+                      Int_t fbin2, Int_t lbin2, Bool_t errors);
 
 protected:
 
     void SetHistoName(TH1* h, const Char_t* hnamepatt, Int_t index);
+    static TH1** ReadHistos(const TFile* f, const TObjArray* names, Int_t& nhistos, Bool_t detach = kTRUE);
 
 public:
     static const Int_t kLastBin;        // last bin of axis marker
+    static const Int_t kNRunsPerTask;   // runs projected per parallel task
 
     TCARHistoLoader()
       : TCARFileLoader(),
-        fHistoDirectory(0) { }
+        fHistoDirectory(0), fStreamProj(kFALSE) { }
     TCARHistoLoader(const Char_t* inputfilepathpatt)
       : TCARFileLoader(inputfilepathpatt),
-        fHistoDirectory(0) { }
+        fHistoDirectory(0), fStreamProj(kFALSE) { }
     TCARHistoLoader(Int_t nruns, const Int_t* runs, const Char_t* inputfilepathpatt = 0)
       : TCARFileLoader(nruns, runs, inputfilepathpatt),
-        fHistoDirectory(0) { }
+        fHistoDirectory(0), fStreamProj(kFALSE) { }
     virtual ~TCARHistoLoader() { }
 
     static TH1* GetHisto(const TFile* f, const Char_t* hname, Bool_t detach = kTRUE);
@@ -51,14 +60,25 @@ public:
     void SetHistoDirectory(TDirectory* histodir) { fHistoDirectory = histodir; };
     const TDirectory* GetHistoDirectory() const { return fHistoDirectory; };
 
+    void SetStreamingProjection(Bool_t s) { fStreamProj = s; };
+    Bool_t GetStreamingProjection() const { return fStreamProj; };
+
+    void SetElementFilePathPatt(const Char_t* patt) { fElementFilePathPatt = patt ? patt : ""; };
+    const Char_t* GetElementFilePathPatt() const { return fElementFilePathPatt.Data(); };
+
     TH1* GetHistoForRun(const Char_t* hname, Int_t runnumber, const Char_t* houtnamepatt = 0);
     TH1* GetHistoForIndex(const Char_t* hname, Int_t index, const Char_t* houtnamepatt = 0);
 
     TH1** GetHistosForRun(const Char_t* hpatt, Int_t runnumber, Int_t& nhistos, const Char_t* houtnamepatt = 0);
     TH1** GetHistosForIndex(const Char_t* hpatt, Int_t index, Int_t& nhistos, const Char_t* houtnamepatt = 0);
+    TH1** GetHistosForIndex(Int_t npatt, const Char_t** hpatts, Int_t index, Int_t& nhistos,
+                            const Char_t* houtnamepatt = 0);
 
     TH1* CreateHistoSum(const Char_t* hname, const Char_t* houtnamepatt = 0);
 
+    TH1* GetElementHistoForIndex(const Char_t* hname, Int_t elem, Int_t index, const Char_t* houtnamepatt = 0);
+    TH1* CreateElementHistoSum(const Char_t* hname, Int_t elem, const Char_t* houtnamepatt = 0);
+
     TH1** CreateHistoArray(const Char_t* hname, const Char_t* houtnamepatt = 0);
     TH1** CreateHistoSumArray(const Char_t* hpatt, Int_t& nhistos, const Char_t* houtnamepatt = 0);
 
@@ -67,6 +87,9 @@ public:
                                  Int_t fbin2 = 1, Int_t lbin2 = kLastBin,
                                  Option_t* option = "", const Char_t* houtnamepatt = 0);
 
+    static TH1D* ProjectBins(const TH1* h, Int_t axis, Int_t fbin1, Int_t lbin1,
+                             Int_t fbin2, Int_t lbin2, Bool_t errors, const Char_t* name);
+
     TH2D* CreateHistoOfProj(const Char_t* hname, const Char_t projaxis = 'X',
                             Int_t fbin1 = 1, Int_t lbin1 = kLastBin,
                             Int_t fbin2 = 1, Int_t lbin2 = kLastBin,
@@ -0,0 +1,62 @@
+/************************************************************************
+ * Author: Thomas Strub                                                 *
+ ************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCARKeyIndex                                                         //
+//                                                                      //
+// Key index of an AR file.                                             //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCARKEYINDEX_H
+#define TCARKEYINDEX_H
+
+#include "TObject.h"
+
+class TDirectory;
+class TList;
+class THashList;
+class TObjArray;
+
+class TCARKeyIndex : public TObject
+{
+
+private:
+    THashList* fNames;                  // names of all keys
+    TList* fHistos;                     // sorted names of the histogram keys
+    Int_t fNHistos;                     // number of histogram keys
+    THashList* fClasses;                // histogram names grouped by class
+    THashList* fHistoClasses;           // names of the histogram classes
+    THashList* fPatterns;               // memoised pattern matches
+
+    TCARKeyIndex(const TCARKeyIndex&);
+    TCARKeyIndex& operator=(const TCARKeyIndex&);
+
+public:
+    enum { kIsHisto = BIT(14) };        // histogram key name marker
+
+    TCARKeyIndex()
+      : TObject(),
+        fNames(0), fHistos(0), fNHistos(0),
+        fClasses(0), fHistoClasses(0), fPatterns(0) { }
+    TCARKeyIndex(const TDirectory* dir);
+    virtual ~TCARKeyIndex();
+
+    Int_t GetNHistos() const { return fNHistos; }
+    const TList* GetHistos() const { return fHistos; }
+    const TList* GetHistosOfClass(const Char_t* cl) const;
+
+    Bool_t HasKey(const Char_t* name) const;
+    Bool_t IsHisto(const Char_t* name) const;
+
+    const TObjArray* Match(const Char_t* hpatt);
+    TObjArray* Match(Int_t npatt, const Char_t** hpatts);
+
+    ClassDef(TCARKeyIndex, 0) // Key index of an AR file
+};
+
+#endif
+
@@ -0,0 +1,42 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCBufferedResult                                                     //
+//                                                                      //
+// SQL query result holding all rows in memory.                         //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCBUFFEREDRESULT_H
+#define TCBUFFEREDRESULT_H
+
+#include "TSQLResult.h"
+#include "TList.h"
+#include "TObjArray.h"
+
+class TCBufferedResult : public TSQLResult
+{
+
+private:
+    TObjArray fFieldNames;                  // field names
+    TList fRows;                            // rows not yet returned
+
+public:
+    TCBufferedResult() : TSQLResult() { fRowCount = 0; }
+    TCBufferedResult(TSQLResult* res);
+    virtual ~TCBufferedResult();
+
+    virtual void Close(Option_t* option = "");
+    virtual Int_t GetFieldCount() { return fFieldNames.GetEntriesFast(); }
+    virtual const char* GetFieldName(Int_t field);
+    virtual TSQLRow* Next();
+
+    ClassDef(TCBufferedResult, 0) // SQL query result held in memory
+};
+
+#endif
+
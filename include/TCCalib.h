@@ -19,6 +19,8 @@
 class TH1;
 class TF1;
 class TCanvas;
+class TCHistoRows;
+class TArrayD;
 
 class TCCalib : public TNamed
 {
@@ -39,6 +41,7 @@ protected:
     Double_t fConvergenceFactor;    // factor to control convergence
 
     TH1* fMainHisto;                // main histogram
+    TCHistoRows* fMainRows;         // element rows of the main histogram
     TH1* fFitHisto;                 // fitting histogram
     TF1* fFitFunc;                  // fitting function
 
@@ -51,13 +54,34 @@ protected:
     Bool_t fTimerRunning;           // timer running state
 
     Bool_t fIsReFit;                // re-fit flag
+    Bool_t fBatchMode;              // headless batch mode (no fitting canvas, no drawing)
+    Bool_t fPeakSeed;               // seed the fits with analytic peak estimates
+    Int_t* fNFit;                   //[fNelem] number of fits of the last fit of each element
+    TArrayD* fFitPar;               //[fNelem] fit parameters of each element
+    TArrayD* fSeedPar;              //[fNelem] fit parameters of the previous iteration
 
     Int_t fNIgnore;                 // number of elements to ignore
     Int_t* fIgnore;                 // list of elements to ignore
 
+    static const Int_t kNElemPerTask;   // elements fitted per parallel task
+
     virtual void Init() = 0;
     virtual void Fit(Int_t elem) = 0;
     virtual void Calculate(Int_t elem) = 0;
+    virtual Bool_t IsParallelFitSupported() const { return kFALSE; }
+    TH1* GetElementHisto(Int_t elem, const Char_t* name);
+    virtual TH1* CreateFitHisto(Int_t elem);
+    virtual TF1* CreateFitFunc(Int_t elem, TH1* h) { return 0; }
+    virtual Double_t FitElement(Int_t elem, TH1* h, TF1* func) { return 0; }
+    virtual void SetFitResult(Int_t elem, TH1* h, TF1* func, Double_t pos);
+    Bool_t ProcessAllParallel();
+    TString GetFitParFile() const;
+    void ReadFitPar();
+    void WriteFitPar();
+    Bool_t SeedFitFunc(Int_t elem, TF1* func) const;
+    static void FitTask(Int_t task, void* arg);
+    TCanvas* CreateCanvas(const Char_t* name, const Char_t* title,
+                          Int_t wtopx, Int_t wtopy, UInt_t ww, UInt_t wh);
     void SaveCanvas(TCanvas* c, const Char_t* name);
     Bool_t IsIgnored(Int_t elem);
 
@@ -70,11 +94,12 @@ public:
                 fOldVal(0), fNewVal(0),
                 fAvr(0), fAvrDiff(0), fNcalc(0),
                 fConvergenceFactor(1),
-                fMainHisto(0), fFitHisto(0), fFitFunc(0),
+                fMainHisto(0), fMainRows(0), fFitHisto(0), fFitFunc(0),
                 fOverviewHisto(0),
                 fCanvasFit(0), fCanvasResult(0),
                 fTimer(0), fTimerRunning(kFALSE),
-                fIsReFit(kFALSE),
+                fIsReFit(kFALSE), fBatchMode(kFALSE),
+                fPeakSeed(kTRUE), fNFit(0), fFitPar(0), fSeedPar(0),
                 fNIgnore(0), fIgnore(0) { }
     TCCalib(const Char_t* name, const Char_t* title,
             const Char_t* data, Int_t nElem)
@@ -85,11 +110,12 @@ public:
           fNelem(nElem), fCurrentElem(0),
           fOldVal(0), fNewVal(0),
           fAvr(0), fAvrDiff(0), fNcalc(0),
-          fMainHisto(0), fFitHisto(0), fFitFunc(0),
+          fMainHisto(0), fMainRows(0), fFitHisto(0), fFitFunc(0),
           fOverviewHisto(0),
           fCanvasFit(0), fCanvasResult(0),
           fTimer(0), fTimerRunning(kFALSE),
-          fIsReFit(kFALSE),
+          fIsReFit(kFALSE), fBatchMode(kFALSE),
+          fPeakSeed(kTRUE), fNFit(0), fFitPar(0), fSeedPar(0),
           fNIgnore(0), fIgnore(0) { }
     virtual ~TCCalib();
 
@@ -107,6 +133,11 @@ public:
     void StopProcessing();
 
     TString GetCalibData() { return fData; }
+    void SetBatchMode(Bool_t b = kTRUE) { fBatchMode = b; }
+    Bool_t IsBatchMode() const { return fBatchMode; }
+    void SetPeakSeed(Bool_t b = kTRUE) { fPeakSeed = b; }
+    Bool_t IsPeakSeed() const { return fPeakSeed; }
+    Int_t GetNFits() const;
 
     void EventHandler(Int_t event, Int_t ox, Int_t oy, TObject* selected);
 
@@ -0,0 +1,52 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCCalibClient                                                        //
+//                                                                      //
+// Client of the calibration server calib_served.                       //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCCALIBCLIENT_H
+#define TCCALIBCLIENT_H
+
+#include "Rtypes.h"
+
+class TSocket;
+
+// requests of the calibration server protocol
+enum ECalibServerRequest
+{
+    kSERVER_PING = 1,
+    kSERVER_READ_PAR_RUN
+};
+typedef ECalibServerRequest CalibServerRequest_t;
+
+class TCCalibClient
+{
+
+private:
+    TSocket* fSocket;                       // connection to the server
+
+    Bool_t SendRequest(CalibServerRequest_t req, Int_t run,
+                       const Char_t* data, const Char_t* calibration);
+
+public:
+    TCCalibClient() : fSocket(0) { }
+    TCCalibClient(const Char_t* address);
+    virtual ~TCCalibClient();
+
+    Bool_t IsConnected() const;
+    Bool_t Ping();
+    Bool_t ReadParametersRun(const Char_t* data, const Char_t* calibration, Int_t run,
+                             Double_t* par, Int_t length);
+
+    ClassDef(TCCalibClient, 0) // Calibration server client
+};
+
+#endif
+
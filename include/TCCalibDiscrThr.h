@@ -21,6 +21,7 @@
 class TH2;
 class TLine;
 class TCFileManager;
+class TCHistoRows;
 
 class TCCalibDiscrThr : public TCCalib
 {
@@ -31,6 +32,7 @@ private:
     Double_t* fPed;                     // pedestal array
     Double_t* fGain;                    // gain array
     TH2* fMainHisto2;                   // normalization histogram
+    TCHistoRows* fMainRows2;            // element rows of the normalization histogram
     TH1* fDeriv;                        // derived histogram
     Double_t fThr;                      // threshold value
     TLine* fLine;                       // mean indicator line
@@ -44,7 +46,7 @@ private:
 public:
     TCCalibDiscrThr() : TCCalib(), fADC(0), fFileManager(0),
                         fPed(0), fGain(0),
-                        fMainHisto2(0), fDeriv(0), fThr(0), fLine(0) { }
+                        fMainHisto2(0), fMainRows2(0), fDeriv(0), fThr(0), fLine(0) { }
     TCCalibDiscrThr(const Char_t* name, const Char_t* title, const Char_t* data,
                     Int_t nElem);
     virtual ~TCCalibDiscrThr();
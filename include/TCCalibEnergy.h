@@ -30,6 +30,10 @@ private:
     virtual void Init();
     virtual void Fit(Int_t elem);
     virtual void Calculate(Int_t elem);
+    virtual Bool_t IsParallelFitSupported() const { return kTRUE; }
+    virtual TF1* CreateFitFunc(Int_t elem, TH1* h);
+    virtual Double_t FitElement(Int_t elem, TH1* h, TF1* func);
+    virtual void SetFitResult(Int_t elem, TH1* h, TF1* func, Double_t pos);
     virtual void ReCalculateAll();
 
 public:
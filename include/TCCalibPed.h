@@ -26,6 +26,7 @@ class TCCalibPed : public TCCalib
 private:
     Int_t* fADC;                        // array of element ADC numbers
     TCFileManager* fFileManager;        // file manager
+    Bool_t fReadElements;               // read the element rows from the element-sliced files
     Double_t fMean;                     // mean position
     TCLine* fLine;                      // indicator line
 
@@ -36,7 +37,7 @@ private:
     void ReadADC();
 
 public:
-    TCCalibPed() : TCCalib(), fADC(0), fFileManager(0), fMean(0), fLine(0) { }
+    TCCalibPed() : TCCalib(), fADC(0), fFileManager(0), fReadElements(kFALSE), fMean(0), fLine(0) { }
     TCCalibPed(const Char_t* name, const Char_t* title, const Char_t* data,
                Int_t nElem);
     virtual ~TCCalibPed();
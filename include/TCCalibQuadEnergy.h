@@ -21,6 +21,7 @@
 class TH1;
 class TH2;
 class TCLine;
+class TCHistoRows;
 
 class TCCalibQuadEnergy : public TCCalib
 {
@@ -32,6 +33,8 @@ private:
     Double_t* fPar1New;                     // new correction parameter 1
     TH2* fMainHisto2;                       // histogram with mean photon energy of pi0
     TH2* fMainHisto3;                       // histogram with mean photon energy of eta
+    TCHistoRows* fMainRows2;                // element rows of the pi0 mean photon energy histogram
+    TCHistoRows* fMainRows3;                // element rows of the eta mean photon energy histogram
     TH1* fFitHisto1b;                       // fitting histogram
     TH1* fFitHisto2;                        // fitting histogram
     TH1* fFitHisto3;                        // fitting histogram
@@ -57,6 +60,7 @@ private:
 public:
     TCCalibQuadEnergy() : TCCalib(), fPar0Old(0), fPar1Old(0), fPar0New(0), fPar1New(0),
                           fMainHisto2(0), fMainHisto3(0),
+                          fMainRows2(0), fMainRows3(0),
                           fFitHisto1b(0), fFitHisto2(0), fFitHisto3(0),
                           fFitFunc1b(0),
                           fPi0Pos(0), fEtaPos(0), fPi0MeanE(0), fEtaMeanE(0),
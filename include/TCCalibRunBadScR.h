@@ -25,6 +25,7 @@ class TLine;
 class TH1;
 class TH2;
 class TCanvas;
+class TTimer;
 class TCBadScRElement;
 class TCARHistoLoader;
 
@@ -36,6 +37,12 @@ protected:
 
     TCARHistoLoader* fHistoLoader;      //         histo loader
     Bool_t fLoadHistosInAdvance;        //         load histos in advance (and keep in memory)
+    Double_t fMemBudget;                //         memory budget for the histograms in MB (0: unlimited)
+    Int_t fNPrefetch;                   //         number of following runs to prefetch
+    Long64_t* fLastAccess;              //[fNRuns] last access of the runs (LRU order)
+    Long64_t fNAccess;                  //         access counter
+    Bool_t* fLoadFailed;                //[fNRuns] main histo of the runs could not be loaded
+    TTimer* fPrefetchTimer;             //!        prefetch timer
 
     const Char_t* fMainHistoName;       //         name of main histo
     const Char_t* fScalerHistoName;     //         name of scaler histo
@@ -88,6 +95,15 @@ protected:
     void LoadScalerHistos(Int_t i);
     void NormalizeHisto(Int_t i);
 
+    // residency functions
+    static Long64_t GetHistoMemory(const TH1* h);
+    Long64_t GetRunMemory(Int_t i, Bool_t all = kTRUE) const;
+    Long64_t GetMemory() const;
+    void TouchRun(Int_t i) { if (fLastAccess) fLastAccess[i] = ++fNAccess; }
+    void EvictRun(Int_t i, Bool_t all = kTRUE);
+    void EnforceMemoryBudget();
+    void EvictOutsidePrefetch();
+
     void SetBadScalerReads(Int_t bscr1, Int_t bscr2);
     void SetBadScalerRead(Int_t bscr);
 
@@ -115,6 +131,8 @@ public:
     TCCalibRunBadScR()
       : TCCalibRun(),
         fHistoLoader(0), fLoadHistosInAdvance(kTRUE),
+        fMemBudget(0), fNPrefetch(0),
+        fLastAccess(0), fNAccess(0), fLoadFailed(0), fPrefetchTimer(0),
         fMainHistoName(0), fScalerHistoName(0),
         fMainHistos(0), fProjHistos(0), fProjNormHistos(0),
         fScalerP2Histos(0), fScalerLiveHistos(), fScalerFreeHistos(0),
@@ -133,6 +151,8 @@ public:
     TCCalibRunBadScR(const Char_t* name, const Char_t* title, const Char_t* data, Bool_t istruecalib)
       : TCCalibRun(name, title, data, istruecalib),
         fHistoLoader(0), fLoadHistosInAdvance(kTRUE),
+        fMemBudget(0), fNPrefetch(0),
+        fLastAccess(0), fNAccess(0), fLoadFailed(0), fPrefetchTimer(0),
         fMainHistoName(0), fScalerHistoName(0),
         fMainHistos(0), fProjHistos(0), fProjNormHistos(0),
         fScalerP2Histos(0), fScalerLiveHistos(), fScalerFreeHistos(0),
@@ -153,6 +173,7 @@ public:
     virtual Bool_t Write();
 
     virtual void EventHandler(Int_t event, Int_t ox, Int_t oy, TObject* selected);
+    void Prefetch();
 
     ClassDef(TCCalibRunBadScR, 0) // Bad scaler read calibration module class
 };
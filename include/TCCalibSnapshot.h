@@ -0,0 +1,58 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCCalibSnapshot                                                      //
+//                                                                      //
+// Read-only binary snapshot of a calibration. The snapshot file is     //
+// memory-mapped and the parameters are accessed without copying and    //
+// without any database connection.                                     //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCCALIBSNAPSHOT_H
+#define TCCALIBSNAPSHOT_H
+
+#include "Rtypes.h"
+
+class TCCalibSnapshot
+{
+
+private:
+    Char_t fFileName[256];                  // snapshot file name
+    const Char_t* fMap;                     //! memory-mapped file
+    Long64_t fMapSize;                      // size of the mapped file
+    Int_t fNData;                           // number of calibration data
+    const Char_t* fDir;                     //! data directory in the mapped file
+
+    TCCalibSnapshot(const TCCalibSnapshot&);
+    TCCalibSnapshot& operator=(const TCCalibSnapshot&);
+
+    Bool_t CheckDirectory() const;
+    Int_t FindData(const Char_t* data) const;
+
+public:
+    TCCalibSnapshot() : fMap(0), fMapSize(0), fNData(0), fDir(0) { fFileName[0] = '\0'; }
+    TCCalibSnapshot(const Char_t* filename);
+    virtual ~TCCalibSnapshot();
+
+    Bool_t IsOpen() const { return fMap != 0; }
+    const Char_t* GetFileName() const { return fFileName; }
+    const Char_t* GetCalibration() const;
+    Int_t GetNData() const { return fNData; }
+    const Char_t* GetCalibData(Int_t i) const;
+    Int_t GetNsets(const Char_t* data) const;
+    Int_t GetSetForRun(const Char_t* data, Int_t run) const;
+    const Double_t* GetParameters(const Char_t* data, Int_t run, Int_t* outLength = 0) const;
+    Bool_t ReadParameters(const Char_t* data, Int_t run, Double_t* par, Int_t length) const;
+
+    static Bool_t Create(const Char_t* filename, const Char_t* calibration);
+
+    ClassDef(TCCalibSnapshot, 0) // Memory-mapped calibration snapshot
+};
+
+#endif
+
@@ -42,9 +42,13 @@ namespace TCConfig
 
     // database format definitions
     extern const Char_t* kCalibMainTableName;
+    extern const Char_t* kCalibSyncTableName;
     extern const Char_t* kCalibMainTableFormat;
     extern const Char_t* kCalibDataTableHeader;
     extern const Char_t* kCalibDataTableSettings;
+    extern const Int_t kBulkInsertSize;
+    extern const Int_t kBulkInsertMaxLength;
+    extern const Int_t kDumpChunkSize;
 
     // version numbers etc.
     extern const Char_t kCaLibVersion[];
@@ -0,0 +1,52 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCElementStore                                                       //
+//                                                                      //
+// Element-sliced store of the 2D histograms of one run file.           //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCELEMENTSTORE_H
+#define TCELEMENTSTORE_H
+
+#include "TString.h"
+
+class TFile;
+class TDirectory;
+class TH1;
+class TH2;
+
+class TCElementStore
+{
+
+private:
+    TFile* fFile;                           //! store file
+
+    TDirectory* GetHistoDirectory(const Char_t* name) const;
+    static void WriteHisto(TDirectory* dir, TH2* h);
+
+public:
+    TCElementStore() : fFile(0) { }
+    TCElementStore(const Char_t* filename);
+    virtual ~TCElementStore();
+
+    Bool_t IsOpen() const { return fFile != 0; }
+    Bool_t HasHisto(const Char_t* name) const { return GetHistoDirectory(name) != 0; }
+    Int_t GetNElements(const Char_t* name) const;
+
+    TH1* GetElement(const Char_t* name, Int_t elem) const;
+    Bool_t AddElement(TH1*& hSum, const Char_t* name, Int_t elem) const;
+
+    static Bool_t Convert(const Char_t* inFile, const Char_t* outFile,
+                          Int_t nName = 0, const Char_t** names = 0);
+
+    ClassDef(TCElementStore, 0) // Element-sliced store of 2D histograms
+};
+
+#endif
+
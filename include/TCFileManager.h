@@ -17,7 +17,9 @@
 #include "TString.h"
 
 class TList;
+class THashList;
 class TH1;
+class TCElementStore;
 
 class TCFileManager
 {
@@ -29,17 +31,66 @@ private:
     TString fCalibration;                   // calibration identifier
     Int_t fNset;                            // number of sets
     Int_t* fSet;                            //[fNset] array of set numbers
+    Int_t fNThreads;                        // number of threads used for reading
+    THashList* fStore;                      // prefetched summed-up histograms
+    TString fCacheDir;                      // histogram cache directory (empty if disabled)
+    Long64_t fCacheSize;                    // maximum size of the histogram cache [bytes]
+    TString fCacheKey;                      // cache key of the input files
+    Int_t fNCacheHit;                       // number of cache hits
+    Int_t fNCacheMiss;                      // number of cache misses
+    TString fRunStoreDir;                   // directory of the run histogram stores
+    TString fElementFilePatt;               // element-sliced file pattern (empty if disabled)
+    TList* fElementFiles;                   // list of element-sliced file names
+    TCElementStore** fElementStores;        // opened element-sliced files (same order as fElementFiles)
 
     void BuildFileList();
+    TString GetCacheFile(const Char_t* name) const;
+    TH1* ReadCache(const Char_t* name);
+    void WriteCache(TH1* h);
+    void EvictCache();
+    TH1* GetHistogramFromRunStore(const Char_t* name);
+    TCElementStore* GetElementStore(Int_t i);
+    Bool_t GetElementsFromStore(const Char_t* name, Int_t nElem, const Int_t* elem,
+                                TH1** outHistos);
 
 public:
+    static const Int_t kNFilesPerTask = 8;  // files summed per parallel task
+
     TCFileManager() : fInputFilePatt(0), fFiles(0),
-                      fCalibData(), fCalibration(), fNset(0), fSet(0) { }
+                      fCalibData(), fCalibration(), fNset(0), fSet(0),
+                      fNThreads(1), fStore(0),
+                      fCacheDir(), fCacheSize(0), fCacheKey(),
+                      fNCacheHit(0), fNCacheMiss(0), fRunStoreDir(),
+                      fElementFilePatt(), fElementFiles(0), fElementStores(0) { }
     TCFileManager(const Char_t* data, const Char_t* calibration,
                   Int_t nSet, Int_t* set, const Char_t* filePat = 0);
     virtual ~TCFileManager();
 
+    void SetNThreads(Int_t n) { fNThreads = n > 1 ? n : 1; }
+    void SetRunStoreDir(const Char_t* dir);
+    Int_t GetNThreads() const { return fNThreads; }
+
     TH1* GetHistogram(const Char_t* name);
+    TH1* GetHistogramSerial(const Char_t* name);
+    TH1* GetHistogramParallel(const Char_t* name);
+    static TH1* GetSetHistogram(const Char_t* data, const Char_t* calibration, Int_t set,
+                                const Char_t* name, const Char_t* filePat = 0,
+                                const Char_t* storeDir = 0);
+
+    Bool_t HasElementHistogram(const Char_t* name);
+    TH1* GetElementHistogram(const Char_t* name, Int_t elem);
+    Bool_t GetElementHistograms(const Char_t* name, Int_t nElem, const Int_t* elem,
+                                TH1** outHistos);
+
+    Int_t Prefetch(Int_t nName, const Char_t** names);
+    Int_t PrefetchElements(const Char_t* name, Int_t first, Int_t last);
+    Bool_t IsPrefetched(const Char_t* name) const;
+    void ClearPrefetched();
+
+    void SetCache(const Char_t* dir, Long64_t maxSize);
+    Int_t GetNCacheHits() const { return fNCacheHit; }
+    Int_t GetNCacheMisses() const { return fNCacheMiss; }
+    void PrintCacheStats() const;
 
     ClassDef(TCFileManager, 0) // Histogram building class
 };
@@ -20,13 +20,19 @@
 
 class TH1;
 class TF1;
+class TRandom;
 
 namespace TCFitUtils
 {
-    Bool_t ReFit(TH1* h, TF1* f, Option_t* option = "", Int_t n = 10);
+    Bool_t ReFit(TH1* h, TF1* f, Option_t* option = "", Int_t n = 10, TRandom* rnd = 0,
+                 Double_t tol = 0, Int_t* outNFit = 0);
     TF1* GetBestChi2Func(TF1* f1, TF1* f);
-    void RandomizeParameter(TF1* f, Int_t i);
-    void RandomizeParameters(TF1* f, Bool_t* isrand = 0);
+    void RandomizeParameter(TF1* f, Int_t i, TRandom* rnd = 0);
+    void RandomizeParameters(TF1* f, Bool_t* isrand = 0, TRandom* rnd = 0);
+    void SetParameterInLimits(TF1* f, Int_t i, Double_t value);
+    Bool_t EstimatePeak(const TH1* h, Int_t first, Int_t last,
+                        Double_t* outPos, Double_t* outSigma, Double_t* outAmp,
+                        Double_t* outBg0 = 0, Double_t* outBg1 = 0);
 }
 
 #endif
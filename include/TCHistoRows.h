@@ -0,0 +1,55 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCHistoRows                                                          //
+//                                                                      //
+// Element rows of a 2D histogram.                                      //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCHISTOROWS_H
+#define TCHISTOROWS_H
+
+#include "Rtypes.h"
+
+class TH1D;
+class TH2;
+
+class TCHistoRows
+{
+
+private:
+    Int_t fNRows;                           // number of rows (elements)
+    Int_t fNCells;                          // number of cells per row in the x-axis range (incl. under-/overflow)
+    Double_t* fContent;                     //[fNRows*fNCells] row contents
+    Double_t* fSumw2;                       //[fNRows*fNCells] row sums of squares of weights
+    TH1D* fTemplate;                        // empty x-projection as axis template
+
+    TCHistoRows(const TCHistoRows&);
+    TCHistoRows& operator=(const TCHistoRows&);
+
+public:
+    TCHistoRows()
+        : fNRows(0), fNCells(0),
+          fContent(0), fSumw2(0), fTemplate(0) { }
+    TCHistoRows(const TH2* h, Bool_t errors = kTRUE);
+    virtual ~TCHistoRows();
+
+    Int_t GetNRows() const { return fNRows; }
+    Int_t GetNCells() const { return fNCells; }
+    Bool_t HasErrors() const { return fSumw2 != 0; }
+    const Double_t* GetRow(Int_t row) const { return fContent + row*fNCells; }
+    const Double_t* GetRowSumw2(Int_t row) const { return fSumw2 ? fSumw2 + row*fNCells : 0; }
+
+    TH1D* GetRowHisto(Int_t row, const Char_t* name) const;
+    Bool_t FillRowHisto(TH1D* h, Int_t row) const;
+
+    ClassDef(TCHistoRows, 0) // Element rows of a 2D histogram
+};
+
+#endif
+
@@ -18,12 +18,14 @@
 
 class TSQLServer;
 class TSQLResult;
+class TSQLStatement;
 class THashList;
 class TList;
 class TCBadScRElement;
 class TCContainer;
 class TCCalibType;
 class TCCalibData;
+class TCSetCatalog;
 
 enum EServerType {
     kNoType,
@@ -41,13 +43,31 @@ private:
     Bool_t fSilence;                            // silence mode toggle
     THashList* fData;                           // calibration data
     THashList* fTypes;                          // calibration types
+    THashList* fSetCatalogs;                    // cached set catalogs
+    Int_t fNRunIndex;                           // number of runs in the run index
+    Int_t* fRunIndex;                           //[fNRunIndex] cached sorted run numbers
+    Int_t fBulkSize;                            // number of rows per bulk insert
+    THashList* fQueryStats;                     // query statistics per call site (0 if disabled)
+    Double_t fSlowQuery;                        // slow query log threshold [ms] (0 if disabled)
+    Long64_t fNUnsettled;                       // number of unsettled change stamps read
+    THashList* fParSQL;                         // cached SQL of the parameter statements
     static TCMySQLManager* fgMySQLManager;      // pointer to static instance of this class
 
     Bool_t ReadCaLibData();
     Bool_t ReadCaLibTypes();
 
-    TSQLResult* SendQuery(const Char_t* query);
-    Bool_t SendExec(const Char_t* sql);
+    TSQLResult* SendQuery(const Char_t* query, const Char_t* site);
+    Bool_t SendExec(const Char_t* sql, const Char_t* site);
+
+    Bool_t IsInstrumented() const { return fQueryStats || fSlowQuery > 0; }
+    void RecordQuery(const Char_t* site, const Char_t* sql, Double_t time, Long64_t rows);
+    static void DumpQueryStatsAtExit();
+
+    Bool_t BeginTransaction();
+    Bool_t CommitTransaction();
+    Bool_t RollbackTransaction();
+    Int_t InsertBulk(const Char_t* method, const Char_t* head,
+                     Int_t nRows, const TString* rows, Bool_t* outAdded);
 
     Bool_t SearchTable(const Char_t* data, Char_t* outTableName);
     Bool_t SearchRunEntry(Int_t run, const Char_t* name, TString& outInfo);
@@ -55,6 +75,14 @@ private:
                           const Char_t* name, Char_t* outInfo);
     TList* SearchDistinctEntries(const Char_t* field, const Char_t* table);
 
+    TCSetCatalog* GetSetCatalog(const Char_t* data, const Char_t* calibration);
+    void InvalidateSetCatalog(const Char_t* data, const Char_t* calibration);
+    void InvalidateSetCatalogs();
+    Bool_t LoadRunIndex();
+    void InvalidateRunIndex();
+    Bool_t HasRun(Int_t run);
+    TSQLStatement* CreateParStatement(const Char_t* op, const Char_t* table, Int_t length);
+
     Bool_t ChangeRunEntries(Int_t first_run, Int_t last_run,
                             const Char_t* name, const Char_t* value);
     Bool_t ChangeSetEntry(const Char_t* data, const Char_t* calibration, Int_t set,
@@ -73,13 +101,27 @@ private:
 
     Bool_t ReadAllBadScR(Int_t run, TCBadScRElement**& badscr_data, Int_t& ndata);
 
+    Int_t CopyTable(TSQLServer* target, const Char_t* table, const Char_t* filter = 0);
+    Int_t RemoveDeletedRows(TSQLServer* target, const Char_t* table);
+
     TCMySQLManager();
 
 public:
     virtual ~TCMySQLManager();
 
     void SetSilenceMode(Bool_t s) { fSilence = s; }
+    Bool_t GetSilenceMode() const { return fSilence; }
     Bool_t IsConnected();
+    void ClearCache();
+    Bool_t GetChangeStamps(Int_t nTable, const Char_t** tables, TString* outStamps);
+    void SetBulkSize(Int_t n) { fBulkSize = n > 0 ? n : 1; }
+    Int_t GetBulkSize() const { return fBulkSize; }
+
+    void SetQueryStats(Bool_t s);
+    void ResetQueryStats();
+    void SetSlowQueryThreshold(Double_t t) { fSlowQuery = t; }
+    THashList* GetQueryStats() const { return fQueryStats; }
+    Bool_t DumpQueryStats(const Char_t* filename = 0, Bool_t json = kFALSE);
 
     const Char_t* GetDBName() const;
     const Char_t* GetDBHost() const;
@@ -113,6 +155,10 @@ public:
                           Double_t* par, Int_t length);
     Bool_t ReadParametersRun(const Char_t* data, const Char_t* calibration, Int_t run,
                              Double_t* par, Int_t length);
+    Bool_t ReadParametersRunMulti(Int_t nData, const Char_t** data,
+                                  const Char_t* calibration, Int_t run,
+                                  Double_t** par, Int_t* length,
+                                  Bool_t* outRead = 0);
     Bool_t WriteParameters(const Char_t* data, const Char_t* calibration, Int_t set,
                            Double_t* par, Int_t length);
 
@@ -159,9 +205,10 @@ public:
     TCContainer* LoadContainer(const Char_t* filename);
 
     Int_t DumpRuns(TCContainer* container, Int_t first_run = 0, Int_t last_run = 0);
-    Int_t DumpAllCalibrations(TCContainer* container, const Char_t* calibration);
+    Int_t DumpAllCalibrations(TCContainer* container, const Char_t* calibration,
+                              Int_t first_run = 0, Int_t last_run = 0);
     Int_t DumpCalibrations(TCContainer* container, const Char_t* calibration,
-                           const Char_t* data);
+                           const Char_t* data, Int_t first_run = 0, Int_t last_run = 0);
 
     Int_t ImportRuns(TCContainer* container);
     Int_t ImportCalibrations(TCContainer* container, const Char_t* newCalibName = 0,
@@ -173,6 +220,7 @@ public:
     void Import(const Char_t* filename, Bool_t runs, Bool_t calibrations,
                 const Char_t* newCalibName = 0);
     Bool_t ExportDatabase(const Char_t* filename);
+    Bool_t SyncReplica(const Char_t* replicaFile);
 
     static TCMySQLManager* GetManager();
 
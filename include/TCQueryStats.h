@@ -0,0 +1,63 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCQueryStats                                                         //
+//                                                                      //
+// Latency and row statistics of the database queries of one call site. //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCQUERYSTATS_H
+#define TCQUERYSTATS_H
+
+#include "TNamed.h"
+#include "TString.h"
+
+class TCQueryStats : public TNamed
+{
+
+public:
+    static const Int_t kNBins = 80;     // number of latency bins (10 per decade)
+    static const Double_t kMinTime;     // lower edge of the first latency bin [ms]
+
+private:
+    Long64_t fN;                        // number of queries
+    Double_t fTotal;                    // total time [ms]
+    Double_t fMin;                      // minimum time [ms]
+    Double_t fMax;                      // maximum time [ms]
+    Long64_t fRows;                     // number of returned rows
+    Long64_t fBins[kNBins];             // logarithmic latency histogram
+
+public:
+    TCQueryStats() : TNamed() { Reset(); }
+    TCQueryStats(const Char_t* site) : TNamed(site, site) { Reset(); }
+    virtual ~TCQueryStats() { }
+
+    void Reset();
+    void Fill(Double_t time, Long64_t rows);
+
+    Long64_t GetN() const { return fN; }
+    Double_t GetTotal() const { return fTotal; }
+    Double_t GetMin() const { return fN ? fMin : 0; }
+    Double_t GetMax() const { return fMax; }
+    Double_t GetMean() const { return fN ? fTotal / fN : 0; }
+    Long64_t GetRows() const { return fRows; }
+    Double_t GetQuantile(Double_t q) const;
+
+    virtual Bool_t IsSortable() const { return kTRUE; }
+    virtual Int_t Compare(const TObject* obj) const;
+
+    TString GetJSON() const;
+    TString GetTableRow() const;
+    static TString GetTableHeader();
+    virtual void Print(Option_t* option = "") const;
+
+    ClassDef(TCQueryStats, 0) // Database query statistics of a call site
+};
+
+#endif
+
@@ -0,0 +1,70 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCRunHistoStore                                                      //
+//                                                                      //
+// Prefix-sum store of the per-run histograms of one histogram.         //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCRUNHISTOSTORE_H
+#define TCRUNHISTOSTORE_H
+
+#include "TString.h"
+
+class TFile;
+class TH1;
+
+class TCRunHistoStore
+{
+
+private:
+    TFile* fFile;                           //! store file
+    TString fHistoName;                     // name of the stored histogram
+    Int_t fInterval;                        // number of runs between two checkpoints
+    Int_t fNRun;                            // number of runs
+    Int_t* fRuns;                           //[fNRun] sorted run numbers
+    Long64_t* fSizes;                       //[fNRun] file sizes at build time (-1 if missing)
+    Long64_t* fMTimes;                      //[fNRun] file modification times at build time
+
+    TCRunHistoStore(const TCRunHistoStore&);
+    TCRunHistoStore& operator=(const TCRunHistoStore&);
+
+    TH1* GetRunHisto(Int_t index) const;
+    TH1* GetCheckpoint(Int_t c) const;
+    static void AddHisto(TH1*& hSum, TH1* h, Double_t c = 1);
+    static TH1* CreateDoubleHisto(const TH1* h);
+    static void GetFileKey(const Char_t* filename, Long64_t* outSize, Long64_t* outMTime);
+
+public:
+    static const Int_t kVersion = 2;        // store format version
+
+    TCRunHistoStore() : fFile(0), fHistoName(), fInterval(0), fNRun(0), fRuns(0),
+                        fSizes(0), fMTimes(0) { }
+    TCRunHistoStore(const Char_t* filename);
+    virtual ~TCRunHistoStore();
+
+    Bool_t IsOpen() const { return fFile != 0; }
+    const Char_t* GetHistoName() const { return fHistoName.Data(); }
+    Int_t GetInterval() const { return fInterval; }
+    Int_t GetNRuns() const { return fNRun; }
+    Int_t GetRun(Int_t i) const { return i >= 0 && i < fNRun ? fRuns[i] : 0; }
+
+    Bool_t IsUpToDate(Int_t first_run, Int_t last_run, Int_t nRun, const Int_t* runs,
+                      const Char_t* filePat) const;
+    TH1* GetSum(Int_t first_run, Int_t last_run) const;
+    TH1* GetSetSum(const Char_t* data, const Char_t* calibration, Int_t set) const;
+
+    static Bool_t Build(const Char_t* filename, const Char_t* name,
+                        Int_t nRun, const Int_t* runs, const Char_t* filePat,
+                        Int_t interval = 10);
+
+    ClassDef(TCRunHistoStore, 0) // Prefix-sum store of per-run histograms
+};
+
+#endif
+
@@ -0,0 +1,62 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCSetCatalog                                                         //
+//                                                                      //
+// In-memory catalog of the sets of one calibration data and            //
+// calibration identifier.                                              //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCSETCATALOG_H
+#define TCSETCATALOG_H
+
+#include "TNamed.h"
+#include "TString.h"
+
+class TCSetCatalog : public TNamed
+{
+
+private:
+    Int_t fNset;                        // number of sets
+    Int_t fCapacity;                    // allocated size of the set arrays
+    Int_t* fFirstRun;                   //[fNset] first runs of the sets
+    Int_t* fLastRun;                    //[fNset] last runs of the sets
+    TString* fChanged;                  //[fNset] change times of the sets
+    TString* fDesc;                     //[fNset] descriptions of the sets
+
+public:
+    TCSetCatalog() : TNamed(),
+                     fNset(0), fCapacity(0),
+                     fFirstRun(0), fLastRun(0),
+                     fChanged(0), fDesc(0) { }
+    TCSetCatalog(const Char_t* name)
+        : TNamed(name, name),
+          fNset(0), fCapacity(0),
+          fFirstRun(0), fLastRun(0),
+          fChanged(0), fDesc(0) { }
+    virtual ~TCSetCatalog();
+
+    void AddSet(Int_t first_run, Int_t last_run,
+                const Char_t* changed, const Char_t* desc);
+
+    Int_t GetNsets() const { return fNset; }
+    Bool_t IsValidSet(Int_t set) const { return set >= 0 && set < fNset; }
+    Int_t GetFirstRun(Int_t set) const { return IsValidSet(set) ? fFirstRun[set] : 0; }
+    Int_t GetLastRun(Int_t set) const { return IsValidSet(set) ? fLastRun[set] : 0; }
+    const Char_t* GetChangeTime(Int_t set) const { return IsValidSet(set) ? fChanged[set].Data() : 0; }
+    const Char_t* GetDescription(Int_t set) const { return IsValidSet(set) ? fDesc[set].Data() : 0; }
+
+    Int_t FindSet(Int_t run) const;
+
+    virtual void Print(Option_t* option = "") const;
+
+    ClassDef(TCSetCatalog, 0) // Set catalog of a calibration
+};
+
+#endif
+
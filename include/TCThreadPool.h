@@ -0,0 +1,44 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCThreadPool                                                         //
+//                                                                      //
+// CaLib thread pool namespace                                          //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TCTHREADPOOL_H
+#define TCTHREADPOOL_H
+
+#include "Rtypes.h"
+
+class TString;
+class TFile;
+
+namespace TCThreadPool
+{
+    // task function called with the task number and the user argument
+    typedef void (*TaskFunc_t)(Int_t task, void* arg);
+
+    // status of files opened by OpenFiles()
+    enum EFileStatus {
+        kFileOK,
+        kFileNotOpened,
+        kFileZombie
+    };
+
+    Int_t GetNThreads();
+    Int_t GetNIOThreads();
+    Int_t LimitIOThreads(Int_t nThreads);
+    void EnableThreadSafety();
+    void Run(Int_t nTask, TaskFunc_t func, void* arg, Int_t nThreads = -1);
+    void OpenFiles(Int_t nFile, const TString* names, TFile** outFiles,
+                   Int_t* outStatus, Int_t nThreads = -1);
+}
+
+#endif
+
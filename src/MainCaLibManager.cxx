@@ -1733,6 +1733,77 @@ void ExportDatabase()
     return;
 }
 
+//______________________________________________________________________________
+void QueryStatistics()
+{
+    // Dump or enable the database query statistics.
+
+    Char_t filename[256];
+    Char_t answer[16];
+
+    // clear the screen
+    clear();
+
+    // echo input
+    echo();
+
+    // draw header
+    DrawHeader();
+
+    // draw title
+    attron(A_UNDERLINE);
+    mvprintw(4, 2, "QUERY STATISTICS");
+    attroff(A_UNDERLINE);
+
+    // check if statistics are enabled
+    TCMySQLManager* m = TCMySQLManager::GetManager();
+    if (!m->GetQueryStats())
+    {
+        mvprintw(6, 2, "Query statistics are not enabled (set DB.Stats in the configuration file)");
+        mvprintw(8, 6, "Enable them now? (yes/no) : ");
+        scanw((Char_t*)"%s", answer);
+        if (strcmp(answer, "yes")) mvprintw(10, 2, "Aborted.");
+        else
+        {
+            m->SetQueryStats(kTRUE);
+            mvprintw(10, 2, "Enabled the query statistics");
+        }
+    }
+    else
+    {
+        // ask file name
+        mvprintw(6, 2, "Name of output file (.json for JSON format) : ");
+        scanw((Char_t*)"%s", filename);
+
+        // try to dump
+        TString fn(filename);
+        if (m->DumpQueryStats(filename, fn.EndsWith(".json")))
+            mvprintw(8, 2, "Wrote the statistics of %d call sites to '%s'",
+                     m->GetQueryStats()->GetSize(), filename);
+        else
+            mvprintw(8, 2, "Could not write the statistics to '%s'!", filename);
+    }
+
+    // user information
+    PrintStatusMessage("Hit ESC or 'q' to exit");
+
+    // wait for input
+    for (;;)
+    {
+        // get key
+        Int_t c = getch();
+
+        // leave loop
+        if (c == KEY_ESC || c == 'q') break;
+    }
+
+    // don't echo input
+    noecho();
+
+    // go back (to admin menue)
+    return;
+}
+
 //______________________________________________________________________________
 void RenameCalibration()
 {
@@ -2129,13 +2200,14 @@ void Administration()
     // menu configuration
     const Char_t mTitle[] = "ADMINISTRATION";
     const Char_t mMsg[] = "Select an administration operation";
-    const Int_t mN = 7;
+    const Int_t mN = 8;
     const Char_t* mEntries[] = { "Export runs",
                                  "Export calibration",
                                  "Import runs",
                                  "Import calibration",
                                  "Clone calibration",
                                  "Export complete database",
+                                 "Query statistics",
                                  "Go back" };
 
     // menue index
@@ -2163,7 +2235,9 @@ void Administration()
                      break;
             case  5: ExportDatabase();
                      break;
-            case  6: return;
+            case  6: QueryStatistics();
+                     break;
+            case  7: return;
         }
     }
 }
@@ -0,0 +1,496 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// CaLibServed                                                          //
+//                                                                      //
+// Serve calibration parameters of a CaLib database from a warm cache.  //
+//                                                                      //
+// The server listens on a Unix socket (address starting with '/') or   //
+// on a TCP port of the loopback interface (all interfaces only if      //
+// Served.Remote is set). All clients are served by one thread: the     //
+// requests are received with non-blocking reads into a buffer per      //
+// client and handled once complete, the responses are queued in a      //
+// buffer per client and sent with non-blocking writes, so a slow       //
+// client cannot stall the others.                                      //
+// Set intervals are kept in the set catalogs of the database manager   //
+// and read parameter vectors are cached. The cache is invalidated      //
+// whenever the change stamps of the database tables change. See        //
+// TCCalibClient for the protocol and the client.                       //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include <signal.h>
+#include <time.h>
+
+#include "TError.h"
+#include "TSystem.h"
+#include "TMap.h"
+#include "TObjString.h"
+#include "THashList.h"
+#include "TSocket.h"
+#include "TServerSocket.h"
+#include "TMonitor.h"
+#include "TInetAddress.h"
+#include "RVersion.h"
+
+#include "TCMySQLManager.h"
+#include "TCReadConfig.h"
+#include "TCCalibData.h"
+#include "TCContainer.h"
+#include "TCCalibClient.h"
+
+// connected client
+class TCServedClient : public TObject
+{
+public:
+    TSocket* fSocket;                       // client socket
+    TString fBuffer;                        // received and not yet handled bytes
+    TString fOutBuffer;                     // responses not yet sent
+
+    TCServedClient(TSocket* s) : TObject(), fSocket(s) { }
+    virtual ~TCServedClient() { }
+};
+
+// maximum size of the unsent responses of a client [bytes]
+const Int_t kMaxPending = 16*1024*1024;
+
+// global variables
+volatile sig_atomic_t gStop;
+TString gAddress;
+Int_t gCheckInterval;
+TMap* gCache;
+Int_t gNTable;
+TString* gTable;
+TString* gStamp;
+Long64_t gNRequest;
+Long64_t gNHit;
+
+//______________________________________________________________________________
+void Finish(Int_t sig)
+{
+    // Request the server loop to stop.
+
+    gStop = 1;
+}
+
+//______________________________________________________________________________
+void InitTables()
+{
+    // Create the list of the watched tables (main table and all data tables)
+    // and read their current change stamps.
+
+    TCMySQLManager* m = TCMySQLManager::GetManager();
+
+    // create the table list
+    THashList* data = m->GetDataTable();
+    gNTable = data->GetSize() + 1;
+    gTable = new TString[gNTable];
+    gStamp = new TString[gNTable];
+    gTable[0] = TCConfig::kCalibMainTableName;
+    TIter next(data);
+    TCCalibData* d;
+    Int_t n = 1;
+    while ((d = (TCCalibData*)next())) gTable[n++] = d->GetTableName();
+
+    // read the current stamps
+    const Char_t* tables[gNTable];
+    for (Int_t i = 0; i < gNTable; i++) tables[i] = gTable[i].Data();
+    m->GetChangeStamps(gNTable, tables, gStamp);
+}
+
+//______________________________________________________________________________
+void RemoveCacheEntries(const Char_t* table)
+{
+    // Remove all cached parameters of the calibration data stored in the
+    // table 'table'.
+
+    TCMySQLManager* m = TCMySQLManager::GetManager();
+
+    // loop over calibration data of the table
+    TIter nextData(m->GetDataTable());
+    TCCalibData* d;
+    while ((d = (TCCalibData*)nextData()))
+    {
+        if (strcmp(d->GetTableName(), table)) continue;
+
+        // collect matching keys
+        TString prefix = TString::Format("%s|", d->GetName());
+        TList keys;
+        TIter nextKey(gCache);
+        TObjString* key;
+        while ((key = (TObjString*)nextKey()))
+            if (key->GetString().BeginsWith(prefix)) keys.Add(key);
+
+        // remove entries
+        TIter nextRem(&keys);
+        while ((key = (TObjString*)nextRem()))
+        {
+            TPair* p = gCache->RemoveEntry(key);
+            delete p->Key();
+            delete p->Value();
+            delete p;
+        }
+    }
+}
+
+//______________________________________________________________________________
+void CheckChanges()
+{
+    // Check the database for changes and invalidate the cache if necessary.
+
+    TCMySQLManager* m = TCMySQLManager::GetManager();
+
+    // read the current stamps
+    const Char_t* tables[gNTable];
+    TString stamp[gNTable];
+    for (Int_t i = 0; i < gNTable; i++) tables[i] = gTable[i].Data();
+    if (!m->GetChangeStamps(gNTable, tables, stamp)) return;
+
+    // compare stamps
+    Bool_t changed = kFALSE;
+    for (Int_t i = 0; i < gNTable; i++)
+    {
+        if (stamp[i] == gStamp[i]) continue;
+
+        // main table: runs were modified, other cached entries are still valid
+        // data table: drop the cached parameters of this table
+        if (i) RemoveCacheEntries(gTable[i].Data());
+        Info("CheckChanges", "Table '%s' was modified", gTable[i].Data());
+        gStamp[i] = stamp[i];
+        changed = kTRUE;
+    }
+
+    // clear set catalogs and run index
+    if (changed) m->ClearCache();
+}
+
+//______________________________________________________________________________
+TCCalibration* GetParameters(const Char_t* data, const Char_t* calibration, Int_t run)
+{
+    // Return the cached parameters of the calibration data 'data' for the calibration
+    // identifier 'calibration' valid for the run 'run'. The parameters are read from
+    // the database if they are not cached yet.
+    // Return 0 if no parameters were found.
+
+    TCMySQLManager* m = TCMySQLManager::GetManager();
+
+    // get data
+    TCCalibData* d = m->GetCalibData(data);
+    if (!d) return 0;
+
+    // find the set using the set catalog
+    Int_t set = m->GetSetForRun(data, calibration, run);
+    if (set == -1) return 0;
+    Int_t first_run = m->GetFirstRunOfSet(data, calibration, set);
+
+    // look-up cache
+    TString key = TString::Format("%s|%s|%d", data, calibration, first_run);
+    TCCalibration* c = (TCCalibration*)gCache->GetValue(key.Data());
+    if (c)
+    {
+        gNHit++;
+        return c;
+    }
+
+    // read parameters from the database
+    Int_t n = d->GetSize();
+    Double_t par[n];
+    if (!m->ReadParameters(data, calibration, set, par, n)) return 0;
+
+    // add to cache
+    c = new TCCalibration();
+    c->SetCalibData(data);
+    c->SetCalibration(calibration);
+    c->SetFirstRun(first_run);
+    c->SetLastRun(m->GetLastRunOfSet(data, calibration, set));
+    c->SetParameters(n, par);
+    gCache->Add(new TObjString(key.Data()), c);
+
+    return c;
+}
+
+//______________________________________________________________________________
+Bool_t HandleRequest(TCServedClient* c, const Int_t* head, const Char_t* data,
+                     const Char_t* calibration)
+{
+    // Handle the request with the header 'head' for the calibration data 'data'
+    // and the calibration identifier 'calibration' of the client 'c'. The
+    // response is queued in the output buffer of the client.
+    // Return kFALSE if the request is invalid, otherwise kTRUE.
+
+    gNRequest++;
+
+    // handle the request
+    Int_t resp[2] = { 0, 0 };
+    switch (head[0])
+    {
+        case kSERVER_PING:
+        {
+            resp[0] = 1;
+            c->fOutBuffer.Append((const Char_t*)resp, sizeof(resp));
+            return kTRUE;
+        }
+        case kSERVER_READ_PAR_RUN:
+        {
+            TCCalibration* cal = GetParameters(data, calibration, head[1]);
+            if (!cal)
+            {
+                c->fOutBuffer.Append((const Char_t*)resp, sizeof(resp));
+                return kTRUE;
+            }
+
+            // queue response header and parameters
+            resp[0] = 1;
+            resp[1] = cal->GetNParameters();
+            c->fOutBuffer.Append((const Char_t*)resp, sizeof(resp));
+            c->fOutBuffer.Append((const Char_t*)cal->GetParameters(), resp[1]*sizeof(Double_t));
+            return kTRUE;
+        }
+        default:
+        {
+            Error("HandleRequest", "Unknown request %d received!", head[0]);
+            return kFALSE;
+        }
+    }
+}
+
+//______________________________________________________________________________
+Bool_t SendResponses(TCServedClient* c)
+{
+    // Send as many of the queued responses of the client 'c' as possible
+    // without blocking.
+    // Return kFALSE if the connection is broken, otherwise kTRUE.
+
+    while (c->fOutBuffer.Length())
+    {
+        Int_t n = c->fSocket->SendRaw(c->fOutBuffer.Data(), c->fOutBuffer.Length(), kDontBlock);
+        if (n == -4) return kTRUE;
+        if (n <= 0) return kFALSE;
+        c->fOutBuffer.Remove(0, n);
+    }
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t ReceiveRequests(TCServedClient* c)
+{
+    // Receive the available bytes of the client 'c' without blocking and handle
+    // all complete requests in its buffer.
+    // Return kFALSE if the connection was closed or broken, otherwise kTRUE.
+
+    // receive the available bytes
+    Char_t buf[4096];
+    Int_t n = c->fSocket->RecvRaw(buf, sizeof(buf), kDontBlock);
+    if (n == -4) return kTRUE;
+    if (n <= 0) return kFALSE;
+    c->fBuffer.Append(buf, n);
+
+    // handle complete requests
+    for (;;)
+    {
+        // check for complete request header
+        Int_t head[4];
+        if (c->fBuffer.Length() < (Int_t)sizeof(head)) return kTRUE;
+        memcpy(head, c->fBuffer.Data(), sizeof(head));
+
+        // check string lengths
+        if (head[2] < 0 || head[2] > 255 || head[3] < 0 || head[3] > 255)
+        {
+            Error("ReceiveRequests", "Invalid request received!");
+            return kFALSE;
+        }
+
+        // check for complete request
+        Int_t size = sizeof(head) + head[2] + head[3];
+        if (c->fBuffer.Length() < size) return kTRUE;
+
+        // get data and calibration
+        Char_t data[256];
+        Char_t calibration[256];
+        memcpy(data, c->fBuffer.Data() + sizeof(head), head[2]);
+        memcpy(calibration, c->fBuffer.Data() + sizeof(head) + head[2], head[3]);
+        data[head[2]] = '\0';
+        calibration[head[3]] = '\0';
+        c->fBuffer.Remove(0, size);
+
+        // handle the request
+        if (!HandleRequest(c, head, data, calibration)) return kFALSE;
+
+        // check for a client not reading its responses
+        if (c->fOutBuffer.Length() > kMaxPending)
+        {
+            Error("ReceiveRequests", "Too many unsent responses, dropping client!");
+            return kFALSE;
+        }
+    }
+}
+
+//______________________________________________________________________________
+Int_t main(Int_t argc, Char_t* argv[])
+{
+    // Main method.
+
+    // set-up signals for CTRL-C and termination
+    signal(SIGINT, Finish);
+    signal(SIGTERM, Finish);
+
+    // get the address
+    if (argc > 1) gAddress = argv[1];
+    else if (TString* a = TCReadConfig::GetReader()->GetConfig("Served.Address")) gAddress = *a;
+    else
+    {
+        printf("Usage: calib_served [socket path|port]\n");
+        printf("Alternatively set Served.Address in the configuration file.\n");
+        return 1;
+    }
+
+    // get the check interval
+    gCheckInterval = TCReadConfig::GetReader()->GetConfigInt("Served.Check");
+    if (gCheckInterval <= 0) gCheckInterval = 10;
+
+    // check connection to database
+    TCMySQLManager* m = TCMySQLManager::GetManager();
+    if (!m)
+    {
+        printf("No connection to CaLib database!\n");
+        return 1;
+    }
+    m->SetSilenceMode(kTRUE);
+
+    // init cache and watched tables
+    gCache = new TMap();
+    gNRequest = 0;
+    gNHit = 0;
+    InitTables();
+
+    // create the server socket
+    TServerSocket* ss;
+    if (gAddress.BeginsWith("/"))
+    {
+        gSystem->Unlink(gAddress.Data());
+        ss = new TServerSocket(gAddress.Data());
+    }
+    else if (TCReadConfig::GetReader()->GetConfigInt("Served.Remote"))
+    {
+        ss = new TServerSocket(gAddress.Atoi(), kTRUE);
+    }
+    else
+    {
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,28,0)
+        ss = new TServerSocket(gAddress.Atoi(), kTRUE, TServerSocket::kDefaultBacklog, -1,
+                               ESocketBindOption::kInaddrLoopback);
+#else
+        // binding to the loopback interface is not supported: accept only
+        // local connections (see below)
+        ss = new TServerSocket(gAddress.Atoi(), kTRUE);
+#endif
+    }
+
+    // check server socket
+    if (!ss->IsValid())
+    {
+        printf("Could not listen on '%s'!\n", gAddress.Data());
+        return 1;
+    }
+    printf("Serving calibrations on '%s' (checking for changes every %d s)\n",
+           gAddress.Data(), gCheckInterval);
+
+    // init monitor and clients
+    TMonitor mon;
+    mon.Add(ss);
+    TList clients;
+    clients.SetOwner(kTRUE);
+    time_t lastCheck = time(0);
+
+    // server loop (wake up every second to check for a stop request)
+    gStop = 0;
+    while (!gStop)
+    {
+        // wait for activity
+        TSocket* s = mon.Select(1000);
+
+        // check for changes
+        if (time(0) - lastCheck >= gCheckInterval)
+        {
+            CheckChanges();
+            lastCheck = time(0);
+        }
+
+        // timeout
+        if (s == (TSocket*)-1) continue;
+
+        // new connection
+        if (s == ss)
+        {
+            TSocket* c = ss->Accept();
+            if (c == (TSocket*)-1 || !c) continue;
+
+            // accept only local TCP clients unless remote clients are allowed
+            if (!gAddress.BeginsWith("/") && !TCReadConfig::GetReader()->GetConfigInt("Served.Remote"))
+            {
+                TString host = c->GetInetAddress().GetHostAddress();
+                if (!host.BeginsWith("127.") && host != "::1")
+                {
+                    Warning("main", "Rejected connection from '%s'", host.Data());
+                    c->Close();
+                    delete c;
+                    continue;
+                }
+            }
+
+            // add the client (non-blocking socket)
+            c->SetOption(kNoBlock, 1);
+            mon.Add(c);
+            clients.Add(new TCServedClient(c));
+            continue;
+        }
+
+        // find the client
+        TIter next(&clients);
+        TCServedClient* c;
+        while ((c = (TCServedClient*)next()))
+            if (c->fSocket == s) break;
+        if (!c) continue;
+
+        // send queued responses, receive and handle requests and send the
+        // new responses
+        if (SendResponses(c) && ReceiveRequests(c) && SendResponses(c))
+        {
+            // wait for writability only while responses are queued
+            mon.SetInterest(s, c->fOutBuffer.Length() ? TMonitor::kRead | TMonitor::kWrite : TMonitor::kRead);
+        }
+        else
+        {
+            mon.Remove(s);
+            s->Close();
+            delete s;
+            clients.Remove(c);
+            delete c;
+        }
+    }
+
+    // close the connections
+    mon.RemoveAll();
+    TIter next(&clients);
+    TCServedClient* c;
+    while ((c = (TCServedClient*)next()))
+    {
+        c->fSocket->Close();
+        delete c->fSocket;
+    }
+    ss->Close();
+    delete ss;
+
+    // remove the Unix socket
+    if (gAddress.BeginsWith("/")) gSystem->Unlink(gAddress.Data());
+
+    printf("Served %lld requests (%lld cache hits)\n", gNRequest, gNHit);
+
+    return 0;
+}
+
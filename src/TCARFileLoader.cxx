@@ -19,6 +19,8 @@
 #include "TFile.h"
 #include "TCReadConfig.h"
 #include "TCMySQLManager.h"
+#include "TCThreadPool.h"
+#include "TCARKeyIndex.h"
 #include "TRegexp.h"
 #include "TMath.h"
 
@@ -42,6 +44,14 @@ TCARFileLoader::TCARFileLoader(const Char_t* inputfilepathpatt)
 
     fNOpenFiles = 0;
 
+    fMaxOpenFiles = -1;
+    fNPooledFiles = 0;
+    fFileAvail = 0;
+    fFileAccess = 0;
+    fNFileAccess = 0;
+    fKeepKeyIndex = kFALSE;
+    fKeyIndex = 0;
+
     if (inputfilepathpatt)
     {
         // check if pattern is a directory
@@ -89,6 +99,14 @@ TCARFileLoader::TCARFileLoader(Int_t nruns, const Int_t* runs, const Char_t* inp
 
     fNOpenFiles = 0;
 
+    fMaxOpenFiles = -1;
+    fNPooledFiles = 0;
+    fFileAvail = 0;
+    fFileAccess = 0;
+    fNFileAccess = 0;
+    fKeepKeyIndex = kFALSE;
+    fKeyIndex = 0;
+
     if (inputfilepathpatt)
     {
         // check if pattern is a directory
@@ -124,12 +142,7 @@ TCARFileLoader::~TCARFileLoader()
     // Destructor
 
     if (fRuns) delete [] fRuns;
-    if (fFiles)
-    {
-        for (Int_t i = 0; i < fNFiles; i++)
-           if (fFiles[i]) delete fFiles[i];
-        delete [] fFiles;
-    }
+    ResetFileList();
     if (fInputFilePathPatt) delete fInputFilePathPatt;
 }
 
@@ -148,6 +161,21 @@ void TCARFileLoader::ResetFileList()
         fFiles = 0;
     }
 
+    // delete pool information and key indices
+    if (fFileAvail) delete [] fFileAvail;
+    if (fFileAccess) delete [] fFileAccess;
+    if (fKeyIndex)
+    {
+        for (Int_t i = 0; i < fNFiles; i++)
+            if (fKeyIndex[i]) delete fKeyIndex[i];
+        delete [] fKeyIndex;
+    }
+    fFileAvail = 0;
+    fFileAccess = 0;
+    fKeyIndex = 0;
+    fNPooledFiles = 0;
+    fNFileAccess = 0;
+
     // reset number of files
     fNFiles = 0;
 
@@ -192,55 +220,259 @@ Bool_t TCARFileLoader::CreateFileList()
         }
     }
 
-    // save the current directory, since it will be changed when opening the files
-    TString currdir(gDirectory->GetPath());
+    // read maximum number of open files from config
+    if (fMaxOpenFiles < 0)
+        SetMaxOpenFiles(TCReadConfig::GetReader()->GetConfigInt("File.MaxOpenFiles"));
 
     // create file array
     fNFiles = fNRuns;
     fFiles = new TFile*[fNFiles];
 
-    // loop over runs
-    for (Int_t i = 0; i < fNRuns; i++)
+    // create key index array (indices are built on first use)
+    fKeyIndex = new TCARKeyIndex*[fNFiles];
+    for (Int_t i = 0; i < fNFiles; i++) fKeyIndex[i] = 0;
+
+    // pool mode: files are opened on first access
+    if (IsPoolMode())
     {
-        // init file pointer
-        fFiles[i] = 0;
+        // create pool information
+        fFileAvail = new Bool_t[fNFiles];
+        fFileAccess = new Long64_t[fNFiles];
 
-        // construct file name
-        TString filename(*fInputFilePathPatt);
-        filename.ReplaceAll("RUN", TString::Format("%d", fRuns[i]));
+        // loop over runs
+        for (Int_t i = 0; i < fNRuns; i++)
+        {
+            // init file information
+            fFiles[i] = 0;
+            fFileAccess[i] = 0;
 
-        // try to open the file
-        TFile* f = TFile::Open(filename.Data(), "READ");
+            // construct file name
+            TString filename(*fInputFilePathPatt);
+            filename.ReplaceAll("RUN", TString::Format("%d", fRuns[i]));
 
+            // check for non-existing file
+            fFileAvail[i] = IsRegularFile(filename.Data());
+            if (!fFileAvail[i])
+            {
+                Warning("CreateFileList", "%03d : Could not find file '%s'", i, filename.Data());
+                continue;
+            }
+
+            // increment number of available files
+            fNOpenFiles++;
+        }
+
+        // user information
+        Info("CreateFileList", "Found %d of %d files (at most %d files will be open)",
+             fNOpenFiles, fNFiles, fMaxOpenFiles);
+
+        return kTRUE;
+    }
+
+    // construct file names
+    TString* filenames = new TString[fNRuns];
+    for (Int_t i = 0; i < fNRuns; i++)
+    {
+        filenames[i] = *fInputFilePathPatt;
+        filenames[i].ReplaceAll("RUN", TString::Format("%d", fRuns[i]));
+    }
+
+    // open the files concurrently (keeps the order of the runs)
+    Int_t* status = new Int_t[fNRuns];
+    TCThreadPool::OpenFiles(fNRuns, filenames, fFiles, status);
+
+    // loop over runs
+    for (Int_t i = 0; i < fNRuns; i++)
+    {
         // check for non-existing file
-        if (!f)
+        if (status[i] == TCThreadPool::kFileNotOpened)
         {
-            Warning("CreateFileList", "%03d : Could not open file '%s'", i, filename.Data());
+            Warning("CreateFileList", "%03d : Could not open file '%s'", i, filenames[i].Data());
             continue;
         }
 
         // check bad file
-        if (f->IsZombie())
+        if (status[i] == TCThreadPool::kFileZombie)
         {
-            Warning("CreateFileList", "%03d : Could not open zombie file '%s'", i, filename.Data());
-            delete f;
+            Warning("CreateFileList", "%03d : Could not open zombie file '%s'", i, filenames[i].Data());
             continue;
         }
 
-        // add file to list
-        fFiles[i] = f;
-
         // increment number of open files
         fNOpenFiles++;
 
         // user information
-        Info("CreateFileList", "%03d : added file '%s'", i, f->GetName());
+        Info("CreateFileList", "%03d : added file '%s'", i, fFiles[i]->GetName());
+    }
+
+    // clean-up
+    delete [] filenames;
+    delete [] status;
+
+    return kTRUE;
+}
+
+
+//______________________________________________________________________________
+TFile * const * TCARFileLoader::GetFiles() const
+{
+    // Returns the array of files. In pool mode only the currently open files
+    // are set, all other entries are NULL pointers.
+    // NOTE: this method is deprecated, use GetFile() to access the files.
+
+    // warn in pool mode
+    if (IsPoolMode())
+        Warning("GetFiles", "Only the open files are set in pool mode, use GetFile() instead!");
+
+    return fFiles;
+}
+
+//______________________________________________________________________________
+TFile* TCARFileLoader::GetFile(Int_t index)
+{
+    // Returns the file of the run with index 'index' or the NULL pointer if
+    // the file does not exist or cannot be opened. In pool mode the file is
+    // opened on first access and the least recently used file is closed if
+    // the maximum number of open files is reached.
+
+    // load files first (if not already loaded)
+    if (!LoadFiles()) return 0;
+
+    // check index
+    if (0 > index || index >= fNFiles) return 0;
+
+    // standard mode or file already open
+    if (!IsPoolMode() || fFiles[index])
+    {
+        if (fFileAccess) fFileAccess[index] = ++fNFileAccess;
+        return fFiles[index];
     }
 
+    // check for unavailable file
+    if (!fFileAvail[index]) return 0;
+
+    // close files if necessary
+    while (fNPooledFiles >= fMaxOpenFiles) CloseLeastRecentFile();
+
+    // save the current directory, since it will be changed when opening the file
+    TString currdir(gDirectory->GetPath());
+
+    // construct file name
+    TString filename(*fInputFilePathPatt);
+    filename.ReplaceAll("RUN", TString::Format("%d", fRuns[index]));
+
+    // try to open the file
+    TFile* f = TFile::Open(filename.Data(), "READ");
+
     // recover the current directory
     gDirectory->cd(currdir.Data());
 
-    return kTRUE;
+    // check for bad file
+    if (!f || f->IsZombie())
+    {
+        Warning("GetFile", "%03d : Could not open file '%s'", index, filename.Data());
+        if (f) delete f;
+        fFileAvail[index] = kFALSE;
+        fNOpenFiles--;
+        return 0;
+    }
+
+    // add file to pool
+    fFiles[index] = f;
+    fFileAccess[index] = ++fNFileAccess;
+    fNPooledFiles++;
+
+    return f;
+}
+
+
+//______________________________________________________________________________
+void TCARFileLoader::CloseLeastRecentFile()
+{
+    // Closes the least recently used open file of the pool. The key index of
+    // the file is kept if 'fKeepKeyIndex' is set.
+
+    // find least recently used file
+    Int_t lru = -1;
+    for (Int_t i = 0; i < fNFiles; i++)
+        if (fFiles[i] && (lru < 0 || fFileAccess[i] < fFileAccess[lru])) lru = i;
+
+    // check for open file
+    if (lru < 0)
+    {
+        fNPooledFiles = 0;
+        return;
+    }
+
+    // keep or delete the key index
+    if (fKeepKeyIndex)
+    {
+        if (!fKeyIndex[lru]) fKeyIndex[lru] = new TCARKeyIndex(fFiles[lru]);
+    }
+    else if (fKeyIndex[lru])
+    {
+        delete fKeyIndex[lru];
+        fKeyIndex[lru] = 0;
+    }
+
+    // close file
+    delete fFiles[lru];
+    fFiles[lru] = 0;
+    fNPooledFiles--;
+}
+
+
+//______________________________________________________________________________
+Bool_t TCARFileLoader::IsFileAvailable(Int_t index) const
+{
+    // Returns kTRUE if the file of the run with index 'index' exists and could
+    // be opened (or was not tried to be opened yet in pool mode), kFALSE otherwise.
+
+    // check index
+    if (!fFiles || 0 > index || index >= fNFiles) return kFALSE;
+
+    if (IsPoolMode()) return fFileAvail[index];
+    else return fFiles[index] != 0;
+}
+
+
+//______________________________________________________________________________
+TCARKeyIndex* TCARFileLoader::GetKeyIndex(Int_t index)
+{
+    // Returns the key index of the file of the run with index 'index' or the
+    // NULL pointer if the file is not available. The index is built on first
+    // use and kept as long as the file is open (or longer, c.f.
+    // SetKeepKeyIndex()).
+
+    // load files first (if not already loaded)
+    if (!LoadFiles()) return 0;
+
+    // check index
+    if (0 > index || index >= fNFiles) return 0;
+
+    // check for existing key index
+    if (fKeyIndex[index]) return fKeyIndex[index];
+
+    // get file
+    TFile* f = GetFile(index);
+    if (!f) return 0;
+
+    // build the key index
+    fKeyIndex[index] = new TCARKeyIndex(f);
+
+    return fKeyIndex[index];
+}
+
+
+//______________________________________________________________________________
+Bool_t TCARFileLoader::MayContainKey(Int_t index, const Char_t* name) const
+{
+    // Returns kFALSE if the key index of the file of the run with index
+    // 'index' shows that there is no key 'name', kTRUE otherwise.
+
+    if (!fKeyIndex || !fKeyIndex[index]) return kTRUE;
+
+    return fKeyIndex[index]->HasKey(name);
 }
 
 
@@ -44,7 +44,23 @@
 //          TH1** hsp1 hl.CreateHistoArrayOfProj("MyHistogram");
 //          TH1** hsp2 hl.CreateHistoArrayOfProj("MyHistogram", 'Y', 23, kLastBin);
 //
-//   4) ...
+//   4)   Load single element rows of 2D histograms, e.g.,
+//          hl.SetElementFilePathPatt("/path/to/Element_RUN.root");
+//          TH1* h = hl.CreateElementHistoSum("MyHistogram2D", 23);
+//        Now, h is the summed-up projection of the y-bin 24. Only the row of
+//        this element is read from the element-sliced files (c.f.
+//        TCElementStore). Runs without such a file are projected from the
+//        full histogram of the AR file.
+//
+//   5)   Streaming projections, e.g.,
+//          hl.SetStreamingProjection(kTRUE);
+//          TH1** hsp = hl.CreateHistoArrayOfProj("MyHistogram2D", 'X');
+//        The histograms of all runs are read into one scratch histogram per
+//        task and projected directly from the bin array in parallel (c.f.
+//        Parallel.Threads), i.e., the memory usage does not grow with the
+//        number of runs. Only the option "e" is supported.
+//
+//   6) ...
 //
 //
 // C) Naming histograms:
@@ -85,11 +101,90 @@
 #include "TFile.h"
 #include "TError.h"
 #include "TRegexp.h"
+#include "TSystem.h"
+#include "TObjArray.h"
+#include "TCElementStore.h"
+#include "TCARKeyIndex.h"
+#include "TCThreadPool.h"
 
 ClassImp(TCARHistoLoader)
 
 
 const Int_t TCARHistoLoader::kLastBin = -2147483648; // = (Int_t) 2^31
+const Int_t TCARHistoLoader::kNRunsPerTask = 8;
+
+
+// state of a streaming projection over all runs
+struct TCARHistoLoaderProj
+{
+    TCARHistoLoader* fLoader;           // histogram loader
+    Int_t fNRuns;                       // number of runs
+    const Char_t* fName;                // name of the histogram
+    Int_t fAxis;                        // projection axis (0: x, 1: y, 2: z)
+    Int_t fBin[4];                      // bin ranges of the other axes
+    Bool_t fErrors;                     // calculate errors
+    TH1D** fOut;                        //[fNRuns] projections
+    Int_t* fStatus;                     //[fNRuns] status (0: ok, 1: not found, 2: bad axis)
+};
+
+
+//______________________________________________________________________________
+static void TCARHistoLoaderProjTask(Int_t task, void* arg)
+{
+    // Project the histograms of the runs belonging to the task 'task'. All
+    // histograms are read into the same scratch histogram.
+
+    TCARHistoLoaderProj* s = (TCARHistoLoaderProj*) arg;
+
+    // get the range of runs
+    Int_t first = task * TCARHistoLoader::kNRunsPerTask;
+    Int_t last = first + TCARHistoLoader::kNRunsPerTask;
+    if (last > s->fNRuns) last = s->fNRuns;
+
+    // loop over runs
+    TH1* scratch = 0;
+    for (Int_t i = first; i < last; i++)
+    {
+        // init output
+        s->fOut[i] = 0;
+        s->fStatus[i] = 0;
+
+        // get file
+        TFile* f = s->fLoader->GetFile(i);
+        if (!f) continue;
+
+        // look-up histogram key
+        TKey* key = f->FindKey(s->fName);
+        TClass* cl = key ? TClass::GetClass(key->GetClassName()) : 0;
+        if (!cl || !cl->InheritsFrom("TH1"))
+        {
+            s->fStatus[i] = 1;
+            continue;
+        }
+
+        // read the histogram into the scratch histogram (if of same class)
+        if (scratch && strcmp(scratch->ClassName(), key->GetClassName()))
+        {
+            delete scratch;
+            scratch = 0;
+        }
+        if (scratch) key->Read(scratch);
+        else scratch = (TH1*) key->ReadObj();
+        if (!scratch)
+        {
+            s->fStatus[i] = 1;
+            continue;
+        }
+
+        // project the histogram
+        s->fOut[i] = TCARHistoLoader::ProjectBins(scratch, s->fAxis, s->fBin[0], s->fBin[1],
+                                                  s->fBin[2], s->fBin[3], s->fErrors, s->fName);
+        if (!s->fOut[i]) s->fStatus[i] = 2;
+    }
+
+    // clean up
+    if (scratch) delete scratch;
+}
 
 
 //______________________________________________________________________________
@@ -129,36 +224,22 @@ TH1* TCARHistoLoader::GetHisto(const TFile* f, const Char_t* hname, Bool_t detac
     // check for file
     if (!f) return 0;
 
-    // get list of histos
-    TList* list = f->GetListOfKeys();
-
-    // init result
-    TH1* hOut = 0;
-
-    // loop over keys
-    TIter next(list);
-    TKey* key;
-    while ((key = (TKey*) next()))
-    {
-        // check for histogram
-        TClass* cl = gROOT->GetClass(key->GetClassName());
-        if (!cl->InheritsFrom("TH1")) continue;
-
-        // check name
-        if (strcmp(hname, key->GetName())) continue;
-
-        // get histogram (detached)
-        Bool_t status = TH1::AddDirectoryStatus();
-        if (detach) TH1::AddDirectory(kFALSE);
-        else TH1::AddDirectory(kTRUE);
+    // look-up key (highest cycle)
+    TKey* key = f->FindKey(hname);
+    if (!key) return 0;
 
-        hOut = (TH1*) key->ReadObj();
+    // check for histogram
+    TClass* cl = TClass::GetClass(key->GetClassName());
+    if (!cl || !cl->InheritsFrom("TH1")) return 0;
 
-        TH1::AddDirectory(status);
+    // get histogram (detached)
+    Bool_t status = TH1::AddDirectoryStatus();
+    if (detach) TH1::AddDirectory(kFALSE);
+    else TH1::AddDirectory(kTRUE);
 
-        break;
+    TH1* hOut = (TH1*) key->ReadObj();
 
-    } // loop over keys
+    TH1::AddDirectory(status);
 
     return hOut;
 }
@@ -172,6 +253,8 @@ TH1** TCARHistoLoader::GetHistos(const TFile* f, const Char_t* hpatt, Int_t& nhi
     // returned via 'nhistos,'
     // If detach is kTRUE it is detached from the file.
     // Returns 0 if the histogram does not exist.
+    // NOTE: the key index of the file is built for every call. Use
+    //       GetHistosForIndex() to profit from the cached key index.
 
     // init return variable
     nhistos = 0;
@@ -179,56 +262,48 @@ TH1** TCARHistoLoader::GetHistos(const TFile* f, const Char_t* hpatt, Int_t& nhi
     // check for file
     if (!f) return 0;
 
-    // get list of histos
-    TList* list = f->GetListOfKeys();
-    list->Sort();
+    // build key index
+    TCARKeyIndex index(f);
 
-    // get maximal number of histograms
-    Int_t nmaxhistos = list->GetSize();;
-
-    // prepare histogram array
-    TH1** hOut_tmp = new TH1*[nmaxhistos];
+    // read histos
+    return ReadHistos(f, index.Match(hpatt), nhistos, detach);
+}
 
-    // ceate regexp
-    TRegexp r(hpatt);
 
-    // loop over keys
-    TIter next(list);
-    TKey* key;
-    while ((key = (TKey*) next()))
-    {
-        // check for histogram
-        TClass* cl = gROOT->GetClass(key->GetClassName());
-        if (!cl->InheritsFrom("TH1")) continue;
+//______________________________________________________________________________
+TH1** TCARHistoLoader::ReadHistos(const TFile* f, const TObjArray* names, Int_t& nhistos, Bool_t detach)
+{
+    // Returns the array of the histograms with the names (TObjString) 'names'
+    // read from the file 'f'. Its length is returned via 'nhistos'.
+    // If detach is kTRUE it is detached from the file.
 
-        // get name
-        TString hname(key->GetName());
+    // init return variable
+    nhistos = 0;
 
-        // check pattern
-        if (!hname.Contains(r)) continue;
+    // check for file
+    if (!f || !names) return 0;
 
-        // get histogram (detached)
-        Bool_t status = TH1::AddDirectoryStatus();
-        if (detach) TH1::AddDirectory(kFALSE);
-        else TH1::AddDirectory(kTRUE);
+    // prepare histogram array
+    TH1** hOut = new TH1*[names->GetEntriesFast()];
 
-        TH1* h = (TH1*) key->ReadObj();
+    // get histograms (detached)
+    Bool_t status = TH1::AddDirectoryStatus();
+    if (detach) TH1::AddDirectory(kFALSE);
+    else TH1::AddDirectory(kTRUE);
 
-        TH1::AddDirectory(status);
+    // loop over names
+    for (Int_t i = 0; i < names->GetEntriesFast(); i++)
+    {
+        // look-up key
+        TKey* key = f->FindKey(names->UncheckedAt(i)->GetName());
+        if (!key) continue;
 
         // add to list
-        hOut_tmp[nhistos] = h;
+        hOut[nhistos] = (TH1*) key->ReadObj();
         nhistos++;
+    }
 
-    } // loop over keys
-
-    // create final array
-    TH1** hOut = new TH1*[nhistos];
-    for (Int_t i = 0; i < nhistos; i++)
-        hOut[i] = hOut_tmp[i];
-
-    // clean up
-    delete [] hOut_tmp;
+    TH1::AddDirectory(status);
 
     return hOut;
 }
@@ -277,17 +352,28 @@ TH1* TCARHistoLoader::GetHistoForIndex(const Char_t* hname, Int_t index, const C
     // load files first (if not already loaded)
     if (!LoadFiles()) return 0;
 
+    // check the key index of a closed file
+    if (!MayContainKey(index, hname))
+    {
+        Error("GetHistoForIndex", "Histogram '%s' was not found in file of run %d!",
+                                  hname, fRuns[index]);
+        return 0;
+    }
+
+    // get file (opened on first access in pool mode)
+    TFile* f = GetFile(index);
+
     // check for file
-    if (!fFiles[index]) return 0;
+    if (!f) return 0;
 
     // get histogram detached
-    TH1* h = GetHisto(fFiles[index], hname);
+    TH1* h = GetHisto(f, hname);
 
     // check for histogram
     if (!h)
     {
         Error("GetHistoForIndex", "Histogram '%s' was not found in file '%s'!",
-                                  hname, fFiles[index]->GetName());
+                                  hname, f->GetName());
         return 0;
     }
 
@@ -340,6 +426,21 @@ TH1** TCARHistoLoader::GetHistosForIndex(const Char_t* hpatt, Int_t index, Int_t
     // Returns an array of histograms for the run 'run' maching the pattern
     // 'hpatt'.
 
+    return GetHistosForIndex(1, &hpatt, index, nhistos, houtnamepatt);
+}
+
+
+//______________________________________________________________________________
+TH1** TCARHistoLoader::GetHistosForIndex(Int_t npatt, const Char_t** hpatts, Int_t index, Int_t& nhistos,
+                                         const Char_t* houtnamepatt /*= 0*/)
+{
+    // Returns an array of histograms for the run with index 'index' maching
+    // any of the 'npatt' patterns 'hpatts'. The patterns are looked up in the
+    // cached key index of the file (c.f. TCARKeyIndex).
+
+    // init return variable
+    nhistos = 0;
+
     // check index
     if (0 > index || index >= fNRuns)
     {
@@ -347,11 +448,18 @@ TH1** TCARHistoLoader::GetHistosForIndex(const Char_t* hpatt, Int_t index, Int_t
         return 0;
     }
 
-    // load files first (if not already loaded)
-    if (!LoadFiles()) return 0;
+    // get the key index (opens the file on first access in pool mode)
+    TCARKeyIndex* keys = GetKeyIndex(index);
+    if (!keys) return 0;
+
+    // get file
+    TFile* f = GetFile(index);
+    if (!f) return 0;
 
     // get the histos
-    TH1** hOut = GetHistos(fFiles[index], hpatt, nhistos);
+    TObjArray* names = keys->Match(npatt, hpatts);
+    TH1** hOut = ReadHistos(f, names, nhistos);
+    delete names;
 
     if (!hOut) return 0;
 
@@ -579,6 +687,59 @@ TH1** TCARHistoLoader::CreateHistoArrayOfProj(const Char_t* hname, const Char_t
     // load files first (if not already loaded)
     if (!LoadFiles()) return 0;
 
+    // streaming projection
+    if (fStreamProj)
+    {
+        // project all runs
+        Int_t axis = isX ? 0 : (isY ? 1 : 2);
+        Bool_t errors = option && (strchr(option, 'e') || strchr(option, 'E'));
+
+        // check for unsupported options
+        TString opt(option);
+        opt.ToLower();
+        opt.ReplaceAll("e", "");
+        opt.ReplaceAll(" ", "");
+        if (opt != "")
+            Warning("CreateHistoArrayOfProj", "Streaming projection supports only option 'e', ignoring '%s'!", option);
+
+        TH1D** hp = ProjectAll(hname, axis, fbin1, lbin1, fbin2, lbin2, errors);
+        if (!hp) return 0;
+
+        // loop over runs
+        Bool_t isFound = kFALSE;
+        for (Int_t i = 0; i < fNRuns; i++)
+        {
+            if (!hp[i]) continue;
+            isFound = kTRUE;
+
+            // set histogram name
+            if (houtnamepatt)
+            {
+                // user defined name
+                hp[i]->SetName(hname);
+                SetHistoName(hp[i], houtnamepatt, i);
+            }
+            else
+            {
+                // standard name, i.e. "<histoname>_<runnumber>_p<axis>"
+                hp[i]->SetName(TString::Format("%s_%d_p%c", hname, fRuns[i], "xyz"[axis]).Data());
+            }
+
+            // set directory
+            if (TH1::AddDirectoryStatus())
+                hp[i]->SetDirectory(fHistoDirectory);
+        }
+
+        // reset output array if no histogram was loaded
+        if (!isFound)
+        {
+            delete [] hp;
+            return 0;
+        }
+
+        return (TH1**) hp;
+    }
+
     // create histogram array
     TH1** hOut = new TH1*[fNRuns];
 
@@ -736,14 +897,60 @@ TH2D* TCARHistoLoader::CreateHistoOfProj(const Char_t* hname, const Char_t proja
     // declare out histo
     TH2D* hOut = 0;
 
+    // streaming projection
+    if (fStreamProj)
+    {
+        // project all runs
+        TH1D** hp = ProjectAll(hname, isX ? 0 : (isY ? 1 : 2), 1, -1, 1, -1, kTRUE);
+        if (!hp) return 0;
+
+        // loop over runs
+        for (Int_t i = 0; i < fNRuns; i++)
+        {
+            if (!hp[i]) continue;
+
+            // create output histogram (if not created yet)
+            if (!hOut)
+            {
+                Char_t newtitle[256];
+                sprintf(newtitle, "%s;%s;Run index", hp[i]->GetTitle(), hp[i]->GetXaxis()->GetTitle());
+                hOut = new TH2D(hname, newtitle, hp[i]->GetNbinsX(), hp[i]->GetBinLowEdge(1),
+                                hp[i]->GetBinLowEdge(hp[i]->GetNbinsX() + 1), fNRuns, 0, fNRuns);
+            }
+
+            // loop over bins
+            for (Int_t j = 0; j < hOut->GetNbinsX(); j++)
+            {
+                // add bin content and bin error
+                hOut->SetBinContent(j+1, i+1, hp[i]->GetBinContent(j+1));
+                hOut->SetBinError(j+1, i+1, hp[i]->GetBinError(j+1));
+            }
+
+            // clean up
+            delete hp[i];
+        }
+
+        // clean up
+        delete [] hp;
+
+        // set directory
+        if (hOut && TH1::AddDirectoryStatus())
+            hOut->SetDirectory(fHistoDirectory);
+
+        return hOut;
+    }
+
     // declare reference histo
     TH1* href = 0;
 
     // loop over files
     for (Int_t i = 0; i < fNRuns; i++)
     {
+        // get file (opened on first access in pool mode)
+        TFile* f = GetFile(i);
+
         // check for file
-        if (!fFiles[i]) continue;
+        if (!f) continue;
 
         // get histogram detached
         Bool_t status = TH1::AddDirectoryStatus();
@@ -755,7 +962,7 @@ TH2D* TCARHistoLoader::CreateHistoOfProj(const Char_t* hname, const Char_t proja
         if (!h)
         {
             Error("CreateHistoOfProj", "Histogram '%s' was not found in file '%s'!",
-                                      hname, fFiles[i]->GetName());
+                                      hname, f->GetName());
             continue;
         }
 
@@ -763,7 +970,7 @@ TH2D* TCARHistoLoader::CreateHistoOfProj(const Char_t* hname, const Char_t proja
         if (!h->InheritsFrom("TH1"))
         {
             Error("CreateHistoOfProj", "Object named '%s' of file '%s' is not a histogram!",
-                                       hname, fFiles[i]->GetName());
+                                       hname, f->GetName());
 
             // delete h form memory
             h->ResetBit(kMustCleanup);
@@ -878,5 +1085,281 @@ TH2D* TCARHistoLoader::CreateHistoOfProj(const Char_t* hname, const Char_t proja
     return hOut;
 }
 
+//______________________________________________________________________________
+TH1* TCARHistoLoader::GetElementHistoForIndex(const Char_t* hname, Int_t elem, Int_t index,
+                                              const Char_t* houtnamepatt /*= 0*/)
+{
+    // Returns the projection of the element 'elem' (y-bin 'elem'+1) of the 2D
+    // histogram with name 'hname' of the run with index 'index'. The row is
+    // read from the element-sliced file (see TCElementStore) if the pattern
+    // was set via SetElementFilePathPatt() and the file exists, otherwise the
+    // full histogram is loaded from the AR file and projected. The histogram
+    // is named '<hname>_<elem>_<runnumber>' or renamed according to the
+    // 'houtnamepatt'.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    // check index
+    if (0 > index || index >= fNRuns)
+    {
+        Error("GetElementHistoForIndex", "Index '%d' out allowed range [0,%d]!", index, TMath::Max(0, fNRuns-1));
+        return 0;
+    }
+
+    // declare projection histogram
+    TH1* hp = 0;
+
+    // create projection histogram name
+    Char_t hpname[256];
+    sprintf(hpname, "%s_%d_%d", hname, elem, fRuns[index]);
+
+    // try the element-sliced file
+    Bool_t status = TH1::AddDirectoryStatus();
+    if (fElementFilePathPatt != "")
+    {
+        TString filename(fElementFilePathPatt);
+        filename.ReplaceAll("RUN", TString::Format("%d", fRuns[index]));
+        if (!gSystem->AccessPathName(filename.Data()))
+        {
+            TCElementStore store(filename.Data());
+            hp = store.GetElement(hname, elem);
+        }
+    }
+
+    // project the full histogram
+    if (!hp)
+    {
+        TH1::AddDirectory(kFALSE);
+        TH1* h = GetHistoForIndex(hname, index);
+        if (h)
+        {
+            if (h->GetDimension() == 2)
+                hp = ((TH2*) h)->ProjectionX(hpname, elem+1, elem+1, "e");
+            else
+                Error("GetElementHistoForIndex", "Histogram '%s' is not a 2D histogram!", hname);
+            delete h;
+        }
+    }
+    TH1::AddDirectory(status);
+
+    // check for histogram
+    if (!hp) return 0;
+
+    // set histogram name
+    if (houtnamepatt) SetHistoName(hp, houtnamepatt, index);
+    else hp->SetName(hpname);
+
+    // set directory
+    if (TH1::AddDirectoryStatus())
+        hp->SetDirectory(fHistoDirectory);
+
+    return hp;
+}
+
+
+//______________________________________________________________________________
+TH1* TCARHistoLoader::CreateElementHistoSum(const Char_t* hname, Int_t elem,
+                                            const Char_t* houtnamepatt /*= 0*/)
+{
+    // Creates the summed-up projection of the element 'elem' (y-bin 'elem'+1)
+    // of the 2D histogram with name 'hname' (see GetElementHistoForIndex()).
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    // check for run list
+    if (!fRuns && !LoadFiles()) return 0;
+
+    // init pointer to sum histo
+    TH1* hSum = 0;
+
+    // loop over runs
+    for (Int_t i = 0; i < fNRuns; i++)
+    {
+        // get histogram detached
+        Bool_t status = TH1::AddDirectoryStatus();
+        TH1::AddDirectory(kFALSE);
+        TH1* h = GetElementHistoForIndex(hname, elem, i);
+        TH1::AddDirectory(status);
+
+        // check for histo
+        if (!h) continue;
+
+        // sum up histos
+        if (!hSum)
+            hSum = h;
+        else
+        {
+            hSum->Add(h);
+            delete h;
+        }
+    }
+
+    // check for histo
+    if (!hSum) return 0;
+
+    // set histogram name
+    if (houtnamepatt)
+    {
+        // set user name (run and index are not defined for sums)
+        TString tmp(houtnamepatt);
+        tmp.ReplaceAll("#NAME", hname);
+        hSum->SetName(tmp);
+    }
+    else
+    {
+        // set default name
+        Char_t tmp[256];
+        sprintf(tmp, "%s_%d_Sum", hname, elem);
+        hSum->SetName(tmp);
+    }
+
+    // set directory
+    if (TH1::AddDirectoryStatus())
+        hSum->SetDirectory(fHistoDirectory);
+
+    return hSum;
+}
+
+//______________________________________________________________________________
+TH1D* TCARHistoLoader::ProjectBins(const TH1* h, Int_t axis, Int_t fbin1, Int_t lbin1,
+                                   Int_t fbin2, Int_t lbin2, Bool_t errors, const Char_t* name)
+{
+    // Returns the projection of the histogram 'h' on the axis 'axis' (0: x,
+    // 1: y, 2: z) named 'name'. The projection is filled directly from the bin
+    // array of 'h' summing over the bins 'fbin1' to 'lbin1' of the first and
+    // 'fbin2' to 'lbin2' of the second of the other axes (in the order x, y, z,
+    // as for TH2/TH3::ProjectionX/Y/Z()). The errors are calculated if 'errors'
+    // is kTRUE or if 'h' stores the sum of squares of weights.
+    // Returns 0 if 'h' has no such axis.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    // check axis
+    Int_t dim = h->GetDimension();
+    if (axis < 0 || axis >= dim) return 0;
+
+    // get the axes
+    const TAxis* ax[3] = { h->GetXaxis(), h->GetYaxis(), h->GetZaxis() };
+
+    // get the bin ranges of the other axes
+    Int_t lo[3] = { 0, 0, 0 };
+    Int_t hi[3] = { 0, 0, 0 };
+    Int_t first[2] = { fbin1, fbin2 };
+    Int_t last[2] = { lbin1, lbin2 };
+    Int_t n = 0;
+    for (Int_t i = 0; i < dim; i++)
+    {
+        Int_t nbins = ax[i]->GetNbins();
+
+        // projection axis (incl. under- and overflow)
+        if (i == axis)
+        {
+            lo[i] = 0;
+            hi[i] = nbins + 1;
+            continue;
+        }
+
+        // other axis (same conventions as the ROOT projections)
+        Int_t f = first[n];
+        Int_t l = last[n];
+        n++;
+        if (l == kLastBin) l = nbins;
+        if (f < 0) f = 0;
+        if (l < 0 || l > nbins + 1) l = nbins + 1;
+        if (f > l)
+        {
+            f = 0;
+            l = nbins + 1;
+        }
+        lo[i] = f;
+        hi[i] = l;
+    }
+
+    // create the projection histogram
+    const TAxis* pa = ax[axis];
+    TH1D* hOut;
+    if (pa->GetXbins()->GetSize())
+        hOut = new TH1D(name, h->GetTitle(), pa->GetNbins(), pa->GetXbins()->GetArray());
+    else
+        hOut = new TH1D(name, h->GetTitle(), pa->GetNbins(), pa->GetXmin(), pa->GetXmax());
+    hOut->GetXaxis()->SetTitle(pa->GetTitle());
+
+    // init errors
+    const Double_t* sumw2 = h->GetSumw2N() ? h->GetSumw2()->GetArray() : 0;
+    if (sumw2) errors = kTRUE;
+    if (errors) hOut->Sumw2();
+    Double_t* outw2 = errors ? hOut->GetSumw2()->GetArray() : 0;
+
+    // sum up the bins
+    for (Int_t z = lo[2]; z <= hi[2]; z++)
+    {
+        for (Int_t y = lo[1]; y <= hi[1]; y++)
+        {
+            for (Int_t x = lo[0]; x <= hi[0]; x++)
+            {
+                Int_t bin = h->GetBin(x, y, z);
+                Int_t p = axis == 0 ? x : (axis == 1 ? y : z);
+                Double_t c = h->GetBinContent(bin);
+                hOut->AddBinContent(p, c);
+                if (outw2) outw2[p] += sumw2 ? sumw2[bin] : c;
+            }
+        }
+    }
+
+    // recalculate statistics
+    hOut->ResetStats();
+
+    return hOut;
+}
+
+
+//______________________________________________________________________________
+TH1D** TCARHistoLoader::ProjectAll(const Char_t* hname, Int_t axis, Int_t fbin1, Int_t lbin1,
+                                   Int_t fbin2, Int_t lbin2, Bool_t errors)
+{
+    // Returns the array (length 'fNRuns') of the projections (see ProjectBins())
+    // of the histogram 'hname' of all runs. The runs are processed in parallel
+    // (c.f. TCThreadPool) unless the files are opened on demand (pool mode).
+    // Only one scratch histogram per task is kept in memory. The projection
+    // of a missing histogram is set to 0.
+    // NOTE: the array (incl. histograms) has to be destroyed by the caller.
+
+    // load files first (if not already loaded)
+    if (!LoadFiles()) return 0;
+
+    // init task state
+    TCARHistoLoaderProj s;
+    s.fLoader = this;
+    s.fNRuns = fNRuns;
+    s.fName = hname;
+    s.fAxis = axis;
+    s.fBin[0] = fbin1;
+    s.fBin[1] = lbin1;
+    s.fBin[2] = fbin2;
+    s.fBin[3] = lbin2;
+    s.fErrors = errors;
+    s.fOut = new TH1D*[fNRuns];
+    s.fStatus = new Int_t[fNRuns];
+
+    // project the histograms (serially if files are opened on demand)
+    Int_t nTask = (fNRuns + kNRunsPerTask - 1) / kNRunsPerTask;
+    Bool_t status = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(kFALSE);
+    TCThreadPool::Run(nTask, TCARHistoLoaderProjTask, &s,
+                      IsPoolMode() ? 1 : TCThreadPool::LimitIOThreads(TCThreadPool::GetNThreads()));
+    TH1::AddDirectory(status);
+
+    // report errors in run order
+    for (Int_t i = 0; i < fNRuns; i++)
+    {
+        if (s.fStatus[i] == 1)
+            Error("ProjectAll", "Histogram '%s' was not found in file of run %d!", hname, fRuns[i]);
+        else if (s.fStatus[i] == 2)
+            Error("ProjectAll", "Cannot project histogram '%s' of run %d on axis %d!", hname, fRuns[i], axis);
+    }
+
+    // clean up
+    delete [] s.fStatus;
+
+    return s.fOut;
+}
+
 // finito
 
@@ -0,0 +1,239 @@
+/************************************************************************
+ * Author: Thomas Strub                                                 *
+ ************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCARKeyIndex                                                         //
+//                                                                      //
+// Key index of an AR file.                                             //
+//                                                                      //
+// The index is built once from the key list of a file. It contains    //
+// the names of all keys (hashed), the sorted names of the histogram    //
+// keys and the histogram names grouped by class. The class of every    //
+// key type is resolved only once. The matches of regular expression    //
+// patterns are memoised and several new patterns are matched in a      //
+// single scan over the histogram names.                                //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "TDirectory.h"
+#include "TKey.h"
+#include "TClass.h"
+#include "THashList.h"
+#include "TObjArray.h"
+#include "TObjString.h"
+#include "TRegexp.h"
+
+#include "TCARKeyIndex.h"
+
+ClassImp(TCARKeyIndex)
+
+
+//______________________________________________________________________________
+TCARKeyIndex::TCARKeyIndex(const TDirectory* dir)
+    : TObject()
+{
+    // Constructor building the index of the keys of the directory 'dir'.
+
+    // init members
+    fNames = new THashList();
+    fNames->SetOwner(kTRUE);
+    fHistos = new TList();
+    fNHistos = 0;
+    fClasses = new THashList();
+    fClasses->SetOwner(kTRUE);
+    fHistoClasses = new THashList();
+    fHistoClasses->SetOwner(kTRUE);
+    fPatterns = new THashList();
+    fPatterns->SetOwner(kTRUE);
+
+    // check directory
+    if (!dir) return;
+
+    // loop over keys
+    TIter next(dir->GetListOfKeys());
+    TKey* key;
+    while ((key = (TKey*) next()))
+    {
+        // skip older cycles (the highest cycle comes first)
+        if (fNames->FindObject(key->GetName())) continue;
+
+        // add name
+        TObjString* name = new TObjString(key->GetName());
+        fNames->Add(name);
+
+        // get the class group (resolve the class only once per type)
+        // NOTE: the groups do not own the names, so no status bit must be
+        //       set on them (BIT(14) is TCollection::kIsOwner)
+        TList* group = (TList*) fClasses->FindObject(key->GetClassName());
+        if (!group)
+        {
+            group = new TList();
+            group->SetName(key->GetClassName());
+            TClass* cl = TClass::GetClass(key->GetClassName());
+            if (cl && cl->InheritsFrom("TH1")) fHistoClasses->Add(new TObjString(key->GetClassName()));
+            fClasses->Add(group);
+        }
+
+        // check for histogram
+        if (!fHistoClasses->FindObject(key->GetClassName())) continue;
+
+        // add to histograms
+        name->SetBit(kIsHisto);
+        group->Add(name);
+        fHistos->Add(name);
+    }
+
+    // sort histograms and set their indices
+    fHistos->Sort();
+    TIter nextHisto(fHistos);
+    TObjString* name;
+    while ((name = (TObjString*) nextHisto()))
+        name->SetUniqueID(fNHistos++);
+
+    // sort the histograms of each class
+    TIter nextGroup(fClasses);
+    TList* group;
+    while ((group = (TList*) nextGroup()))
+        if (group->GetSize()) group->Sort();
+}
+
+
+//______________________________________________________________________________
+TCARKeyIndex::~TCARKeyIndex()
+{
+    // Destructor
+
+    if (fPatterns) delete fPatterns;
+    if (fClasses) delete fClasses;
+    if (fHistoClasses) delete fHistoClasses;
+    if (fHistos) delete fHistos;
+    if (fNames) delete fNames;
+}
+
+
+//______________________________________________________________________________
+const TList* TCARKeyIndex::GetHistosOfClass(const Char_t* cl) const
+{
+    // Returns the sorted list of the names of the histograms of class 'cl' or
+    // 0 if there is no such histogram.
+
+    if (!fClasses || !fHistoClasses->FindObject(cl)) return 0;
+
+    TList* group = (TList*) fClasses->FindObject(cl);
+    if (!group) return 0;
+
+    return group;
+}
+
+
+//______________________________________________________________________________
+Bool_t TCARKeyIndex::HasKey(const Char_t* name) const
+{
+    // Returns kTRUE if there is a key named 'name', kFALSE otherwise.
+
+    return fNames && fNames->FindObject(name);
+}
+
+
+//______________________________________________________________________________
+Bool_t TCARKeyIndex::IsHisto(const Char_t* name) const
+{
+    // Returns kTRUE if there is a histogram key named 'name', kFALSE otherwise.
+
+    if (!fNames) return kFALSE;
+
+    TObject* o = fNames->FindObject(name);
+
+    return o && o->TestBit(kIsHisto);
+}
+
+
+//______________________________________________________________________________
+const TObjArray* TCARKeyIndex::Match(const Char_t* hpatt)
+{
+    // Returns the sorted array of the names (TObjString) of the histograms
+    // matching the pattern 'hpatt'. The result is memoised.
+    // NOTE: the array is owned by the index.
+
+    if (!fPatterns) return 0;
+
+    // look-up memoised pattern
+    TObjArray* m = (TObjArray*) fPatterns->FindObject(hpatt);
+    if (m) return m;
+
+    // match the pattern
+    delete Match(1, &hpatt);
+
+    return (TObjArray*) fPatterns->FindObject(hpatt);
+}
+
+
+//______________________________________________________________________________
+TObjArray* TCARKeyIndex::Match(Int_t npatt, const Char_t** hpatts)
+{
+    // Returns the sorted array of the names (TObjString) of the histograms
+    // matching any of the 'npatt' patterns 'hpatts'. All patterns that were
+    // not memoised yet are matched in a single scan over the histogram names.
+    // NOTE: the array (but not its content) has to be destroyed by the caller.
+
+    // create output array
+    TObjArray* out = new TObjArray();
+
+    if (!fPatterns) return out;
+
+    // get the memoised matches and compile the new patterns
+    TObjArray** matches = new TObjArray*[npatt];
+    TRegexp** regexps = new TRegexp*[npatt];
+    Int_t nnew = 0;
+    for (Int_t i = 0; i < npatt; i++)
+    {
+        regexps[i] = 0;
+        matches[i] = (TObjArray*) fPatterns->FindObject(hpatts[i]);
+        if (matches[i]) continue;
+
+        // memoise the new pattern
+        matches[i] = new TObjArray();
+        matches[i]->SetName(hpatts[i]);
+        fPatterns->Add(matches[i]);
+        regexps[i] = new TRegexp(hpatts[i]);
+        nnew++;
+    }
+
+    // match the new patterns in a single scan
+    if (nnew)
+    {
+        TIter next(fHistos);
+        TObjString* name;
+        while ((name = (TObjString*) next()))
+        {
+            for (Int_t i = 0; i < npatt; i++)
+                if (regexps[i] && name->GetString().Contains(*regexps[i])) matches[i]->Add(name);
+        }
+    }
+
+    // mark the selected histograms
+    Bool_t* sel = new Bool_t[fNHistos];
+    for (Int_t i = 0; i < fNHistos; i++) sel[i] = kFALSE;
+    for (Int_t i = 0; i < npatt; i++)
+        for (Int_t j = 0; j < matches[i]->GetEntriesFast(); j++)
+            sel[matches[i]->UncheckedAt(j)->GetUniqueID()] = kTRUE;
+
+    // collect the selected histograms in sorted order
+    TIter next(fHistos);
+    TObjString* name;
+    while ((name = (TObjString*) next()))
+        if (sel[name->GetUniqueID()]) out->Add(name);
+
+    // clean up
+    for (Int_t i = 0; i < npatt; i++)
+        if (regexps[i]) delete regexps[i];
+    delete [] regexps;
+    delete [] matches;
+    delete [] sel;
+
+    return out;
+}
+
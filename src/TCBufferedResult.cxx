@@ -0,0 +1,91 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCBufferedResult                                                     //
+//                                                                      //
+// SQL query result holding all rows in memory.                         //
+//                                                                      //
+// All rows of a result are fetched when the buffered result is         //
+// created. This allows to time a query including the transfer of the   //
+// rows and to know the number of rows for all database back-ends       //
+// (TSQLiteResult::GetRowCount() returns -1).                           //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "TSQLRow.h"
+#include "TObjString.h"
+
+#include "TCBufferedResult.h"
+
+ClassImp(TCBufferedResult)
+
+//______________________________________________________________________________
+TCBufferedResult::TCBufferedResult(TSQLResult* res)
+    : TSQLResult()
+{
+    // Constructor fetching all rows of the result 'res'. The result 'res' is
+    // destroyed.
+
+    // init members
+    fRowCount = 0;
+    fFieldNames.SetOwner(kTRUE);
+
+    // check result
+    if (!res) return;
+
+    // copy the field names
+    for (Int_t i = 0; i < res->GetFieldCount(); i++)
+        fFieldNames.Add(new TObjString(res->GetFieldName(i)));
+
+    // fetch all rows
+    TSQLRow* row;
+    while ((row = res->Next()))
+    {
+        fRows.Add(row);
+        fRowCount++;
+    }
+
+    // clean-up
+    delete res;
+}
+
+//______________________________________________________________________________
+TCBufferedResult::~TCBufferedResult()
+{
+    // Destructor.
+
+    Close();
+}
+
+//______________________________________________________________________________
+void TCBufferedResult::Close(Option_t* option)
+{
+    // Delete all rows not returned yet.
+
+    fRows.Delete();
+}
+
+//______________________________________________________________________________
+const char* TCBufferedResult::GetFieldName(Int_t field)
+{
+    // Return the name of the field 'field'.
+
+    if (field < 0 || field >= fFieldNames.GetEntriesFast()) return 0;
+    return ((TObjString*) fFieldNames.At(field))->GetString().Data();
+}
+
+//______________________________________________________________________________
+TSQLRow* TCBufferedResult::Next()
+{
+    // Return the next row or 0 if there are no more rows.
+    // NOTE: the row has to be destroyed by the caller.
+
+    TObject* row = fRows.First();
+    if (row) fRows.Remove(row);
+    return (TSQLRow*) row;
+}
+
@@ -13,24 +13,46 @@
 
 #include <algorithm>
 
-#include "TH1.h"
+#include "TH2.h"
+#include "TFile.h"
+#include "TArrayD.h"
 #include "TF1.h"
 #include "TCanvas.h"
 #include "TStyle.h"
 #include "TTimer.h"
 #include "TTimeStamp.h"
 #include "TSystem.h"
+#include "TROOT.h"
 #include "TGClient.h"
 #include "KeySymbols.h"
+#include "Math/MinimizerOptions.h"
 
 #include "TCCalib.h"
 #include "TCUtils.h"
 #include "TCMySQLManager.h"
 #include "TCReadConfig.h"
+#include "TCThreadPool.h"
+#include "TCHistoRows.h"
+#include "TCFitUtils.h"
 
 
 ClassImp(TCCalib)
 
+
+const Int_t TCCalib::kNElemPerTask = 4;
+
+
+// state of a parallel fit of all remaining elements
+struct TCCalibFitTask
+{
+    TCCalib* fCalib;                    // calibration module
+    Int_t fFirst;                       // first element
+    Int_t fN;                           // number of elements
+    TH1** fHisto;                       //[fN] fitting histograms
+    TF1** fFunc;                        //[fN] fitting functions (0: no fit)
+    Double_t* fPos;                     //[fN] fitted positions
+};
+
 //______________________________________________________________________________
 TCCalib::~TCCalib()
 {
@@ -40,12 +62,16 @@ TCCalib::~TCCalib()
     if (fOldVal) delete [] fOldVal;
     if (fNewVal) delete [] fNewVal;
     if (fMainHisto) delete fMainHisto;
+    if (fMainRows) delete fMainRows;
     if (fFitHisto) delete fFitHisto;
     if (fFitFunc) delete fFitFunc;
     if (fOverviewHisto) delete fOverviewHisto;
     //if (fCanvasFit) delete fCanvasFit;            // comment this to prevent crash
     //if (fCanvasResult) delete fCanvasResult;      // comment this to prevent crash
     if (fTimer) delete fTimer;
+    if (fNFit) delete [] fNFit;
+    if (fFitPar) delete [] fFitPar;
+    if (fSeedPar) delete [] fSeedPar;
     //if (fIgnore) delete [] fIgnore;
 }
 
@@ -64,6 +90,8 @@ void TCCalib::Start(const Char_t* calibration, Int_t nSet, Int_t* set)
     fCurrentElem = 0;
 
     fMainHisto = 0;
+    if (fMainRows) delete fMainRows;
+    fMainRows = 0;
     fFitHisto = 0;
     fFitFunc = 0;
 
@@ -80,6 +108,14 @@ void TCCalib::Start(const Char_t* calibration, Int_t nSet, Int_t* set)
     fNIgnore = 0;
     fIgnore = 0;
 
+    if (fNFit) delete [] fNFit;
+    fNFit = new Int_t[fNelem];
+    for (Int_t i = 0; i < fNelem; i++) fNFit[i] = 0;
+    if (fFitPar) delete [] fFitPar;
+    fFitPar = new TArrayD[fNelem];
+    if (fSeedPar) delete [] fSeedPar;
+    fSeedPar = new TArrayD[fNelem];
+
     // read the convergence factor
     Char_t tmp[256];
     sprintf(tmp, "%s.ConvergenceFactor", GetName());
@@ -127,6 +163,9 @@ void TCCalib::Start(const Char_t* calibration, Int_t nSet, Int_t* set)
         fNewVal[i] = 0;
     }
 
+    // read the fit parameters of the previous iteration
+    ReadFitPar();
+
     // user information
     Info("Start", "Starting calibration module %s", GetName());
     Info("Start", "Module description: %s", GetTitle());
@@ -148,15 +187,30 @@ void TCCalib::Start(const Char_t* calibration, Int_t nSet, Int_t* set)
     gStyle->SetStatColor(10);
     gStyle->SetFillColor(10);
 
-    // draw the fitting canvas
-    fCanvasFit = new TCanvas("Fitting", "Fitting", 0, 0, 400, 800);
+    // use batch mode when ROOT runs without graphics
+    if (gROOT->IsBatch()) fBatchMode = kTRUE;
 
-    // connect event handler
-    fCanvasFit->Connect("ProcessedEvent(Int_t, Int_t, Int_t, TObject*)", "TCCalib", this,
-                        "EventHandler(Int_t, Int_t, Int_t, TObject*)");
+    // check for batch mode
+    if (fBatchMode)
+    {
+        // user information
+        Info("Start", "Running in batch mode");
 
-    // draw the result canvas
-    fCanvasResult = new TCanvas("Result", "Result", gClient->GetDisplayWidth() - 900, 0, 900, 400);
+        // create the result canvas (off-screen, only rendered when saved)
+        fCanvasResult = CreateCanvas("Result", "Result", 0, 0, 900, 400);
+    }
+    else
+    {
+        // draw the fitting canvas
+        fCanvasFit = new TCanvas("Fitting", "Fitting", 0, 0, 400, 800);
+
+        // connect event handler
+        fCanvasFit->Connect("ProcessedEvent(Int_t, Int_t, Int_t, TObject*)", "TCCalib", this,
+                            "EventHandler(Int_t, Int_t, Int_t, TObject*)");
+
+        // draw the result canvas
+        fCanvasResult = new TCanvas("Result", "Result", gClient->GetDisplayWidth() - 900, 0, 900, 400);
+    }
 
     // init sub-class
     Init();
@@ -214,7 +268,12 @@ void TCCalib::ProcessElement(Int_t elem, Bool_t ignorePrev)
         {
             if (!ignorePrev) Calculate(fCurrentElem);
             else printf("Ignoring element %d\n", fCurrentElem);
-            fCanvasResult->Update();
+            if (!fBatchMode) fCanvasResult->Update();
+
+            // report number of fits
+            Int_t nFit = GetNFits();
+            if (nFit) Info("ProcessElement", "Performed %d fits (%.2f per element)",
+                           nFit, (Double_t)nFit / fNelem);
         }
 
         // exit
@@ -238,10 +297,11 @@ void TCCalib::ProcessElement(Int_t elem, Bool_t ignorePrev)
 //______________________________________________________________________________
 void TCCalib::ProcessAll(Int_t msecDelay)
 {
-    // Process all elements using 'msecDelay' milliseconds delay.
+    // Process all elements using 'msecDelay' milliseconds delay. The delay
+    // is ignored in batch mode.
 
     // check for delay
-    if (msecDelay > 0)
+    if (msecDelay > 0 && !fBatchMode)
     {
         // start automatic iteration
         fTimer->Start(msecDelay);
@@ -249,11 +309,105 @@ void TCCalib::ProcessAll(Int_t msecDelay)
     }
     else
     {
+        // fit the remaining elements in parallel in batch mode
+        if (fBatchMode && ProcessAllParallel()) return;
+
         // loop over elements
         for (Int_t i = 0; i < fNelem; i++) Next();
     }
 }
 
+//______________________________________________________________________________
+Bool_t TCCalib::ProcessAllParallel()
+{
+    // Fit all elements following the current element concurrently using the
+    // configured number of threads. The results are then set and calculated
+    // in element order, i.e., they are identical to the ones of the serial
+    // processing. Return kFALSE if the module does not support parallel
+    // fitting or if the fits cannot be run in parallel, otherwise kTRUE.
+
+    // check module and number of threads
+    if (!IsParallelFitSupported()) return kFALSE;
+    Int_t nThreads = TCThreadPool::GetNThreads();
+    if (nThreads < 2) return kFALSE;
+
+    // check the thread-safety of the fitting
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,0,0)
+    Info("ProcessAllParallel", "Parallel fitting requires ROOT 6 - fitting serially");
+    return kFALSE;
+#else
+    if (ROOT::Math::MinimizerOptions::DefaultMinimizerType() != "Minuit2")
+    {
+        Info("ProcessAllParallel", "Parallel fitting requires the Minuit2 minimizer - fitting serially");
+        return kFALSE;
+    }
+#endif
+
+    // get the remaining elements
+    Int_t first = fCurrentElem + 1;
+    Int_t n = fNelem - first;
+    if (n < 1) return kFALSE;
+
+    // init task state
+    TCCalibFitTask s;
+    s.fCalib = this;
+    s.fFirst = first;
+    s.fN = n;
+    s.fHisto = new TH1*[n];
+    s.fFunc = new TF1*[n];
+    s.fPos = new Double_t[n];
+
+    // create the histograms and the fitting functions
+    for (Int_t i = 0; i < n; i++)
+    {
+        s.fHisto[i] = CreateFitHisto(first + i);
+        s.fFunc[i] = CreateFitFunc(first + i, s.fHisto[i]);
+        s.fPos[i] = 0;
+    }
+
+    // fit the elements
+    Int_t nTask = (n + kNElemPerTask - 1) / kNElemPerTask;
+    TCThreadPool::Run(nTask, FitTask, &s, nThreads);
+
+    // set the results and calculate the elements in element order
+    for (Int_t i = 0; i < n; i++)
+    {
+        Calculate(fCurrentElem);
+        fCurrentElem = first + i;
+        SetFitResult(fCurrentElem, s.fHisto[i], s.fFunc[i], s.fPos[i]);
+    }
+
+    // calculate last element
+    ProcessElement(fNelem);
+
+    // clean-up
+    delete [] s.fHisto;
+    delete [] s.fFunc;
+    delete [] s.fPos;
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+void TCCalib::FitTask(Int_t task, void* arg)
+{
+    // Fit the elements belonging to the task 'task'.
+
+    TCCalibFitTask* s = (TCCalibFitTask*) arg;
+
+    // get the range of elements
+    Int_t first = task * kNElemPerTask;
+    Int_t last = first + kNElemPerTask;
+    if (last > s->fN) last = s->fN;
+
+    // fit the elements having a fitting function
+    for (Int_t i = first; i < last; i++)
+    {
+        if (s->fFunc[i])
+            s->fPos[i] = s->fCalib->FitElement(s->fFirst + i, s->fHisto[i], s->fFunc[i]);
+    }
+}
+
 //______________________________________________________________________________
 void TCCalib::Previous()
 {
@@ -348,15 +502,40 @@ void TCCalib::WriteValues()
     for (Int_t i = 0; i < fNset; i++)
         TCMySQLManager::GetManager()->WriteParameters(fData.Data(), fCalibration.Data(), fSet[i], fNewVal, fNelem);
 
+    // save the fit parameters for the next iteration
+    WriteFitPar();
+
     // save overview picture
     SaveCanvas(fCanvasResult, "Overview");
 }
 
+//______________________________________________________________________________
+TCanvas* TCCalib::CreateCanvas(const Char_t* name, const Char_t* title,
+                               Int_t wtopx, Int_t wtopy, UInt_t ww, UInt_t wh)
+{
+    // Create a canvas. In batch mode the canvas is created off-screen and
+    // is only rendered when it is saved.
+
+    // normal canvas
+    if (!fBatchMode) return new TCanvas(name, title, wtopx, wtopy, ww, wh);
+
+    // create off-screen canvas
+    Bool_t batch = gROOT->IsBatch();
+    gROOT->SetBatch(kTRUE);
+    TCanvas* c = new TCanvas(name, title, wtopx, wtopy, ww, wh);
+    gROOT->SetBatch(batch);
+
+    return c;
+}
+
 //______________________________________________________________________________
 void TCCalib::SaveCanvas(TCanvas* c, const Char_t* name)
 {
     // Save the canvas 'c' to disk using the name 'name'.
 
+    // check canvas
+    if (!c) return;
+
     // get log directory
     if (TString* path = TCReadConfig::GetReader()->GetConfig("Log.Images"))
     {
@@ -382,6 +561,215 @@ void TCCalib::SaveCanvas(TCanvas* c, const Char_t* name)
     }
 }
 
+//______________________________________________________________________________
+TH1* TCCalib::GetElementHisto(Int_t elem, const Char_t* name)
+{
+    // Return the projection of the element 'elem' of the main histogram named
+    // 'name'. This corresponds to ProjectionX(name, elem+1, elem+1, "e") but
+    // the main histogram is converted only once to element rows (see
+    // TCHistoRows::GetRowHisto()).
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    // convert the main histogram
+    if (!fMainRows) fMainRows = new TCHistoRows((TH2*) fMainHisto);
+
+    return fMainRows->GetRowHisto(elem, name);
+}
+
+//______________________________________________________________________________
+TH1* TCCalib::CreateFitHisto(Int_t elem)
+{
+    // Return the projection of the element 'elem' of the main histogram
+    // formatted as fitting histogram.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    Char_t tmp[256];
+
+    // create histogram projection for this element
+    sprintf(tmp, "ProjHisto_%i", elem);
+    TH1* h = GetElementHisto(elem, tmp);
+
+    // format histogram
+    h->SetFillColor(35);
+    sprintf(tmp, "%s.Histo.Fit", GetName());
+    TCUtils::FormatHistogram(h, tmp);
+
+    return h;
+}
+
+//______________________________________________________________________________
+void TCCalib::SetFitResult(Int_t elem, TH1* h, TF1* func, Double_t pos)
+{
+    // Set the histogram 'h' and, if the element 'elem' was fitted, the
+    // function 'func' with the fitted position 'pos' as the current fitting
+    // objects. The old objects are destroyed.
+
+    // set histogram
+    if (fFitHisto && fFitHisto != h) delete fFitHisto;
+    fFitHisto = h;
+
+    // set function
+    if (func)
+    {
+        if (fFitFunc && fFitFunc != func) delete fFitFunc;
+        fFitFunc = func;
+
+        // keep the fit parameters
+        if (fFitPar) fFitPar[elem].Set(func->GetNpar(), func->GetParameters());
+    }
+}
+
+//______________________________________________________________________________
+TString TCCalib::GetFitParFile() const
+{
+    // Return the path of the fit parameter file of the calibration data, the
+    // calibration identifier and the sets or an empty string if no fit
+    // parameter directory was configured via File.FitPar.Dir.
+
+    // get the directory
+    TString* dir = TCReadConfig::GetReader()->GetConfig("File.FitPar.Dir");
+    if (!dir) return "";
+    TString fn = *dir;
+    gSystem->ExpandPathName(fn);
+
+    // add data, calibration and sets
+    fn += TString::Format("/%s_%s", fData.Data(), fCalibration.Data());
+    for (Int_t i = 0; i < fNset; i++) fn += TString::Format("_%d", fSet[i]);
+    fn += ".root";
+
+    return fn;
+}
+
+//______________________________________________________________________________
+void TCCalib::ReadFitPar()
+{
+    // Read the fit parameters of the previous iteration from the fit parameter
+    // file. They are used to seed the fits (see SeedFitFunc()).
+
+    // check for file
+    TString fn = GetFitParFile();
+    if (fn == "" || gSystem->AccessPathName(fn.Data())) return;
+
+    // open the file
+    TDirectory* dirOrig = gDirectory;
+    TFile* f = new TFile(fn.Data());
+    if (f->IsZombie())
+    {
+        Error("ReadFitPar", "Could not open the fit parameter file '%s'!", fn.Data());
+        delete f;
+        dirOrig->cd();
+        return;
+    }
+
+    // read the parameters of all elements
+    Int_t n = 0;
+    for (Int_t i = 0; i < fNelem; i++)
+    {
+        TArrayD* par = 0;
+        f->GetObject(TString::Format("Par_%d", i).Data(), par);
+        if (!par) continue;
+        fSeedPar[i] = *par;
+        delete par;
+        n++;
+    }
+
+    // clean-up
+    delete f;
+    dirOrig->cd();
+
+    // user information
+    Info("ReadFitPar", "Seeding the fits of %d elements from '%s'", n, fn.Data());
+}
+
+//______________________________________________________________________________
+void TCCalib::WriteFitPar()
+{
+    // Write the fit parameters of all fitted elements to the fit parameter
+    // file to seed the fits of the next iteration.
+
+    // check for file
+    TString fn = GetFitParFile();
+    if (fn == "" || !fFitPar) return;
+
+    // create the directory
+    TString dir = fn(0, fn.Last('/'));
+    if (gSystem->AccessPathName(dir.Data()) && gSystem->mkdir(dir.Data(), kTRUE))
+    {
+        Error("WriteFitPar", "Could not create the fit parameter directory '%s'!", dir.Data());
+        return;
+    }
+
+    // write to temporary file
+    TString tmp = TString::Format("%s.%d.tmp", fn.Data(), gSystem->GetPid());
+    TDirectory* dirOrig = gDirectory;
+    TFile* f = new TFile(tmp.Data(), "recreate");
+    if (f->IsZombie())
+    {
+        Error("WriteFitPar", "Could not write the fit parameter file '%s'!", fn.Data());
+        delete f;
+        dirOrig->cd();
+        return;
+    }
+
+    // write the parameters of all fitted elements
+    Int_t n = 0;
+    for (Int_t i = 0; i < fNelem; i++)
+    {
+        if (!fFitPar[i].GetSize()) continue;
+        f->WriteObjectAny(&fFitPar[i], "TArrayD", TString::Format("Par_%d", i).Data());
+        n++;
+    }
+
+    // clean-up
+    delete f;
+    dirOrig->cd();
+
+    // move to final location
+    if (gSystem->Rename(tmp.Data(), fn.Data()))
+    {
+        Error("WriteFitPar", "Could not move the fit parameter file to '%s'!", fn.Data());
+        gSystem->Unlink(tmp.Data());
+        return;
+    }
+
+    // user information
+    Info("WriteFitPar", "Saved the fit parameters of %d elements to '%s'", n, fn.Data());
+}
+
+//______________________________________________________________________________
+Bool_t TCCalib::SeedFitFunc(Int_t elem, TF1* func) const
+{
+    // Set the parameters of the fitting function 'func' of the element 'elem'
+    // to the fit parameters of the previous iteration restricted to the
+    // parameter limits. Fixed parameters are not changed. Return kFALSE if no
+    // matching parameters exist, otherwise kTRUE.
+    // NOTE: only the modules reporting their fits via SetFitResult() (time and
+    //       energy modules) save and use these parameters.
+
+    // check parameters
+    if (!fSeedPar || fSeedPar[elem].GetSize() != func->GetNpar()) return kFALSE;
+
+    // set parameters
+    for (Int_t i = 0; i < func->GetNpar(); i++)
+        TCFitUtils::SetParameterInLimits(func, i, fSeedPar[elem].At(i));
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Int_t TCCalib::GetNFits() const
+{
+    // Return the total number of fits performed in the last fit of all
+    // elements.
+
+    if (!fNFit) return 0;
+
+    Int_t n = 0;
+    for (Int_t i = 0; i < fNelem; i++) n += fNFit[i];
+
+    return n;
+}
+
 //______________________________________________________________________________
 Bool_t TCCalib::IsIgnored(Int_t elem)
 {
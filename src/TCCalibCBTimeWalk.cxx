@@ -134,6 +134,9 @@ void TCCalibCBTimeWalk::Init()
     TCMySQLManager::GetManager()->ReadParameters("Data.CB.Walk.Par2", fCalibration.Data(), fSet[0], fPar2, fNelem);
     TCMySQLManager::GetManager()->ReadParameters("Data.CB.Walk.Par3", fCalibration.Data(), fSet[0], fPar3, fNelem);
 
+    // skip drawing in batch mode
+    if (fBatchMode) return;
+
     // draw main histogram
     fCanvasFit->Divide(1, 2, 0.001, 0.001);
     fCanvasFit->cd(1)->SetLogz();
@@ -175,11 +178,14 @@ void TCCalibCBTimeWalk::Fit(Int_t elem)
     // draw main histogram
     if (!fIsReFit)
     {
-        if (fMainHisto->GetEntries() > 0) fCanvasFit->cd(1)->SetLogz(1);
-        else fCanvasFit->cd(1)->SetLogz(0);
         TCUtils::FormatHistogram(fMainHisto, "CB.TimeWalk.Histo.Fit");
-        fMainHisto->Draw("colz");
-        fCanvasFit->Update();
+        if (!fBatchMode)
+        {
+            if (fMainHisto->GetEntries() > 0) fCanvasFit->cd(1)->SetLogz(1);
+            else fCanvasFit->cd(1)->SetLogz(0);
+            fMainHisto->Draw("colz");
+            fCanvasFit->Update();
+        }
     }
 
     // check for sufficient statistics
@@ -329,7 +335,7 @@ void TCCalibCBTimeWalk::Fit(Int_t elem)
         }
 
         // plot projection fit
-        if (fDelay > 0)
+        if (fDelay > 0 && !fBatchMode)
         {
             fCanvasFit->cd(2);
             fTimeProj->GetXaxis()->SetRangeUser(mean - 30, mean + 30);
@@ -421,6 +427,7 @@ void TCCalibCBTimeWalk::Fit(Int_t elem)
 
     // draw energy projection and fit
     fFitFunc->SetRange(-fFitFunc->GetParameter(2), 1000);
+    if (fBatchMode) return;
     fCanvasResult->cd();
     fGFitPoints->Draw("ap");
     fGFitPoints->GetXaxis()->SetLimits(lowLimit, highLimit);
@@ -0,0 +1,209 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCCalibClient                                                        //
+//                                                                      //
+// Client of the calibration server calib_served.                       //
+//                                                                      //
+// Protocol (binary, native byte order):                                //
+//   request  : Int_t request, Int_t run, Int_t data length,            //
+//              Int_t calibration length, data, calibration             //
+//   response : Int_t status (1 on success), Int_t number of            //
+//              parameters n, n Double_t parameters                     //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "TError.h"
+#include "TString.h"
+#include "TSocket.h"
+
+#include "TCCalibClient.h"
+#include "TCReadConfig.h"
+#include "TCConfig.h"
+
+ClassImp(TCCalibClient)
+
+//______________________________________________________________________________
+TCCalibClient::TCCalibClient(const Char_t* address)
+{
+    // Constructor connecting to the calibration server at 'address', which is
+    // either the path of a Unix socket or a TCP address 'host:port'.
+    // If 'address' is 0 the address is taken from the configuration
+    // (Served.Address).
+
+    // init members
+    fSocket = 0;
+
+    // get the address
+    TString addr;
+    if (address) addr = address;
+    else if (TString* a = TCReadConfig::GetReader()->GetConfig("Served.Address")) addr = *a;
+    else
+    {
+        Error("TCCalibClient", "No calibration server address given!");
+        return;
+    }
+
+    // connect to server
+    if (addr.BeginsWith("/"))
+    {
+        fSocket = new TSocket(addr.Data());
+    }
+    else
+    {
+        // get host and port
+        TString host = "localhost";
+        Int_t port;
+        Ssiz_t pos = addr.Last(':');
+        if (pos == kNPOS) port = addr.Atoi();
+        else
+        {
+            host = addr(0, pos);
+            port = TString(addr(pos+1, addr.Length())).Atoi();
+        }
+        fSocket = new TSocket(host.Data(), port);
+    }
+
+    // check connection
+    if (!fSocket->IsValid())
+    {
+        Error("TCCalibClient", "Could not connect to the calibration server '%s'!", addr.Data());
+        delete fSocket;
+        fSocket = 0;
+    }
+}
+
+//______________________________________________________________________________
+TCCalibClient::~TCCalibClient()
+{
+    // Destructor.
+
+    if (fSocket)
+    {
+        fSocket->Close();
+        delete fSocket;
+    }
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibClient::IsConnected() const
+{
+    // Check if the connection to the server is open.
+
+    return fSocket && fSocket->IsValid();
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibClient::SendRequest(CalibServerRequest_t req, Int_t run,
+                                  const Char_t* data, const Char_t* calibration)
+{
+    // Send the request 'req' for the run 'run', the calibration data 'data'
+    // and the calibration identifier 'calibration' to the server.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // check connection
+    if (!IsConnected())
+    {
+        Error("SendRequest", "No connection to the calibration server!");
+        return kFALSE;
+    }
+
+    // create the request
+    Int_t head[4] = { req, run, (Int_t)strlen(data), (Int_t)strlen(calibration) };
+    TString msg;
+    msg.Append((const Char_t*)head, sizeof(head));
+    msg.Append(data);
+    msg.Append(calibration);
+
+    // send the request
+    if (fSocket->SendRaw(msg.Data(), msg.Length()) != msg.Length())
+    {
+        Error("SendRequest", "Could not send the request to the calibration server!");
+        return kFALSE;
+    }
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibClient::Ping()
+{
+    // Check if the server answers.
+    // Return kTRUE on success, otherwise kFALSE.
+
+    // send request
+    if (!SendRequest(kSERVER_PING, 0, "", "")) return kFALSE;
+
+    // receive response
+    Int_t resp[2];
+    if (fSocket->RecvRaw(resp, sizeof(resp)) != sizeof(resp)) return kFALSE;
+
+    return resp[0] == 1;
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibClient::ReadParametersRun(const Char_t* data, const Char_t* calibration, Int_t run,
+                                        Double_t* par, Int_t length)
+{
+    // Read 'length' parameters of the calibration data 'data' for the calibration identifier
+    // 'calibration' valid for the run 'run' from the server to the value array 'par'.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // send request
+    if (!SendRequest(kSERVER_READ_PAR_RUN, run, data, calibration)) return kFALSE;
+
+    // receive response header
+    Int_t resp[2];
+    if (fSocket->RecvRaw(resp, sizeof(resp)) != sizeof(resp))
+    {
+        Error("ReadParametersRun", "No response from the calibration server!");
+        return kFALSE;
+    }
+
+    // check status
+    if (resp[0] != 1)
+    {
+        Error("ReadParametersRun", "No set of '%s' found for run %d", data, run);
+        return kFALSE;
+    }
+
+    // check the number of parameters (the stream cannot be resynchronized)
+    Int_t nPar = resp[1];
+    if (nPar < 0 || nPar > TCConfig::kMaxCrystal)
+    {
+        Error("ReadParametersRun", "Invalid number of parameters %d received - closing the connection!", nPar);
+        fSocket->Close();
+        return kFALSE;
+    }
+
+    // receive the parameters
+    Double_t* tmp = new Double_t[nPar];
+    Int_t size = nPar*sizeof(Double_t);
+    if (nPar && fSocket->RecvRaw(tmp, size) != size)
+    {
+        Error("ReadParametersRun", "Could not receive the parameters from the calibration server!");
+        delete [] tmp;
+        return kFALSE;
+    }
+
+    // check number of parameters
+    if (length > nPar)
+    {
+        Error("ReadParametersRun", "Only %d parameters of '%s' available!", nPar, data);
+        delete [] tmp;
+        return kFALSE;
+    }
+
+    // copy the parameters
+    for (Int_t i = 0; i < length; i++) par[i] = tmp[i];
+
+    // clean-up
+    delete [] tmp;
+
+    return kTRUE;
+}
+
@@ -146,8 +146,11 @@ void TCCalibDeltaETrad::Init()
     memcpy(fGainNew, fGainOld, fNelem * sizeof(Double_t));
 
     // draw main histogram
-    fCanvasFit->Divide(1, 2, 0.001, 0.001);
-    fCanvasFit->cd(1)->SetLogz();
+    if (!fBatchMode)
+    {
+        fCanvasFit->Divide(1, 2, 0.001, 0.001);
+        fCanvasFit->cd(1)->SetLogz();
+    }
 
     // open the MC file
     fMCFile = new TFile(fileMC.Data());
@@ -171,8 +174,11 @@ void TCCalibDeltaETrad::Init()
     }
 
     // draw main histogram
-    fCanvasFit->cd(1);
-    fMCHisto->Draw("colz");
+    if (!fBatchMode)
+    {
+        fCanvasFit->cd(1);
+        fMCHisto->Draw("colz");
+    }
 
     // create the pion position overview histogram
     fPionPos = new TH1F("Pion position overview", ";Element;pion peak position [MeV]", fNelem, 0, fNelem);
@@ -198,8 +204,11 @@ void TCCalibDeltaETrad::Init()
     sprintf(tmp, "%s.Histo.Fit", GetName());
     TCUtils::FormatHistogram(fMCHisto, tmp);
     FitSlice(fMCHisto);
-    fCanvasFit->Update();
-    gSystem->Sleep(5000);
+    if (!fBatchMode)
+    {
+        fCanvasFit->Update();
+        gSystem->Sleep(5000);
+    }
 
     // user information
     Info("Init", "Fitting of MC data finished");
@@ -295,6 +304,16 @@ void TCCalibDeltaETrad::FitSlice(TH2* h)
     // format line
     fLine2->SetPos(fProtonData);
 
+    // save MC data
+    if (h == fMCHisto)
+    {
+        fPionMC = fPionData;
+        fProtonMC = fProtonData;
+    }
+
+    // skip drawing in batch mode
+    if (fBatchMode) return;
+
     // plot histogram and line
     fCanvasFit->cd(2);
     fFitHisto->GetXaxis()->SetRangeUser(0, fFitFunc->GetParameter(6) + 4*fFitFunc->GetParameter(7));
@@ -303,13 +322,6 @@ void TCCalibDeltaETrad::FitSlice(TH2* h)
     fLine->Draw();
     fLine2->Draw();
 
-    // save MC data
-    if (h == fMCHisto)
-    {
-        fPionMC = fPionData;
-        fProtonMC = fProtonData;
-    }
-
     fCanvasFit->Update();
 }
 
@@ -352,11 +364,14 @@ void TCCalibDeltaETrad::Fit(Int_t elem)
     }
 
     // draw main histogram
-    fCanvasFit->cd(1);
     sprintf(tmp, "%s.Histo.Fit", GetName());
     TCUtils::FormatHistogram(fMainHisto, tmp);
-    fMainHisto->Draw("colz");
-    fCanvasFit->Update();
+    if (!fBatchMode)
+    {
+        fCanvasFit->cd(1);
+        fMainHisto->Draw("colz");
+        fCanvasFit->Update();
+    }
 
     // check for sufficient statistics
     if (fMainHisto->GetEntries())
@@ -365,6 +380,9 @@ void TCCalibDeltaETrad::Fit(Int_t elem)
         FitSlice((TH2*)fMainHisto);
     }
 
+    // skip drawing in batch mode
+    if (fBatchMode) return;
+
     // update overview
     fCanvasResult->cd(1);
     fPionPos->Draw("E1");
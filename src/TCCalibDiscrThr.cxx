@@ -22,6 +22,7 @@
 #include "TCMySQLManager.h"
 #include "TCUtils.h"
 #include "TCReadARCalib.h"
+#include "TCHistoRows.h"
 
 ClassImp(TCCalibDiscrThr)
 
@@ -38,6 +39,7 @@ TCCalibDiscrThr::TCCalibDiscrThr(const Char_t* name, const Char_t* title, const
     fPed = 0;
     fGain = 0;
     fMainHisto2 = 0;
+    fMainRows2 = 0;
     fDeriv = 0;
     fThr = 0;
     fLine = 0;
@@ -53,6 +55,7 @@ TCCalibDiscrThr::~TCCalibDiscrThr()
     if (fPed) delete [] fPed;
     if (fGain) delete [] fGain;
     if (fMainHisto2) delete fMainHisto2;
+    if (fMainRows2) delete fMainRows2;
     if (fDeriv) delete fDeriv;
     if (fLine) delete fLine;
 }
@@ -69,6 +72,7 @@ void TCCalibDiscrThr::Init()
     fPed = 0;
     fGain = 0;
     fMainHisto2 = 0;
+    fMainRows2 = 0;
     fDeriv = 0;
     fThr = 0;
     fLine = new TLine();
@@ -163,6 +167,7 @@ void TCCalibDiscrThr::Init()
             Error("Init", "Normalization histogram does not exist!\n");
             return;
         }
+        fMainRows2 = new TCHistoRows(fMainHisto2);
     }
 
     // create the overview histogram
@@ -171,7 +176,7 @@ void TCCalibDiscrThr::Init()
     fOverviewHisto->SetMarkerColor(4);
 
     // draw main histogram
-    fCanvasFit->Divide(1, 2, 0.001, 0.001);
+    if (!fBatchMode) fCanvasFit->Divide(1, 2, 0.001, 0.001);
     if (!fADC)
     {
         sprintf(tmp, "%s.Histo.Fit", GetName());
@@ -203,15 +208,15 @@ void TCCalibDiscrThr::Fit(Int_t elem)
     else
     {
         sprintf(tmp, "ProjHisto_%i", elem);
-        TH2* h2 = (TH2*) fMainHisto;
         if (fFitHisto) delete fFitHisto;
-        fFitHisto = (TH1D*) h2->ProjectionX(tmp, elem+1, elem+1, "e");
+        fFitHisto = GetElementHisto(elem, tmp);
     }
 
     // create projection of the normalization histogram
     if (fMainHisto2)
     {
-        TH1* hNorm = (TH1D*) fMainHisto2->ProjectionX(tmp, elem+1, elem+1, "e");
+        sprintf(tmp, "ProjNormHisto_%i", elem);
+        TH1* hNorm = fMainRows2->GetRowHisto(elem, tmp);
         fFitHisto->Divide(hNorm);
         delete hNorm;
     }
@@ -278,18 +283,21 @@ void TCCalibDiscrThr::Fit(Int_t elem)
             }
 
             // draw histogram
-            fCanvasFit->cd(2);
             if (fPed)
                 fDeriv->GetXaxis()->SetRangeUser(fThr-7, fThr+7);
             else
                 fDeriv->GetXaxis()->SetRangeUser(fThr-20, fThr+20);
-            fDeriv->Draw("hist");
+            if (!fBatchMode)
+            {
+                fCanvasFit->cd(2);
+                fDeriv->Draw("hist");
 
-            // draw function
-            if (fFitFunc) fFitFunc->Draw("same");
+                // draw function
+                if (fFitFunc) fFitFunc->Draw("same");
 
-            // draw indicator line
-            fLine->Draw();
+                // draw indicator line
+                fLine->Draw();
+            }
 
             // draw mean indicator line
             fLine->SetY1(0);
@@ -299,14 +307,20 @@ void TCCalibDiscrThr::Fit(Int_t elem)
 
             // draw histogram
             fFitHisto->SetFillColor(35);
-            fCanvasFit->cd(1);
-            fFitHisto->Draw("hist");
+            if (!fBatchMode)
+            {
+                fCanvasFit->cd(1);
+                fFitHisto->Draw("hist");
 
-            // draw indicator line
-            fLine->Draw();
+                // draw indicator line
+                fLine->Draw();
+            }
         }
     }
 
+    // skip drawing in batch mode
+    if (fBatchMode) return;
+
     // update canvas
     fCanvasFit->Update();
 
@@ -115,13 +115,19 @@ void TCCalibDroop::Init()
     }
     else fHistoName = *TCReadConfig::GetReader()->GetConfig(tmp);
 
+    // sum up all element histograms in one pass over the files
+    fFileManager->PrefetchElements(fHistoName.Data(), 0, fNelem-1);
+
     // get projection fit display delay
     sprintf(tmp, "%s.Fit.Delay", GetName());
     fDelay = TCReadConfig::GetReader()->GetConfigInt(tmp);
 
     // draw main histogram
-    fCanvasFit->Divide(1, 2, 0.001, 0.001);
-    fCanvasFit->cd(1)->SetLogz();
+    if (!fBatchMode)
+    {
+        fCanvasFit->Divide(1, 2, 0.001, 0.001);
+        fCanvasFit->cd(1)->SetLogz();
+    }
 }
 
 //______________________________________________________________________________
@@ -242,7 +248,7 @@ void TCCalibDroop::FitSlices(TH3* h, Int_t elem)
     fLine->SetX2(peakTotal);
 
     // plot projection fit
-    if (fDelay > 0)
+    if (fDelay > 0 && !fBatchMode)
     {
         TCUtils::FormatHistogram(fProj2D, TString::Format("%s.Histo.Fit", GetName()).Data());
         fCanvasFit->cd(1);
@@ -315,7 +321,7 @@ void TCCalibDroop::FitSlices(TH3* h, Int_t elem)
         }
 
         // plot projection fit
-        if (fDelay > 0)
+        if (fDelay > 0 && !fBatchMode)
         {
             TCUtils::FormatHistogram(fProj2D, TString::Format("%s.Histo.Fit", GetName()).Data());
             fCanvasFit->cd(1);
@@ -394,9 +400,12 @@ void TCCalibDroop::Fit(Int_t elem)
         fLinPlot->GetYaxis()->SetRangeUser(0.5, 1.5);
 
         // plot linear plot
-        fCanvasResult->cd();
-        fLinPlot->Draw("ap");
-        fCanvasResult->Update();
+        if (!fBatchMode)
+        {
+            fCanvasResult->cd();
+            fLinPlot->Draw("ap");
+            fCanvasResult->Update();
+        }
 
     } // if: sufficient statistics
 }
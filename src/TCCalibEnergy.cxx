@@ -15,6 +15,7 @@
 #include "TCanvas.h"
 #include "TH2.h"
 #include "TF1.h"
+#include "TRandom3.h"
 
 #include "TCCalibEnergy.h"
 #include "TCMySQLManager.h"
@@ -92,11 +93,14 @@ void TCCalibEnergy::Init()
     fOverviewHisto->SetMarkerColor(4);
 
     // draw main histogram
-    fCanvasFit->Divide(1, 2, 0.001, 0.001);
-    fCanvasFit->cd(1)->SetLogz();
     sprintf(tmp, "%s.Histo.Fit", GetName());
     TCUtils::FormatHistogram(fMainHisto, tmp);
-    fMainHisto->Draw("colz");
+    if (!fBatchMode)
+    {
+        fCanvasFit->Divide(1, 2, 0.001, 0.001);
+        fCanvasFit->cd(1)->SetLogz();
+        fMainHisto->Draw("colz");
+    }
 
     // draw the overview histogram
     fCanvasResult->cd();
@@ -110,80 +114,27 @@ void TCCalibEnergy::Fit(Int_t elem)
 {
     // Perform the fit of the element 'elem'.
 
-    Char_t tmp[256];
-
-    // create histogram projection for this element
-    sprintf(tmp, "ProjHisto_%i", elem);
-    TH2* h2 = (TH2*) fMainHisto;
+    // create histogram projection and fitting function for this element
     if (fFitHisto) delete fFitHisto;
-    fFitHisto = (TH1D*) h2->ProjectionX(tmp, elem+1, elem+1, "e");
+    fFitHisto = 0;
+    TH1* h = CreateFitHisto(elem);
+    TF1* func = CreateFitFunc(elem, h);
+
+    // fit and set results
+    Double_t pos = func ? FitElement(elem, h, func) : 0;
+    SetFitResult(elem, h, func, pos);
+
+    // skip drawing in batch mode
+    if (fBatchMode) return;
 
     // draw histogram
-    fFitHisto->SetFillColor(35);
     fCanvasFit->cd(2);
-    sprintf(tmp, "%s.Histo.Fit", GetName());
-    TCUtils::FormatHistogram(fFitHisto, tmp);
     fFitHisto->Draw("hist");
 
-    // check for sufficient statistics
-    if (fFitHisto->Integral() > 100 && !IsIgnored(elem))
+    // draw fitting function and indicator line
+    if (func)
     {
-        // delete old function
-        if (fFitFunc) delete fFitFunc;
-        sprintf(tmp, "fEnergy_%i", elem);
-        fFitFunc = new TF1(tmp, "gaus(0)+pol3(3)");
-        fFitFunc->SetLineColor(2);
-
-        // set peak position
-        if (fIsReFit)
-        {
-            fPi0Pos = fLine->GetPos();
-        }
-        else
-        {
-            // estimate peak position
-            fPi0Pos = fFitHisto->GetBinCenter(fFitHisto->GetMaximumBin());
-            if (fPi0Pos < 100 || fPi0Pos > 160) fPi0Pos = 135;
-        }
-
-        // configure fitting function
-        if (this->InheritsFrom("TCCalibCBEnergy"))
-        {
-            fFitFunc->SetRange(fPi0Pos - 50, fPi0Pos + 80);
-            fFitFunc->SetParameters(fFitHisto->GetMaximum(), fPi0Pos, 11, 1, 1, 1, 0.1);
-            fFitFunc->SetParLimits(1, 130, 140);
-            fFitFunc->SetParLimits(2, 7, 18);
-        }
-        else if (this->InheritsFrom("TCCalibTAPSEnergyLG"))
-        {
-            fFitFunc->SetRange(60, 200);
-            fFitFunc->SetParameters(fFitHisto->GetMaximum(), fPi0Pos, 10, 1, 1, 1, 0.1);
-            fFitFunc->SetParLimits(0, 1, fFitHisto->GetMaximum()*1.5);
-            fFitFunc->SetParLimits(1, 115, 140);
-            fFitFunc->SetParLimits(2, 5, 15);
-            fFitFunc->FixParameter(6, 0);
-        }
-
-        // set +/- 3% peak position limits
-        if (fIsReFit) fFitFunc->SetParLimits(1, (1. - 0.03)*fPi0Pos, (1. + 0.03)*fPi0Pos);
-
-        // fit
-        TCFitUtils::ReFit(fFitHisto, fFitFunc, "RBQ0", 10);
-
-        // final results
-        fPi0Pos = fFitFunc->GetParameter(1);
-
-        // check if mass is in normal range
-        if (!fIsReFit &&
-            (fPi0Pos < fFitHisto->GetXaxis()->GetXmin() || fPi0Pos > fFitHisto->GetXaxis()->GetXmax())) fPi0Pos = 135;
-
-        // set indicator line
-        fLine->SetPos(fPi0Pos);
-
-        // draw fitting function
-        if (fFitFunc) fFitFunc->Draw("same");
-
-        // draw indicator line
+        fFitFunc->Draw("same");
         fLine->Draw();
     }
 
@@ -199,6 +150,123 @@ void TCCalibEnergy::Fit(Int_t elem)
     }
 }
 
+//______________________________________________________________________________
+TF1* TCCalibEnergy::CreateFitFunc(Int_t elem, TH1* h)
+{
+    // Return the fitting function of the element 'elem' or 0 if the histogram
+    // 'h' of the element should not be fitted.
+
+    Char_t tmp[256];
+
+    // check for sufficient statistics
+    if (h->Integral() <= 100 || IsIgnored(elem)) return 0;
+
+    // the fit function
+    sprintf(tmp, "fEnergy_%i", elem);
+    TF1* func = new TF1(tmp, "gaus(0)+pol3(3)");
+    func->SetLineColor(2);
+
+    return func;
+}
+
+//______________________________________________________________________________
+Double_t TCCalibEnergy::FitElement(Int_t elem, TH1* h, TF1* func)
+{
+    // Fit the histogram 'h' of the element 'elem' using the function 'func'
+    // and return the fitted pi0 position. The fit starts from the parameters
+    // of the previous iteration if available. The parameters of the re-fits
+    // are randomized using a generator seeded with the element number.
+    // NOTE: may be called concurrently for different elements if not re-fitting.
+
+    Double_t pos;
+
+    // set peak position
+    if (fIsReFit)
+    {
+        pos = fLine->GetPos();
+    }
+    else
+    {
+        // estimate peak position
+        pos = h->GetBinCenter(h->GetMaximumBin());
+        if (pos < 100 || pos > 160) pos = 135;
+    }
+
+    // configure fitting function
+    if (this->InheritsFrom("TCCalibCBEnergy"))
+    {
+        func->SetRange(pos - 50, pos + 80);
+        func->SetParameters(h->GetMaximum(), pos, 11, 1, 1, 1, 0.1);
+        func->SetParLimits(1, 130, 140);
+        func->SetParLimits(2, 7, 18);
+    }
+    else if (this->InheritsFrom("TCCalibTAPSEnergyLG"))
+    {
+        func->SetRange(60, 200);
+        func->SetParameters(h->GetMaximum(), pos, 10, 1, 1, 1, 0.1);
+        func->SetParLimits(0, 1, h->GetMaximum()*1.5);
+        func->SetParLimits(1, 115, 140);
+        func->SetParLimits(2, 5, 15);
+        func->FixParameter(6, 0);
+    }
+
+    // set +/- 3% peak position limits
+    if (fIsReFit) func->SetParLimits(1, (1. - 0.03)*pos, (1. + 0.03)*pos);
+
+    // start from the parameters of the previous iteration
+    Bool_t seeded = !fIsReFit && SeedFitFunc(elem, func);
+
+    // seed the peak and the background with the estimated peak
+    Double_t estPos, estSigma, estAmp, bg0, bg1;
+    if (fPeakSeed && !fIsReFit &&
+        TCFitUtils::EstimatePeak(h, h->FindBin(pos - 40), h->FindBin(pos + 40),
+                                 &estPos, &estSigma, &estAmp, &bg0, &bg1) &&
+        estPos > 100 && estPos < 160)
+    {
+        // only update the position when starting from the previous iteration
+        TCFitUtils::SetParameterInLimits(func, 1, estPos);
+        if (!seeded)
+        {
+            TCFitUtils::SetParameterInLimits(func, 0, estAmp);
+            TCFitUtils::SetParameterInLimits(func, 2, estSigma);
+            TCFitUtils::SetParameterInLimits(func, 3, bg0);
+            TCFitUtils::SetParameterInLimits(func, 4, bg1);
+            TCFitUtils::SetParameterInLimits(func, 5, 0);
+            TCFitUtils::SetParameterInLimits(func, 6, 0);
+        }
+    }
+
+    // fit (stop when the best minimum is found again if seeded)
+    TRandom3 rnd(elem + 1);
+    TCFitUtils::ReFit(h, func, "RBQ0", 10, &rnd, fPeakSeed ? 1e-3 : 0, &fNFit[elem]);
+
+    // final results
+    pos = func->GetParameter(1);
+
+    // check if mass is in normal range
+    if (!fIsReFit &&
+        (pos < h->GetXaxis()->GetXmin() || pos > h->GetXaxis()->GetXmax())) pos = 135;
+
+    return pos;
+}
+
+//______________________________________________________________________________
+void TCCalibEnergy::SetFitResult(Int_t elem, TH1* h, TF1* func, Double_t pos)
+{
+    // Set the fitting objects of the element 'elem' and the indicator line
+    // to the fitted pi0 position 'pos'.
+
+    // set fitting objects
+    TCCalib::SetFitResult(elem, h, func, pos);
+
+    // set pi0 position and indicator line
+    if (func)
+    {
+        fPi0Pos = pos;
+        fLine->SetPos(fPi0Pos);
+    }
+}
+
 //______________________________________________________________________________
 void TCCalibEnergy::ReCalculateAll()
 {
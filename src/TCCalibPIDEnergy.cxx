@@ -103,6 +103,9 @@ void TCCalibPIDEnergy::Init()
     }
     else fHistoName = *TCReadConfig::GetReader()->GetConfig("PID.Energy.Histo.Fit.Name");
 
+    // sum up all element histograms in one pass over the files
+    fFileManager->PrefetchElements(fHistoName.Data(), 0, fNelem-1);
+
     // get MC histogram file
     TString fileMC;
     if (!TCReadConfig::GetReader()->GetConfig("PID.Energy.MC.File"))
@@ -129,8 +132,11 @@ void TCCalibPIDEnergy::Init()
     TCMySQLManager::GetManager()->ReadParameters("Data.PID.E1", fCalibration.Data(), fSet[0], fGain, fNelem);
 
     // draw main histogram
-    fCanvasFit->Divide(1, 2, 0.001, 0.001);
-    fCanvasFit->cd(1)->SetLogz();
+    if (!fBatchMode)
+    {
+        fCanvasFit->Divide(1, 2, 0.001, 0.001);
+        fCanvasFit->cd(1)->SetLogz();
+    }
 
     // open the MC file
     fMCFile = new TFile(fileMC.Data());
@@ -154,15 +160,18 @@ void TCCalibPIDEnergy::Init()
     }
 
     // draw main histogram
-    fCanvasFit->cd(1);
-    fMCHisto->Draw("colz");
+    if (!fBatchMode)
+    {
+        fCanvasFit->cd(1);
+        fMCHisto->Draw("colz");
+    }
 
     // user information
     Info("Init", "Fitting MC data");
 
     // perform fitting for the MC histogram
     FitSlices(fMCHisto);
-    fCanvasFit->Update();
+    if (!fBatchMode) fCanvasFit->Update();
     printf("MC proton peak positions: ");
     for (Int_t i = 0; i < fNpeak; i++) printf("%.2f  ", fPeakMC[i]);
     printf("\n");
@@ -291,7 +300,7 @@ void TCCalibPIDEnergy::FitSlices(TH2* h)
         }
 
         // plot projection fit
-        if (fDelay > 0)
+        if (fDelay > 0 && !fBatchMode)
         {
             fCanvasFit->cd(2);
             fFitHisto->GetXaxis()->SetRangeUser(peak*0.4, peak*1.6);
@@ -335,10 +344,13 @@ void TCCalibPIDEnergy::Fit(Int_t elem)
     delete h3;
 
     // draw main histogram
-    fCanvasFit->cd(1);
     TCUtils::FormatHistogram(fMainHisto, "PID.Energy.Histo.Fit");
-    fMainHisto->Draw("colz");
-    fCanvasFit->Update();
+    if (!fBatchMode)
+    {
+        fCanvasFit->cd(1);
+        fMainHisto->Draw("colz");
+        fCanvasFit->Update();
+    }
 
     // check for sufficient statistics
     if (fMainHisto->GetEntries())
@@ -366,11 +378,11 @@ void TCCalibPIDEnergy::Fit(Int_t elem)
                            1.1*TMath::MaxElement(fNpeak, fPeakMC));
         fLinPlot->Fit(fFitFunc, "RB0Q");
 
-        // plot linear plot
+        // plot linear plot (saved for every element)
         fCanvasResult->cd();
         fLinPlot->Draw("ap");
         fFitFunc->Draw("same");
-        fCanvasResult->Update();
+        if (!fBatchMode) fCanvasResult->Update();
 
     } // if: sufficient statistics
 }
@@ -35,6 +35,7 @@ TCCalibPed::TCCalibPed(const Char_t* name, const Char_t* title, const Char_t* da
     // init members
     fADC = 0;
     fFileManager = 0;
+    fReadElements = kFALSE;
     fMean = 0;
     fLine = 0;
 }
@@ -86,11 +87,28 @@ void TCCalibPed::Init()
     // sum up all files contained in this runset
     fFileManager = new TCFileManager(fData, fCalibration.Data(), fNset, fSet);
 
-    // get the main calibration histogram
-    if (fHistoName) fMainHisto = fFileManager->GetHistogram(fHistoName.Data());
-    if (!fMainHisto)
+    // read only the element rows in batch mode if element-sliced files are
+    // available, otherwise get the main calibration histogram
+    if (fHistoName != "" && fBatchMode && fFileManager->HasElementHistogram(fHistoName.Data()))
+    {
+        fReadElements = kTRUE;
+        Info("Init", "Reading the rows of '%s' from the element-sliced files", fHistoName.Data());
+    }
+    else if (fHistoName != "") fMainHisto = fFileManager->GetHistogram(fHistoName.Data());
+    if (!fMainHisto && !fReadElements)
     {
         Error("Init", "Main histogram does not exist!\n");
+
+        // sum up all ADC histograms in one pass over the files
+        TString* adc = new TString[fNelem];
+        const Char_t* names[fNelem];
+        for (Int_t i = 0; i < fNelem; i++)
+        {
+            adc[i] = TString::Format("ADC%d", fADC[i]);
+            names[i] = adc[i].Data();
+        }
+        fFileManager->Prefetch(fNelem, names);
+        delete [] adc;
     }
 
     // create the overview histogram
@@ -99,13 +117,16 @@ void TCCalibPed::Init()
     fOverviewHisto->SetMarkerColor(4);
 
     // draw main histogram
-    fCanvasFit->Divide(1, 2, 0.001, 0.001);
+    if (!fBatchMode) fCanvasFit->Divide(1, 2, 0.001, 0.001);
     if (fMainHisto)
     {
-       fCanvasFit->cd(1)->SetLogz();
        sprintf(tmp, "%s.Histo.Fit", GetName());
        TCUtils::FormatHistogram(fMainHisto, tmp);
-       fMainHisto->Draw("colz");
+       if (!fBatchMode)
+       {
+           fCanvasFit->cd(1)->SetLogz();
+           fMainHisto->Draw("colz");
+       }
     }
 
     // draw the overview histogram
@@ -130,8 +151,26 @@ void TCCalibPed::Fit(Int_t elem)
     {
         // create histogram projection for this element
         sprintf(tmp, "ProjHisto_%i", elem);
-        TH2* h2 = (TH2*) fMainHisto;
-        fFitHisto = (TH1D*) h2->ProjectionX(tmp, elem+1, elem+1, "e");
+        fFitHisto = GetElementHisto(elem, tmp);
+    }
+    else if (fReadElements)
+    {
+        // read the row of this element from the element-sliced files
+        fFitHisto = fFileManager->GetElementHistogram(fHistoName.Data(), elem);
+        if (fFitHisto)
+        {
+            sprintf(tmp, "ProjHisto_%i", elem);
+            fFitHisto->SetName(tmp);
+
+            // apply the x-axis range of the main histogram
+            sprintf(tmp, "%s.Histo.Fit.Xaxis.Range", GetName());
+            if (TString* r = TCReadConfig::GetReader()->GetConfig(tmp))
+            {
+                Double_t min, max;
+                sscanf(r->Data(), "%lf%lf", &min, &max);
+                fFitHisto->GetXaxis()->SetRangeUser(min, max);
+            }
+        }
     }
     else
     {
@@ -162,7 +201,7 @@ void TCCalibPed::Fit(Int_t elem)
         fFitFunc->SetLineColor(2);
 
         // check for main histogram
-        if (!fMainHisto) // old method using raw adc spectra
+        if (!fMainHisto && !fReadElements) // old method using raw adc spectra
         {
             if (!fIsReFit)
             {
@@ -217,6 +256,9 @@ void TCCalibPed::Fit(Int_t elem)
     // set indicator line
     fLine->SetPos(fMean);
 
+    // skip drawing in batch mode
+    if (fBatchMode) return;
+
     // draw histogram
     fFitHisto->SetFillColor(35);
     fCanvasFit->cd(2);
@@ -101,11 +101,14 @@ void TCCalibPhi::Init()
     fOverviewHisto->SetMarkerColor(4);
 
     // draw main histogram
-    fCanvasFit->Divide(1, 2, 0.001, 0.001);
-    fCanvasFit->cd(1)->SetLogz();
     sprintf(tmp, "%s.Histo.Fit", GetName());
     TCUtils::FormatHistogram(fMainHisto, tmp);
-    fMainHisto->Draw("colz");
+    if (!fBatchMode)
+    {
+        fCanvasFit->Divide(1, 2, 0.001, 0.001);
+        fCanvasFit->cd(1)->SetLogz();
+        fMainHisto->Draw("colz");
+    }
 
     // draw the overview histogram
     fCanvasResult->cd();
@@ -123,9 +126,8 @@ void TCCalibPhi::Fit(Int_t elem)
 
     // create histogram projection for this element
     sprintf(tmp, "ProjHisto_%i", elem);
-    TH2* h2 = (TH2*) fMainHisto;
     if (fFitHisto) delete fFitHisto;
-    fFitHisto = (TH1D*) h2->ProjectionX(tmp, elem+1, elem+1, "e");
+    fFitHisto = GetElementHisto(elem, tmp);
 
     // check for sufficient statistics
     if (fFitHisto->GetEntries())
@@ -185,9 +187,14 @@ void TCCalibPhi::Fit(Int_t elem)
 
     // draw histogram
     fFitHisto->SetFillColor(35);
-    fCanvasFit->cd(2);
     sprintf(tmp, "%s.Histo.Fit", GetName());
     TCUtils::FormatHistogram(fFitHisto, tmp);
+
+    // skip drawing in batch mode
+    if (fBatchMode) return;
+
+    // draw histogram
+    fCanvasFit->cd(2);
     fFitHisto->Draw("hist");
 
     // draw fitting function
@@ -300,7 +307,7 @@ void TCCalibPhi::Calculate(Int_t elem)
         PrintValues();
 
         // (re-)create second result canvas
-        fCanvasResult2 = new TCanvas("Fit Result", "Fit Result", 630, 0, 900, 400);
+        fCanvasResult2 = CreateCanvas("Fit Result", "Fit Result", 630, 0, 900, 400);
 
         // draw fitted histogram
         sprintf(tmp, "%s.Histo.Overview", GetName());
@@ -21,6 +21,7 @@
 #include "TCMySQLManager.h"
 #include "TCFileManager.h"
 #include "TCUtils.h"
+#include "TCHistoRows.h"
 
 ClassImp(TCCalibQuadEnergy)
 
@@ -38,6 +39,8 @@ TCCalibQuadEnergy::TCCalibQuadEnergy(const Char_t* name, const Char_t* title, co
     fPar1New = 0;
     fMainHisto2 = 0;
     fMainHisto3 = 0;
+    fMainRows2 = 0;
+    fMainRows3 = 0;
     fFitHisto1b = 0;
     fFitHisto2 = 0;
     fFitHisto3 = 0;
@@ -67,6 +70,8 @@ TCCalibQuadEnergy::~TCCalibQuadEnergy()
     if (fPar1New) delete [] fPar1New;
     if (fMainHisto2) delete fMainHisto2;
     if (fMainHisto3) delete fMainHisto3;
+    if (fMainRows2) delete fMainRows2;
+    if (fMainRows3) delete fMainRows3;
     if (fFitHisto1b) delete fFitHisto1b;
     if (fFitHisto2) delete fFitHisto2;
     if (fFitHisto3) delete fFitHisto3;
@@ -182,6 +187,7 @@ void TCCalibQuadEnergy::Init()
         Error("Init", "Pi0 mean energy histogram does not exist!\n");
         return;
     }
+    fMainRows2 = new TCHistoRows(fMainHisto2);
 
     // get the eta mean energy histogram
     fMainHisto3 = (TH2*) f.GetHistogram(hMeanEtaName.Data());
@@ -190,6 +196,7 @@ void TCCalibQuadEnergy::Init()
         Error("Init", "Eta mean energy histogram does not exist!\n");
         return;
     }
+    fMainRows3 = new TCHistoRows(fMainHisto3);
 
     // create the pi0 overview histogram
     fPi0PosHisto = new TH1F("Pi0 position overview", ";Element;#pi^{0} peak position [MeV]", fNelem, 0, fNelem);
@@ -209,7 +216,7 @@ void TCCalibQuadEnergy::Init()
     fEtaMeanEHisto = new TH1F("EtaMeanE", ";Element;Mean photon energy [MeV]", fNelem, 0, fNelem);
 
     // prepare fit histogram canvas
-    fCanvasFit->Divide(1, 4, 0.001, 0.001);
+    if (!fBatchMode) fCanvasFit->Divide(1, 4, 0.001, 0.001);
 
     // draw the overview histograms
     fCanvasResult->Divide(1, 2, 0.001, 0.001);
@@ -228,10 +235,9 @@ void TCCalibQuadEnergy::Fit(Int_t elem)
 
     // get the 2g invariant mass histograms
     sprintf(tmp, "ProjHisto_%d", elem);
-    TH2* h2 = (TH2*) fMainHisto;
     if (fFitHisto) delete fFitHisto;
     if (fFitHisto1b) delete fFitHisto1b;
-    fFitHisto = (TH1*) h2->ProjectionX(tmp, elem+1, elem+1, "e");
+    fFitHisto = GetElementHisto(elem, tmp);
     sprintf(tmp, "ProjHisto_%db", elem);
     fFitHisto1b = (TH1*) fFitHisto->Clone(tmp);
     sprintf(tmp, "%s.Histo.Fit.Pi0.IM", GetName());
@@ -241,39 +247,40 @@ void TCCalibQuadEnergy::Fit(Int_t elem)
 
     // get pi0 mean energy projection
     sprintf(tmp, "ProjHistoMeanPi0_%d", elem);
-    h2 = (TH2*) fMainHisto2;
     if (fFitHisto2) delete fFitHisto2;
-    fFitHisto2 = h2->ProjectionX(tmp, elem+1, elem+1, "e");
+    fFitHisto2 = fMainRows2->GetRowHisto(elem, tmp);
     sprintf(tmp, "%s.Histo.Fit.Pi0.MeanE", GetName());
     TCUtils::FormatHistogram(fFitHisto2, tmp);
 
     // get eta mean energy projection
     sprintf(tmp, "ProjHistoMeanEta_%d", elem);
-    h2 = (TH2*) fMainHisto3;
     if (fFitHisto3) delete fFitHisto3;
-    fFitHisto3 = h2->ProjectionX(tmp, elem+1, elem+1, "e");
+    fFitHisto3 = fMainRows3->GetRowHisto(elem, tmp);
     sprintf(tmp, "%s.Histo.Fit.Eta.MeanE", GetName());
     TCUtils::FormatHistogram(fFitHisto3, tmp);
 
-    // draw pi0
-    fCanvasFit->cd(1);
-    fFitHisto->SetFillColor(35);
-    fFitHisto->Draw("hist");
+    if (!fBatchMode)
+    {
+        // draw pi0
+        fCanvasFit->cd(1);
+        fFitHisto->SetFillColor(35);
+        fFitHisto->Draw("hist");
 
-    // draw eta
-    fCanvasFit->cd(2);
-    fFitHisto1b->SetFillColor(35);
-    fFitHisto1b->Draw("hist");
+        // draw eta
+        fCanvasFit->cd(2);
+        fFitHisto1b->SetFillColor(35);
+        fFitHisto1b->Draw("hist");
 
-    // draw pi0 mean energy
-    fCanvasFit->cd(3);
-    fFitHisto2->SetFillColor(35);
-    fFitHisto2->Draw("hist");
+        // draw pi0 mean energy
+        fCanvasFit->cd(3);
+        fFitHisto2->SetFillColor(35);
+        fFitHisto2->Draw("hist");
 
-    // draw eta mean energy
-    fCanvasFit->cd(4);
-    fFitHisto3->SetFillColor(35);
-    fFitHisto3->Draw("hist");
+        // draw eta mean energy
+        fCanvasFit->cd(4);
+        fFitHisto3->SetFillColor(35);
+        fFitHisto3->Draw("hist");
+    }
 
     // check for sufficient statistics
     if (fFitHisto->GetEntries() && !IsIgnored(elem))
@@ -361,25 +368,31 @@ void TCCalibQuadEnergy::Fit(Int_t elem)
         fLineMeanEPi0->SetPos(fPi0MeanE);
         fLineMeanEEta->SetPos(fEtaMeanE);
 
-        // draw pi0
-        fCanvasFit->cd(1);
-        if (fFitFunc) fFitFunc->Draw("same");
-        fLinePi0->Draw();
-
-        // draw eta
-        fCanvasFit->cd(2);
-        if (fFitFunc1b) fFitFunc1b->Draw("same");
-        fLineEta->Draw();
-
-        // draw pi0 mean energy
-        fCanvasFit->cd(3);
-        fLineMeanEPi0->Draw();
-
-        // draw eta mean energy
-        fCanvasFit->cd(4);
-        fLineMeanEEta->Draw();
+        if (!fBatchMode)
+        {
+            // draw pi0
+            fCanvasFit->cd(1);
+            if (fFitFunc) fFitFunc->Draw("same");
+            fLinePi0->Draw();
+
+            // draw eta
+            fCanvasFit->cd(2);
+            if (fFitFunc1b) fFitFunc1b->Draw("same");
+            fLineEta->Draw();
+
+            // draw pi0 mean energy
+            fCanvasFit->cd(3);
+            fLineMeanEPi0->Draw();
+
+            // draw eta mean energy
+            fCanvasFit->cd(4);
+            fLineMeanEEta->Draw();
+        }
     }
 
+    // skip drawing in batch mode
+    if (fBatchMode) return;
+
     // update canvas
     fCanvasFit->Update();
 
@@ -22,6 +22,7 @@
 #include "TROOT.h"
 #include "TH2.h"
 #include "TFile.h"
+#include "TTimer.h"
 #include "KeySymbols.h"
 
 #include "TCCalibRunBadScR.h"
@@ -62,6 +63,12 @@ void TCCalibRunBadScR::CleanUp()
 {
     // Clean up
 
+    if (fPrefetchTimer)
+    {
+        fPrefetchTimer->Stop();
+        delete fPrefetchTimer;
+        fPrefetchTimer = 0;
+    }
     if (fHistoLoader)
     {
         delete fHistoLoader;
@@ -109,6 +116,16 @@ void TCCalibRunBadScR::CleanUp()
         delete [] fScalerFreeHistos;
         fScalerFreeHistos = 0;
     }
+    if (fLastAccess)
+    {
+        delete [] fLastAccess;
+        fLastAccess = 0;
+    }
+    if (fLoadFailed)
+    {
+        delete [] fLoadFailed;
+        fLoadFailed = 0;
+    }
 
     if (fOverviewHisto)
     {
@@ -213,6 +230,21 @@ Bool_t TCCalibRunBadScR::SetConfig()
         fLoadHistosInAdvance = (Bool_t) TCReadConfig::GetReader()->GetConfigInt(tmp);
     }
 
+    // memory budget
+    sprintf(tmp, "BadScR.MemoryBudget");
+    if (TCReadConfig::GetReader()->GetConfig(tmp))
+    {
+        fMemBudget = TCReadConfig::GetReader()->GetConfigDouble(tmp);
+        Info("SetConfig", "Using a memory budget of %.0f MB for the histograms.", fMemBudget);
+    }
+
+    // number of runs to prefetch
+    sprintf(tmp, "BadScR.Prefetch");
+    if (TCReadConfig::GetReader()->GetConfig(tmp))
+    {
+        fNPrefetch = TCReadConfig::GetReader()->GetConfigInt(tmp);
+    }
+
     return kTRUE;
 }
 
@@ -240,8 +272,9 @@ Bool_t TCCalibRunBadScR::Init()
 
     // load & prepare histos ---------------------------------------------------
 
-    // init histo loader
+    // init histo loader (project without keeping the full histograms)
     fHistoLoader = new TCARHistoLoader(fNRuns, fRuns);
+    fHistoLoader->SetStreamingProjection(kTRUE);
 
     // user info
     Info("Init", "Loading files...");
@@ -296,7 +329,39 @@ Bool_t TCCalibRunBadScR::Init()
         Info("Init", "Loading main histograms...");
 
         // load main histograms (--> can eat up a lot of memory)
-        if (!(fMainHistos = (TH2**) fHistoLoader->CreateHistoArray(fMainHistoName)))
+        if (fMemBudget > 0)
+        {
+            // create and init main histo array
+            fMainHistos = new TH2*[fNRuns];
+            for (Int_t i = 0; i < fNRuns; i++)
+                fMainHistos[i] = 0;
+
+            // load main histograms until the memory budget is reached
+            Long64_t mem = 0;
+            Int_t nload = 0;
+            Int_t i = 0;
+            for (; i < fNRuns && mem < fMemBudget*1024*1024; i++)
+            {
+                if (!fHistoLoader->IsFileAvailable(i)) continue;
+                fMainHistos[i] = (TH2*) fHistoLoader->GetHistoForIndex(fMainHistoName, i);
+                if (!fMainHistos[i]) continue;
+                mem += GetHistoMemory(fMainHistos[i]);
+                nload++;
+            }
+
+            // check
+            if (!nload)
+            {
+                Error("Init", "Could not load any main histograms named '%s'!", fMainHistoName);
+                CleanUp();
+                return kFALSE;
+            }
+
+            // user info
+            if (i < fNRuns)
+                Info("Init", "Memory budget reached after %d runs, remaining main histograms will be loaded on demand.", i);
+        }
+        else if (!(fMainHistos = (TH2**) fHistoLoader->CreateHistoArray(fMainHistoName)))
         {
             Error("Init", "Could not load any main histograms named '%s'!", fMainHistoName);
             CleanUp();
@@ -318,7 +383,7 @@ Bool_t TCCalibRunBadScR::Init()
                 LoadScalerHistos(i);
 
                 // print progress
-                if (fHistoLoader->GetFiles()[i]) c++;
+                if (fHistoLoader->IsFileAvailable(i)) c++;
                 if (Double_t(c+1) / Double_t(fHistoLoader->GetNOpenFiles()) >= Double_t(per)/100.)
                 {
                     printf("Progress %d%%...\n", per);
@@ -339,10 +404,16 @@ Bool_t TCCalibRunBadScR::Init()
         return kFALSE;
     }
 
-    // create and init normalized projection array
+    // create and init normalized projection, last access and failure arrays
     fProjNormHistos = new TH1*[fNRuns];
+    fLastAccess = new Long64_t[fNRuns];
+    fLoadFailed = new Bool_t[fNRuns];
     for (Int_t i = 0; i < fNRuns; i++)
+    {
         fProjNormHistos[i] = 0;
+        fLastAccess[i] = 0;
+        fLoadFailed[i] = kFALSE;
+    }
 
     if (fScalerP2Histos || fScalerFreeHistos || fScalerLiveHistos)
     {
@@ -381,10 +452,10 @@ Bool_t TCCalibRunBadScR::Init()
         Int_t nscr = TCMySQLManager::GetManager()->GetRunNScR(fRuns[i]);
 
         // get number of scaler reads from event info histo
-        if (fHistoLoader->GetFiles()[i])
+        if (TFile* f = fHistoLoader->GetFile(i))
         {
             // get the event info histo for this run
-            TH1* h = (TH1*) fHistoLoader->GetFiles()[i]->Get("EventInfo");
+            TH1* h = (TH1*) f->Get("EventInfo");
 
             // check for same number of scaler reads
             if (h && nscr != h->GetBinContent(TCConfig::kNScREventHBin))
@@ -482,6 +553,16 @@ Bool_t TCCalibRunBadScR::Init()
         fBadScRCurr = 0;
     }
 
+    // apply memory budget
+    EnforceMemoryBudget();
+
+    // create prefetch timer (fires while the user inspects the current run)
+    if (fNPrefetch > 0)
+    {
+        fPrefetchTimer = new TTimer(50);
+        fPrefetchTimer->Connect("Timeout()", "TCCalibRunBadScR", this, "Prefetch()");
+    }
+
     // create last read marker
     fLastReadMarker = new TArrow();
     fLastReadMarker->SetOption("<|-|");
@@ -587,7 +668,7 @@ void TCCalibRunBadScR::LoadScalerHistos(Int_t i)
         (!fScalerLiveHistos || fScalerLiveHistos[i]) &&
         (!fScalerFreeHistos || fScalerLiveHistos[i])) return;
 
-    if (!fHistoLoader->GetFiles()[i]) return;
+    if (!fHistoLoader->IsFileAvailable(i)) return;
 
     // get the histo
     TH2* hsc = (TH2*) fHistoLoader->GetHistoForIndex(fScalerHistoName, i);
@@ -638,6 +719,7 @@ void TCCalibRunBadScR::LoadHistos(Int_t i)
     if (!fMainHistos[i])
     {
         Error("LoadHistos", "Could not load main histogram named '%s' for index %d!", fMainHistoName, i);
+        if (fLoadFailed) fLoadFailed[i] = kTRUE;
         return;
     }
 
@@ -652,6 +734,195 @@ void TCCalibRunBadScR::LoadHistos(Int_t i)
     NormalizeHisto(i);
 }
 
+//______________________________________________________________________________
+Long64_t TCCalibRunBadScR::GetHistoMemory(const TH1* h)
+{
+    // Returns the estimated memory of the bin contents and errors of the
+    // histogram 'h' in bytes.
+
+    // check
+    if (!h) return 0;
+
+    // get size of bin content
+    Int_t size = sizeof(Double_t);
+    if (h->InheritsFrom("TArrayF") || h->InheritsFrom("TArrayI")) size = sizeof(Float_t);
+    else if (h->InheritsFrom("TArrayS")) size = sizeof(Short_t);
+    else if (h->InheritsFrom("TArrayC")) size = sizeof(Char_t);
+
+    return (Long64_t) h->GetNcells() * size + (Long64_t) h->GetSumw2N() * sizeof(Double_t);
+}
+
+//______________________________________________________________________________
+Long64_t TCCalibRunBadScR::GetRunMemory(Int_t i, Bool_t all) const
+{
+    // Returns the estimated memory of the histograms of the run with index 'i'
+    // in bytes. If 'all' is kFALSE only the main histogram is considered.
+
+    // main histogram
+    Long64_t mem = fMainHistos ? GetHistoMemory(fMainHistos[i]) : 0;
+    if (!all) return mem;
+
+    // projections and scaler histograms
+    if (fProjHistos) mem += GetHistoMemory(fProjHistos[i]);
+    if (fProjNormHistos) mem += GetHistoMemory(fProjNormHistos[i]);
+    if (fScalerP2Histos) mem += GetHistoMemory(fScalerP2Histos[i]);
+    if (fScalerLiveHistos) mem += GetHistoMemory(fScalerLiveHistos[i]);
+    if (fScalerFreeHistos) mem += GetHistoMemory(fScalerFreeHistos[i]);
+
+    return mem;
+}
+
+//______________________________________________________________________________
+Long64_t TCCalibRunBadScR::GetMemory() const
+{
+    // Returns the estimated memory of the histograms of all runs in bytes.
+
+    Long64_t mem = 0;
+    for (Int_t i = 0; i < fNRuns; i++)
+        mem += GetRunMemory(i);
+
+    return mem;
+}
+
+//______________________________________________________________________________
+void TCCalibRunBadScR::EvictRun(Int_t i, Bool_t all)
+{
+    // Deletes the main histogram of the run with index 'i'. If 'all' is kTRUE
+    // the projections and scaler histograms are deleted too. Evicted histograms
+    // are reloaded by LoadHistos().
+
+    // main histogram
+    if (fMainHistos && fMainHistos[i])
+    {
+        delete fMainHistos[i];
+        fMainHistos[i] = 0;
+    }
+    if (!all) return;
+
+    // projections
+    if (fProjHistos && fProjHistos[i])
+    {
+        delete fProjHistos[i];
+        fProjHistos[i] = 0;
+    }
+    if (fProjNormHistos && fProjNormHistos[i])
+    {
+        delete fProjNormHistos[i];
+        fProjNormHistos[i] = 0;
+    }
+
+    // scaler histograms
+    if (fScalerP2Histos && fScalerP2Histos[i])
+    {
+        delete fScalerP2Histos[i];
+        fScalerP2Histos[i] = 0;
+    }
+    if (fScalerLiveHistos && fScalerLiveHistos[i])
+    {
+        delete fScalerLiveHistos[i];
+        fScalerLiveHistos[i] = 0;
+    }
+    if (fScalerFreeHistos && fScalerFreeHistos[i])
+    {
+        delete fScalerFreeHistos[i];
+        fScalerFreeHistos[i] = 0;
+    }
+}
+
+//______________________________________________________________________________
+void TCCalibRunBadScR::EnforceMemoryBudget()
+{
+    // Evicts histograms until their memory is within the memory budget. The
+    // main histograms are evicted first (the projections are usually enough),
+    // then all histograms of whole runs. The least recently used runs are
+    // evicted first, the current run is never evicted.
+
+    // check for budget
+    if (fMemBudget <= 0 || !fLastAccess) return;
+
+    // get budget and used memory
+    Long64_t budget = (Long64_t) (fMemBudget*1024*1024);
+    Long64_t mem = GetMemory();
+
+    // first main histograms, then whole runs
+    for (Int_t pass = 0; pass < 2 && mem > budget; pass++)
+    {
+        Bool_t all = pass ? kTRUE : kFALSE;
+
+        // evict least recently used runs
+        while (mem > budget)
+        {
+            // find least recently used run (the last one of equally used runs)
+            Int_t lru = -1;
+            for (Int_t i = 0; i < fNRuns; i++)
+            {
+                if (i == fIndex || !GetRunMemory(i, all)) continue;
+                if (lru < 0 || fLastAccess[i] <= fLastAccess[lru]) lru = i;
+            }
+
+            // check for run
+            if (lru < 0) break;
+
+            // evict run
+            mem -= GetRunMemory(lru, all);
+            EvictRun(lru, all);
+        }
+    }
+}
+
+//______________________________________________________________________________
+void TCCalibRunBadScR::Prefetch()
+{
+    // Loads the histograms of the next run following the current run that is
+    // not loaded yet. Called by the prefetch timer while the user inspects the
+    // current run, i.e., one run is loaded per timeout.
+
+    // loop over following runs
+    for (Int_t i = fIndex+1; i <= fIndex+fNPrefetch && i < fNRuns; i++)
+    {
+        // skip loaded, unavailable and failed runs
+        if (fMainHistos[i] || !fHistoLoader->IsFileAvailable(i)) continue;
+        if (fLoadFailed && fLoadFailed[i]) continue;
+
+        // stop if the run would not fit into the memory budget
+        if (fMemBudget > 0 &&
+            GetMemory() + GetRunMemory(fIndex) > (Long64_t) (fMemBudget*1024*1024)) break;
+
+        // load histos
+        LoadHistos(i);
+
+        // mark run as used
+        TouchRun(i);
+
+        return;
+    }
+
+    // nothing left to prefetch
+    fPrefetchTimer->Stop();
+}
+
+//______________________________________________________________________________
+void TCCalibRunBadScR::EvictOutsidePrefetch()
+{
+    // Deletes the prefetched main histograms of the runs outside the prefetch
+    // window following the current run. Only used if neither a memory budget
+    // is set nor the histograms are loaded in advance, as the main histograms
+    // are not kept in memory in this case.
+
+    // check mode
+    if (fLoadHistosInAdvance || fMemBudget > 0 || !fMainHistos) return;
+
+    // loop over runs
+    for (Int_t i = 0; i < fNRuns; i++)
+    {
+        // skip runs in the prefetch window
+        if (i >= fIndex && i <= fIndex+fNPrefetch) continue;
+
+        // delete main histogram
+        if (fMainHistos[i]) EvictRun(i, kFALSE);
+    }
+}
+
 //______________________________________________________________________________
 void TCCalibRunBadScR::PrepareCurr()
 {
@@ -666,6 +937,14 @@ void TCCalibRunBadScR::PrepareCurr()
     // load histos
     TCCalibRunBadScR::LoadHistos(fIndex);
 
+    // mark run as used and apply memory budget
+    TouchRun(fIndex);
+    EnforceMemoryBudget();
+    EvictOutsidePrefetch();
+
+    // start prefetching the following runs
+    if (fPrefetchTimer) fPrefetchTimer->Start();
+
     // check for valid run
     if (!IsGood())
     {
@@ -904,6 +1183,9 @@ void TCCalibRunBadScR::CleanUpCurr()
 {
     // Cleans everything up for the current run and updates overview histogram.
 
+    // stop prefetching
+    if (fPrefetchTimer) fPrefetchTimer->Stop();
+
     // delete old boxes
     if (fBadScRCurrBox)
     {
@@ -922,8 +1204,8 @@ void TCCalibRunBadScR::CleanUpCurr()
     // update overview histo
     UpdateOverviewHisto();
 
-    // clear main histo
-    if (!fLoadHistosInAdvance)
+    // clear main histo (kept by the memory budget otherwise)
+    if (!fLoadHistosInAdvance && fMemBudget <= 0)
     {
        if (fMainHistos[fIndex]) delete fMainHistos[fIndex];
        fMainHistos[fIndex] = 0;
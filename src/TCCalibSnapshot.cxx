@@ -0,0 +1,433 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCCalibSnapshot                                                      //
+//                                                                      //
+// Read-only binary snapshot of a calibration. The snapshot file is     //
+// memory-mapped and the parameters are accessed without copying and    //
+// without any database connection.                                     //
+//                                                                      //
+// File layout (native byte order):                                     //
+//   header     : magic, version, number of data, calibration name,     //
+//                offset of the directory                               //
+//   directory  : one entry per calibration data sorted by name         //
+//                (name, number of sets and parameters, offsets)        //
+//   per data   : first runs and last runs of the sets (Int_t),         //
+//                parameters of all sets as contiguous Double_t         //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "TError.h"
+#include "TMath.h"
+#include "TSystem.h"
+#include "THashList.h"
+
+#include "TCCalibSnapshot.h"
+#include "TCMySQLManager.h"
+#include "TCCalibData.h"
+#include "TCContainer.h"
+
+ClassImp(TCCalibSnapshot)
+
+// snapshot file format
+static const Char_t kSnapshotMagic[8] = { 'C', 'A', 'L', 'I', 'B', 'S', 'N', 'P' };
+static const Int_t kSnapshotVersion = 1;
+
+// file header
+struct TCSnapshotHeader
+{
+    Char_t fMagic[8];                       // file identifier
+    Int_t fVersion;                         // format version
+    Int_t fNData;                           // number of calibration data
+    Char_t fCalibration[256];               // calibration identifier
+    Long64_t fDirOffset;                    // offset of the directory
+};
+
+// directory entry of one calibration data
+struct TCSnapshotEntry
+{
+    Char_t fData[128];                      // calibration data name
+    Int_t fNSet;                            // number of sets
+    Int_t fNPar;                            // number of parameters per set
+    Long64_t fRunOffset;                    // offset of the first and last runs
+    Long64_t fParOffset;                    // offset of the parameters
+};
+
+//______________________________________________________________________________
+TCCalibSnapshot::TCCalibSnapshot(const Char_t* filename)
+{
+    // Constructor opening and mapping the snapshot file 'filename'.
+
+    // init members
+    strncpy(fFileName, filename, sizeof(fFileName)-1);
+    fFileName[sizeof(fFileName)-1] = '\0';
+    fMap = 0;
+    fMapSize = 0;
+    fNData = 0;
+    fDir = 0;
+
+    // open the file
+    Char_t* fn = gSystem->ExpandPathName(filename);
+    Int_t fd = open(fn, O_RDONLY);
+    delete [] fn;
+    if (fd < 0)
+    {
+        Error("TCCalibSnapshot", "Could not open the snapshot file '%s'!", filename);
+        return;
+    }
+
+    // get the file size
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size < (Long64_t)sizeof(TCSnapshotHeader))
+    {
+        Error("TCCalibSnapshot", "'%s' is not a valid snapshot file!", filename);
+        close(fd);
+        return;
+    }
+
+    // map the file (the mapping stays valid after closing the file)
+    void* map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        Error("TCCalibSnapshot", "Could not map the snapshot file '%s'!", filename);
+        return;
+    }
+    fMap = (const Char_t*) map;
+    fMapSize = st.st_size;
+
+    // check the header
+    const TCSnapshotHeader* h = (const TCSnapshotHeader*) fMap;
+    Bool_t valid = !memcmp(h->fMagic, kSnapshotMagic, 8) && h->fVersion == kSnapshotVersion &&
+                   h->fCalibration[sizeof(h->fCalibration)-1] == '\0' &&
+                   h->fNData >= 0 && h->fDirOffset >= (Long64_t)sizeof(TCSnapshotHeader) &&
+                   h->fDirOffset % sizeof(Long64_t) == 0 &&
+                   h->fDirOffset + h->fNData*(Long64_t)sizeof(TCSnapshotEntry) <= fMapSize;
+
+    // set and check the directory
+    if (valid)
+    {
+        fNData = h->fNData;
+        fDir = fMap + h->fDirOffset;
+        valid = CheckDirectory();
+    }
+
+    // unmap invalid files
+    if (!valid)
+    {
+        Error("TCCalibSnapshot", "'%s' is not a valid snapshot file!", filename);
+        munmap((void*)fMap, fMapSize);
+        fMap = 0;
+        fMapSize = 0;
+        fNData = 0;
+        fDir = 0;
+    }
+}
+
+//______________________________________________________________________________
+TCCalibSnapshot::~TCCalibSnapshot()
+{
+    // Destructor.
+
+    if (fMap) munmap((void*)fMap, fMapSize);
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibSnapshot::CheckDirectory() const
+{
+    // Check that the runs and parameters of all directory entries lie within
+    // the mapped file and that the entries are sorted by name. All accesses
+    // rely on this check done once when opening the file.
+    // Return kFALSE if the directory is corrupt, otherwise kTRUE.
+
+    const TCSnapshotEntry* dir = (const TCSnapshotEntry*) fDir;
+
+    // loop over entries
+    for (Int_t i = 0; i < fNData; i++)
+    {
+        const TCSnapshotEntry* e = dir + i;
+
+        // check name and sorting
+        if (e->fData[sizeof(e->fData)-1] != '\0') return kFALSE;
+        if (i && strcmp(dir[i-1].fData, e->fData) >= 0) return kFALSE;
+
+        // check dimensions
+        if (e->fNSet < 0 || e->fNPar < 0) return kFALSE;
+
+        // check the run ranges
+        if (e->fRunOffset < 0 || e->fRunOffset % sizeof(Int_t) ||
+            e->fRunOffset + 2*(Long64_t)e->fNSet*sizeof(Int_t) > fMapSize) return kFALSE;
+
+        // check the parameters
+        if (e->fParOffset < 0 || e->fParOffset % sizeof(Double_t) ||
+            e->fParOffset + (Long64_t)e->fNSet*e->fNPar*sizeof(Double_t) > fMapSize) return kFALSE;
+    }
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+const Char_t* TCCalibSnapshot::GetCalibration() const
+{
+    // Return the calibration identifier of the snapshot.
+
+    return fMap ? ((const TCSnapshotHeader*) fMap)->fCalibration : 0;
+}
+
+//______________________________________________________________________________
+const Char_t* TCCalibSnapshot::GetCalibData(Int_t i) const
+{
+    // Return the name of the 'i'-th calibration data of the snapshot.
+
+    if (i < 0 || i >= fNData) return 0;
+    return ((const TCSnapshotEntry*) fDir)[i].fData;
+}
+
+//______________________________________________________________________________
+Int_t TCCalibSnapshot::FindData(const Char_t* data) const
+{
+    // Return the index of the directory entry of the calibration data 'data'
+    // using a binary search over the sorted names.
+    // Return -1 if there is no such data.
+
+    const TCSnapshotEntry* dir = (const TCSnapshotEntry*) fDir;
+
+    // binary search
+    Int_t low = 0;
+    Int_t high = fNData - 1;
+    while (low <= high)
+    {
+        Int_t mid = (low + high) / 2;
+        Int_t cmp = strcmp(dir[mid].fData, data);
+        if (!cmp) return mid;
+        else if (cmp < 0) low = mid + 1;
+        else high = mid - 1;
+    }
+
+    return -1;
+}
+
+//______________________________________________________________________________
+Int_t TCCalibSnapshot::GetNsets(const Char_t* data) const
+{
+    // Return the number of sets of the calibration data 'data'.
+
+    Int_t i = FindData(data);
+    return i == -1 ? 0 : ((const TCSnapshotEntry*) fDir)[i].fNSet;
+}
+
+//______________________________________________________________________________
+Int_t TCCalibSnapshot::GetSetForRun(const Char_t* data, Int_t run) const
+{
+    // Return the number of the set of the calibration data 'data' the run
+    // 'run' belongs to using a binary search over the set intervals.
+    // Return -1 if there is no such set.
+
+    // get the data
+    Int_t i = FindData(data);
+    if (i == -1) return -1;
+    const TCSnapshotEntry* e = (const TCSnapshotEntry*) fDir + i;
+    if (!e->fNSet) return -1;
+
+    // get the run ranges
+    const Int_t* first = (const Int_t*) (fMap + e->fRunOffset);
+    const Int_t* last = first + e->fNSet;
+
+    // find the last set starting before or at the run
+    Long64_t set = TMath::BinarySearch((Long64_t)e->fNSet, first, run);
+
+    // check if run is in this set
+    if (set >= 0 && run <= last[set]) return (Int_t)set;
+    else return -1;
+}
+
+//______________________________________________________________________________
+const Double_t* TCCalibSnapshot::GetParameters(const Char_t* data, Int_t run,
+                                               Int_t* outLength) const
+{
+    // Return a pointer to the parameters of the calibration data 'data' valid
+    // for the run 'run'. The parameters are not copied and stay valid as long
+    // as this object exists. If 'outLength' is not zero the number of
+    // parameters is written to it.
+    // Return 0 if no parameters were found.
+
+    // get the set
+    Int_t set = GetSetForRun(data, run);
+    if (set == -1)
+    {
+        Error("GetParameters", "No set of '%s' found for run %d", data, run);
+        return 0;
+    }
+
+    // get the parameters
+    const TCSnapshotEntry* e = (const TCSnapshotEntry*) fDir + FindData(data);
+    if (outLength) *outLength = e->fNPar;
+    return (const Double_t*) (fMap + e->fParOffset) + (Long64_t)set*e->fNPar;
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibSnapshot::ReadParameters(const Char_t* data, Int_t run,
+                                       Double_t* par, Int_t length) const
+{
+    // Copy 'length' parameters of the calibration data 'data' valid for the
+    // run 'run' to the value array 'par'.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // get the parameters
+    Int_t n;
+    const Double_t* p = GetParameters(data, run, &n);
+    if (!p) return kFALSE;
+
+    // check the number of parameters
+    if (length > n)
+    {
+        Error("ReadParameters", "Only %d parameters of '%s' available!", n, data);
+        return kFALSE;
+    }
+
+    // copy the parameters
+    memcpy(par, p, length*sizeof(Double_t));
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCCalibSnapshot::Create(const Char_t* filename, const Char_t* calibration)
+{
+    // Write the snapshot file 'filename' containing all sets of all calibration
+    // data of the calibration 'calibration'.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // get the manager
+    TCMySQLManager* m = TCMySQLManager::GetManager();
+
+    // get the sorted data names
+    THashList* dataList = m->GetDataTable();
+    Int_t nData = dataList->GetSize();
+    TCCalibData* data[nData];
+    for (Int_t i = 0; i < nData; i++) data[i] = (TCCalibData*) dataList->At(i);
+    for (Int_t i = 1; i < nData; i++)
+    {
+        for (Int_t j = i; j > 0 && strcmp(data[j-1]->GetName(), data[j]->GetName()) > 0; j--)
+        {
+            TCCalibData* tmp = data[j];
+            data[j] = data[j-1];
+            data[j-1] = tmp;
+        }
+    }
+
+    // open a temporary output file (readers may have the snapshot mapped,
+    // so the snapshot is replaced only when complete)
+    Char_t* fn = gSystem->ExpandPathName(filename);
+    TString tmp = TString::Format("%s.%d.tmp", fn, gSystem->GetPid());
+    FILE* fout = fopen(tmp.Data(), "wb");
+    if (!fout)
+    {
+        Error("Create", "Could not open the snapshot file '%s'!", tmp.Data());
+        delete [] fn;
+        return kFALSE;
+    }
+
+    // write the header
+    TCSnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.fMagic, kSnapshotMagic, 8);
+    h.fVersion = kSnapshotVersion;
+    h.fNData = nData;
+    strncpy(h.fCalibration, calibration, sizeof(h.fCalibration)-1);
+    h.fDirOffset = sizeof(h);
+    Bool_t ok = fwrite(&h, sizeof(h), 1, fout) == 1;
+
+    // reserve the directory
+    TCSnapshotEntry dir[nData];
+    memset(dir, 0, sizeof(dir));
+    if (nData) ok = ok && fwrite(dir, sizeof(TCSnapshotEntry), nData, fout) == (size_t)nData;
+    Long64_t offset = h.fDirOffset + nData*sizeof(TCSnapshotEntry);
+
+    // loop over calibration data
+    for (Int_t i = 0; ok && i < nData; i++)
+    {
+        // check for sets of the data (tables without sets are skipped silently)
+        Bool_t silence = m->GetSilenceMode();
+        m->SetSilenceMode(kTRUE);
+        Bool_t hasSets = m->GetNsets(data[i]->GetName(), calibration) > 0;
+        m->SetSilenceMode(silence);
+
+        // read all sets of the data
+        TCContainer c("snapshot");
+        Int_t nSet = hasSets ? m->DumpCalibrations(&c, calibration, data[i]->GetName()) : 0;
+        Int_t nPar = data[i]->GetSize();
+
+        // fill the directory entry
+        strncpy(dir[i].fData, data[i]->GetName(), sizeof(dir[i].fData)-1);
+        dir[i].fNSet = nSet;
+        dir[i].fNPar = nPar;
+        dir[i].fRunOffset = offset;
+
+        // write the first and last runs
+        for (Int_t j = 0; ok && j < nSet; j++)
+        {
+            Int_t r = c.GetCalibration(j)->GetFirstRun();
+            ok = fwrite(&r, sizeof(Int_t), 1, fout) == 1;
+        }
+        for (Int_t j = 0; ok && j < nSet; j++)
+        {
+            Int_t r = c.GetCalibration(j)->GetLastRun();
+            ok = fwrite(&r, sizeof(Int_t), 1, fout) == 1;
+        }
+        offset += 2*nSet*sizeof(Int_t);
+
+        // align the parameters to 8 bytes
+        Char_t pad[8] = { 0 };
+        Int_t nPad = (8 - offset % 8) % 8;
+        if (nPad) ok = ok && fwrite(pad, 1, nPad, fout) == (size_t)nPad;
+        offset += nPad;
+
+        // write the parameters
+        dir[i].fParOffset = offset;
+        for (Int_t j = 0; ok && j < nSet; j++)
+        {
+            TCCalibration* cal = c.GetCalibration(j);
+            Double_t par[nPar];
+            for (Int_t k = 0; k < nPar; k++) par[k] = k < cal->GetNParameters() ? cal->GetParameters()[k] : 0;
+            ok = fwrite(par, sizeof(Double_t), nPar, fout) == (size_t)nPar;
+        }
+        offset += (Long64_t)nSet*nPar*sizeof(Double_t);
+    }
+
+    // write the directory
+    if (ok && nData)
+    {
+        ok = !fseek(fout, h.fDirOffset, SEEK_SET) &&
+             fwrite(dir, sizeof(TCSnapshotEntry), nData, fout) == (size_t)nData;
+    }
+
+    // close the file
+    if (fclose(fout)) ok = kFALSE;
+
+    // replace the snapshot file
+    if (ok) ok = !gSystem->Rename(tmp.Data(), fn);
+    delete [] fn;
+
+    // check result
+    if (!ok)
+    {
+        Error("Create", "Could not write the snapshot file '%s'!", filename);
+        gSystem->Unlink(tmp.Data());
+        return kFALSE;
+    }
+
+    Info("Create", "Wrote the snapshot of the calibration '%s' to '%s'", calibration, filename);
+
+    return kTRUE;
+}
+
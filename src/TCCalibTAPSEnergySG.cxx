@@ -123,8 +123,11 @@ void TCCalibTAPSEnergySG::Init()
     fPhiHisto2->SetMarkerColor(4);
 
     // draw main histogram
-    fCanvasFit->Divide(1, 3, 0.001, 0.001);
-    fCanvasFit->cd(1)->SetLogz();
+    if (!fBatchMode)
+    {
+        fCanvasFit->Divide(1, 3, 0.001, 0.001);
+        fCanvasFit->cd(1)->SetLogz();
+    }
 
     // draw the overview histogram
     fCanvasResult->Divide(1, 2, 0.001, 0.001);
@@ -177,10 +180,13 @@ void TCCalibTAPSEnergySG::Fit(Int_t elem)
     }
 
     // draw main histogram
-    fCanvasFit->cd(1);
     TCUtils::FormatHistogram(fMainHisto, "TAPS.Energy.SG.Histo.Fit");
-    fMainHisto->Draw("colz");
-    fCanvasFit->Update();
+    if (!fBatchMode)
+    {
+        fCanvasFit->cd(1);
+        fMainHisto->Draw("colz");
+        fCanvasFit->Update();
+    }
 
     // check for sufficient statistics
     if (fMainHisto->GetEntries())
@@ -296,36 +302,42 @@ void TCCalibTAPSEnergySG::Fit(Int_t elem)
         fLine2->SetX1(fPhi2);
         fLine2->SetX2(fPhi2);
 
-        // set log axis
-        fCanvasFit->cd(1)->SetLogz();
+        if (!fBatchMode)
+        {
+            // set log axis
+            fCanvasFit->cd(1)->SetLogz();
 
-        // draw histogram
-        fFitHisto->SetFillColor(35);
-        fCanvasFit->cd(2);
-        fFitHisto->Draw("hist");
+            // draw histogram
+            fFitHisto->SetFillColor(35);
+            fCanvasFit->cd(2);
+            fFitHisto->Draw("hist");
 
-        // draw fitting function
-        if (fFitFunc) fFitFunc->Draw("same");
+            // draw fitting function
+            if (fFitFunc) fFitFunc->Draw("same");
 
-        // draw indicator line
-        fLine1->Draw();
+            // draw indicator line
+            fLine1->Draw();
 
-        // draw histogram
-        fFitHisto2->SetFillColor(35);
-        fCanvasFit->cd(3);
-        fFitHisto2->Draw("hist");
+            // draw histogram
+            fFitHisto2->SetFillColor(35);
+            fCanvasFit->cd(3);
+            fFitHisto2->Draw("hist");
 
-        // draw fitting function
-        if (fFitFunc2) fFitFunc2->Draw("same");
+            // draw fitting function
+            if (fFitFunc2) fFitFunc2->Draw("same");
 
-        // draw indicator line
-        fLine2->Draw();
+            // draw indicator line
+            fLine2->Draw();
+        }
     }
-    else
+    else if (!fBatchMode)
     {
         fCanvasFit->cd(1)->SetLogz(kFALSE);
     }
 
+    // skip drawing in batch mode
+    if (fBatchMode) return;
+
     // update canvas
     fCanvasFit->Update();
 
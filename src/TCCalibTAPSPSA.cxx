@@ -105,11 +105,14 @@ void TCCalibTAPSPSA::Init()
     }
     else fHistoName = *TCReadConfig::GetReader()->GetConfig("TAPS.PSA.Histo.Fit.Name");
 
+    // sum up all element histograms in one pass over the files
+    fFileManager->PrefetchElements(fHistoName.Data(), 0, fNelem-1);
+
     // get projection fit display delay
     fDelay = TCReadConfig::GetReader()->GetConfigInt("TAPS.PSA.Fit.Delay");
 
     // draw main histogram
-    fCanvasFit->SetLogz();
+    if (!fBatchMode) fCanvasFit->SetLogz();
 }
 
 //______________________________________________________________________________
@@ -146,10 +149,13 @@ void TCCalibTAPSPSA::Fit(Int_t elem)
     }
 
     // draw main histogram
-    fCanvasFit->cd();
     TCUtils::FormatHistogram(fMainHisto, "TAPS.PSA.Histo.Fit");
-    fMainHisto->Draw("colz");
-    fCanvasFit->Update();
+    if (!fBatchMode)
+    {
+        fCanvasFit->cd();
+        fMainHisto->Draw("colz");
+        fCanvasFit->Update();
+    }
 
     // reset points
     fNpoints = 0;
@@ -267,7 +273,7 @@ void TCCalibTAPSPSA::Fit(Int_t elem)
                 fNpoints++;
 
                 // plot projection fit
-                if (fDelay > 0)
+                if (fDelay > 0 && !fBatchMode)
                 {
                     fCanvasResult->cd();
                     fAngleProj->Draw("hist");
@@ -308,22 +314,25 @@ void TCCalibTAPSPSA::Fit(Int_t elem)
             fLSigma->SetPoint(i, fMean[i] - 3*fSigma[i], fRadiusSigma[i]);
         }
 
-        // draw lines
-        fCanvasFit->cd();
-        fLMean->Draw();
-        fLSigma->Draw();
+        if (!fBatchMode)
+        {
+            // draw lines
+            fCanvasFit->cd();
+            fLMean->Draw();
+            fLSigma->Draw();
 
-        // set log axis
-        fCanvasFit->cd()->SetLogz();
+            // set log axis
+            fCanvasFit->cd()->SetLogz();
+        }
     }
-    else
+    else if (!fBatchMode)
     {
         fCanvasFit->cd()->SetLogz(kFALSE);
     }
 
     // update canvas
     fMainHisto->GetXaxis()->SetRangeUser(38, 50);
-    fCanvasFit->Update();
+    if (!fBatchMode) fCanvasFit->Update();
 }
 
 //______________________________________________________________________________
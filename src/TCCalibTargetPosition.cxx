@@ -89,10 +89,13 @@ void TCCalibTargetPosition::Init()
     fOverviewHisto->SetMarkerColor(4);
 
     // draw main histogram
-    fCanvasFit->Divide(1, 2, 0.001, 0.001);
-    fCanvasFit->cd(1)->SetLogz();
     TCUtils::FormatHistogram(fMainHisto, "Target.Position.Histo.Fit");
-    fMainHisto->Draw("colz");
+    if (!fBatchMode)
+    {
+        fCanvasFit->Divide(1, 2, 0.001, 0.001);
+        fCanvasFit->cd(1)->SetLogz();
+        fMainHisto->Draw("colz");
+    }
 
     // draw the overview histogram
     fCanvasResult->cd();
@@ -155,8 +158,12 @@ void TCCalibTargetPosition::Fit(Int_t elem)
 
     // draw histogram
     fFitHisto->SetFillColor(35);
-    fCanvasFit->cd(2);
     TCUtils::FormatHistogram(fFitHisto, "Target.Position.Histo.Fit");
+
+    // skip drawing in batch mode
+    if (fBatchMode) return;
+
+    fCanvasFit->cd(2);
     fFitHisto->Draw("hist");
 
     // draw fitting function
@@ -212,7 +219,7 @@ void TCCalibTargetPosition::Calculate(Int_t elem)
         // update overview plot
         fCanvasResult->cd();
         fOverviewHisto->Draw("E1");
-        fCanvasResult->Update();
+        if (!fBatchMode) fCanvasResult->Update();
 
         // fit plot
         if (fFitFunc) delete fFitFunc;
@@ -245,7 +252,7 @@ void TCCalibTargetPosition::Calculate(Int_t elem)
 
         // update canvas
         fFitFunc->Draw("same");
-        fCanvasResult->Update();
+        if (!fBatchMode) fCanvasResult->Update();
 
         // save value
         fNewVal[0] = targetPos;
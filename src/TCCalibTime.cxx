@@ -20,6 +20,7 @@
 #include "TCMySQLManager.h"
 #include "TCFileManager.h"
 #include "TCUtils.h"
+#include "TCFitUtils.h"
 
 ClassImp(TCCalibTime)
 
@@ -118,11 +119,14 @@ void TCCalibTime::Init()
     fOverviewHisto->SetMarkerColor(4);
 
     // draw main histogram
-    fCanvasFit->Divide(1, 2, 0.001, 0.001);
-    fCanvasFit->cd(1)->SetLogz();
     sprintf(tmp, "%s.Histo.Fit", GetName());
     TCUtils::FormatHistogram(fMainHisto, tmp);
-    fMainHisto->Draw("colz");
+    if (!fBatchMode)
+    {
+        fCanvasFit->Divide(1, 2, 0.001, 0.001);
+        fCanvasFit->cd(1)->SetLogz();
+        fMainHisto->Draw("colz");
+    }
 
     // draw the overview histogram
     fCanvasResult->cd();
@@ -136,112 +140,27 @@ void TCCalibTime::Fit(Int_t elem)
 {
     // Perform the fit of the element 'elem'.
 
-    Char_t tmp[256];
-
-    // create histogram projection for this element
-    sprintf(tmp, "ProjHisto_%i", elem);
-    TH2* h2 = (TH2*) fMainHisto;
+    // create histogram projection and fitting function for this element
     if (fFitHisto) delete fFitHisto;
-    fFitHisto = (TH1D*) h2->ProjectionX(tmp, elem+1, elem+1, "e");
+    fFitHisto = 0;
+    TH1* h = CreateFitHisto(elem);
+    TF1* func = CreateFitFunc(elem, h);
 
-    // init variables
-    Double_t factor = 2.5;
-    Double_t range = 3.8;
+    // fit and set results
+    Double_t pos = func ? FitElement(elem, h, func) : 0;
+    SetFitResult(elem, h, func, pos);
+
+    // skip drawing in batch mode
+    if (fBatchMode) return;
 
     // draw histogram
-    fFitHisto->SetFillColor(35);
     fCanvasFit->cd(2);
-    sprintf(tmp, "%s.Histo.Fit", GetName());
-    TCUtils::FormatHistogram(fFitHisto, tmp);
     fFitHisto->Draw("hist");
 
-    // check for sufficient statistics
-    if (fFitHisto->GetEntries() && !IsIgnored(elem))
+    // draw fitting function and indicator line
+    if (func)
     {
-        // delete old function
-        if (fFitFunc) delete fFitFunc;
-        sprintf(tmp, "fTime_%i", elem);
-
-        // the fit function
-        fFitFunc = new TF1("fFitFunc", "pol1(0)+gaus(2)");
-        fFitFunc->SetLineColor(2);
-
-        // get important parameter positions
-        fFitHisto->GetXaxis()->SetRange(2, fFitHisto->GetNbinsX()-1);
-        Double_t fMean = fFitHisto->GetXaxis()->GetBinCenter(fFitHisto->GetMaximumBin());
-        Double_t max = fFitHisto->GetBinContent(fFitHisto->GetMaximumBin());
-
-        // configure fitting function
-        fFitFunc->SetParameters(1, 0.1, max, fMean, 8);
-        fFitFunc->SetParLimits(2, 0.1, max*10);
-        fFitFunc->SetParLimits(3, fMean - 2, fMean + 2);
-        fFitFunc->SetParLimits(4, 0, 20);
-
-        // special configuration for certain classes
-         if (!this->InheritsFrom("TCCalibTaggerTime") &&
-             !this->InheritsFrom("TCCalibTAPSTime")   &&
-             !this->InheritsFrom("TCCalibVetoTime")   &&
-             !this->InheritsFrom("TCCalibCBRiseTime"))
-        {
-            // only gaussian
-            fFitFunc->FixParameter(0, 0);
-            fFitFunc->FixParameter(1, 0);
-        }
-        if (this->InheritsFrom("TCCalibTAPSTime"))
-        {
-            fFitFunc->SetParameter(4, 0.5);
-            fFitFunc->SetParLimits(4, 0.001, 1);
-            range = 3;
-            factor = 1.5;
-        }
-        if (this->InheritsFrom("TCCalibPIDTime"))
-        {
-            factor = 1.5;
-        }
-        if (this->InheritsFrom("TCCalibPizzaTime"))
-        {
-            factor = 1.5;
-        }
-        if (this->InheritsFrom("TCCalibCBRiseTime"))
-        {
-            factor = 10;
-        }
-        if (this->InheritsFrom("TCCalibTaggerTime"))
-        {
-            range = 5;
-            factor = 10;
-            fFitFunc->SetParLimits(4, 0.01, 2);
-        }
-
-        // check for refit
-        if (fIsReFit)
-        {
-            fMean = fLine->GetPos();
-        }
-        else
-        {
-            // first iteration
-            fFitFunc->SetRange(fMean - range, fMean + range);
-            fFitHisto->Fit(fFitFunc, "RBQ0");
-            fMean = fFitFunc->GetParameter(3);
-        }
-
-        // second iteration
-        Double_t sigma = fFitFunc->GetParameter(4);
-        fFitFunc->SetRange(fMean -factor*sigma, fMean +factor*sigma);
-        for (Int_t i = 0; i < 10; i++)
-            if(!fFitHisto->Fit(fFitFunc, "RBQ0")) break;
-
-        // final results
-        fMean = fFitFunc->GetParameter(3);
-
-        // draw mean indicator line
-        fLine->SetPos(fMean);
-
-        // draw fitting function
-        if (fFitFunc) fFitFunc->Draw("same");
-
-        // draw indicator line
+        fFitFunc->Draw("same");
         fLine->Draw();
     }
 
@@ -257,6 +176,141 @@ void TCCalibTime::Fit(Int_t elem)
     }
 }
 
+//______________________________________________________________________________
+TF1* TCCalibTime::CreateFitFunc(Int_t elem, TH1* h)
+{
+    // Return the fitting function of the element 'elem' or 0 if the histogram
+    // 'h' of the element should not be fitted.
+
+    // check for sufficient statistics
+    if (!h->GetEntries() || IsIgnored(elem)) return 0;
+
+    // the fit function
+    TF1* func = new TF1("fFitFunc", "pol1(0)+gaus(2)");
+    func->SetLineColor(2);
+
+    return func;
+}
+
+//______________________________________________________________________________
+Double_t TCCalibTime::FitElement(Int_t elem, TH1* h, TF1* func)
+{
+    // Fit the histogram 'h' of the element 'elem' using the function 'func'
+    // and return the fitted mean time position. The fit starts from the
+    // parameters of the previous iteration if available.
+    // NOTE: may be called concurrently for different elements if not re-fitting.
+
+    // init variables
+    Double_t factor = 2.5;
+    Double_t range = 3.8;
+
+    // get important parameter positions
+    h->GetXaxis()->SetRange(2, h->GetNbinsX()-1);
+    Double_t mean = h->GetXaxis()->GetBinCenter(h->GetMaximumBin());
+    Double_t max = h->GetBinContent(h->GetMaximumBin());
+
+    // estimate the peak
+    Double_t estSigma = 0;
+    Bool_t est = fPeakSeed && !fIsReFit &&
+                 TCFitUtils::EstimatePeak(h, 2, h->GetNbinsX()-1, &mean, &estSigma, &max);
+
+    // configure fitting function
+    func->SetParameters(1, 0.1, max, mean, 8);
+    func->SetParLimits(2, 0.1, max*10);
+    func->SetParLimits(3, mean - 2, mean + 2);
+    func->SetParLimits(4, 0, 20);
+
+    // special configuration for certain classes
+     if (!this->InheritsFrom("TCCalibTaggerTime") &&
+         !this->InheritsFrom("TCCalibTAPSTime")   &&
+         !this->InheritsFrom("TCCalibVetoTime")   &&
+         !this->InheritsFrom("TCCalibCBRiseTime"))
+    {
+        // only gaussian
+        func->FixParameter(0, 0);
+        func->FixParameter(1, 0);
+    }
+    if (this->InheritsFrom("TCCalibTAPSTime"))
+    {
+        func->SetParameter(4, 0.5);
+        func->SetParLimits(4, 0.001, 1);
+        range = 3;
+        factor = 1.5;
+    }
+    if (this->InheritsFrom("TCCalibPIDTime"))
+    {
+        factor = 1.5;
+    }
+    if (this->InheritsFrom("TCCalibPizzaTime"))
+    {
+        factor = 1.5;
+    }
+    if (this->InheritsFrom("TCCalibCBRiseTime"))
+    {
+        factor = 10;
+    }
+    if (this->InheritsFrom("TCCalibTaggerTime"))
+    {
+        range = 5;
+        factor = 10;
+        func->SetParLimits(4, 0.01, 2);
+    }
+
+    // check for refit
+    Int_t nFit = 0;
+    if (fIsReFit)
+    {
+        mean = fLine->GetPos();
+    }
+    else if (SeedFitFunc(elem, func))
+    {
+        // start from the previous iteration at the current peak position
+        if (est) TCFitUtils::SetParameterInLimits(func, 3, mean);
+        mean = func->GetParameter(3);
+    }
+    else if (est)
+    {
+        // use the estimated width instead of a first iteration
+        TCFitUtils::SetParameterInLimits(func, 4, estSigma);
+    }
+    else
+    {
+        // first iteration
+        func->SetRange(mean - range, mean + range);
+        h->Fit(func, "RBQ0");
+        nFit++;
+        mean = func->GetParameter(3);
+    }
+
+    // second iteration
+    Double_t sigma = func->GetParameter(4);
+    func->SetRange(mean -factor*sigma, mean +factor*sigma);
+    for (Int_t i = 0; i < 10; i++)
+    {
+        nFit++;
+        if(!h->Fit(func, "RBQ0")) break;
+    }
+
+    // save number of fits
+    fNFit[elem] = nFit;
+
+    // final results
+    return func->GetParameter(3);
+}
+
+//______________________________________________________________________________
+void TCCalibTime::SetFitResult(Int_t elem, TH1* h, TF1* func, Double_t pos)
+{
+    // Set the fitting objects of the element 'elem' and the indicator line
+    // to the fitted mean time position 'pos'.
+
+    // set fitting objects
+    TCCalib::SetFitResult(elem, h, func, pos);
+
+    // set mean indicator line
+    if (func) fLine->SetPos(pos);
+}
+
 //______________________________________________________________________________
 void TCCalibTime::Calculate(Int_t elem)
 {
@@ -74,10 +74,13 @@ void TCCalibVetoCorr::Init()
     }
 
     // draw main histogram
-    fCanvasFit->Divide(1, 2, 0.001, 0.001);
-    fCanvasFit->cd(1)->SetLogz();
     TCUtils::FormatHistogram(fMainHisto, "Veto.Correlation.Histo.Fit");
-    fMainHisto->Draw("colz");
+    if (!fBatchMode)
+    {
+        fCanvasFit->Divide(1, 2, 0.001, 0.001);
+        fCanvasFit->cd(1)->SetLogz();
+        fMainHisto->Draw("colz");
+    }
 }
 
 //______________________________________________________________________________
@@ -109,8 +112,12 @@ void TCCalibVetoCorr::Fit(Int_t elem)
 
     // draw histogram
     fFitHisto->SetFillColor(35);
-    fCanvasFit->cd(2);
     TCUtils::FormatHistogram(fFitHisto, "Veto.Correlation.Histo.Fit");
+
+    // skip drawing in batch mode
+    if (fBatchMode) return;
+
+    fCanvasFit->cd(2);
     fFitHisto->Draw("hist");
 
     // update canvas
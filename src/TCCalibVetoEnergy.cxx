@@ -110,8 +110,11 @@ void TCCalibVetoEnergy::Init()
     fOverviewHisto->SetMarkerColor(4);
 
     // draw main histogram
-    fCanvasFit->Divide(1, 2, 0.001, 0.001);
-    fCanvasFit->cd(1)->SetLogz();
+    if (!fBatchMode)
+    {
+        fCanvasFit->Divide(1, 2, 0.001, 0.001);
+        fCanvasFit->cd(1)->SetLogz();
+    }
 
     // open the MC file
     fMCFile = new TFile(fileMC.Data());
@@ -135,8 +138,11 @@ void TCCalibVetoEnergy::Init()
     }
 
     // draw main histogram
-    fCanvasFit->cd(1);
-    fMCHisto->Draw("colz");
+    if (!fBatchMode)
+    {
+        fCanvasFit->cd(1);
+        fMCHisto->Draw("colz");
+    }
 
     // draw the overview histogram
     fCanvasResult->cd();
@@ -148,8 +154,11 @@ void TCCalibVetoEnergy::Init()
 
     // perform fitting for the MC histogram
     FitSlice(fMCHisto, -1);
-    fCanvasFit->Update();
-    gSystem->Sleep(1000);
+    if (!fBatchMode)
+    {
+        fCanvasFit->Update();
+        gSystem->Sleep(1000);
+    }
 
     // user information
     Info("Init", "Fitting of MC data finished");
@@ -219,6 +228,9 @@ void TCCalibVetoEnergy::FitSlice(TH2* h, Int_t elem)
     // save peak position
     if (h == fMCHisto) fPeakMC = fPeak;
 
+    // skip drawing in batch mode
+    if (fBatchMode) return;
+
     fCanvasFit->cd(2);
     fFitHisto->GetXaxis()->SetRangeUser(fPeak*0.4, fPeak*1.6);
     fFitHisto->Draw("hist");
@@ -249,10 +261,13 @@ void TCCalibVetoEnergy::Fit(Int_t elem)
     }
 
     // draw main histogram
-    fCanvasFit->cd(1);
     TCUtils::FormatHistogram(fMainHisto, "Veto.Energy.Histo.Fit");
-    fMainHisto->Draw("colz");
-    fCanvasFit->Update();
+    if (!fBatchMode)
+    {
+        fCanvasFit->cd(1);
+        fMainHisto->Draw("colz");
+        fCanvasFit->Update();
+    }
 
     // check for sufficient statistics
     if (fMainHisto->GetEntries())
@@ -261,7 +276,7 @@ void TCCalibVetoEnergy::Fit(Int_t elem)
         FitSlice((TH2*)fMainHisto, elem);
 
         // update overview
-        if (elem % 20 == 0)
+        if (elem % 20 == 0 && !fBatchMode)
         {
             fCanvasResult->cd();
             fOverviewHisto->Draw("E1");
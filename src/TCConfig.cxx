@@ -27,6 +27,9 @@ namespace TCConfig
     // name of the main table
     const Char_t* kCalibMainTableName = "run_main";
 
+    // name of the synchronization table of replicas
+    const Char_t* kCalibSyncTableName = "calib_sync";
+
     // format of the main table
     const Char_t* kCalibMainTableFormat =
                     "run INT NOT NULL,"
@@ -57,6 +60,14 @@ namespace TCConfig
     // additional settings for the data tables
     const Char_t* kCalibDataTableSettings = ",PRIMARY KEY (calibration, first_run) ";
 
+    // default number of rows per bulk insert and maximum length of a
+    // bulk insert statement
+    const Int_t kBulkInsertSize = 500;
+    const Int_t kBulkInsertMaxLength = 500000;
+
+    // number of sets read per query when dumping calibrations
+    const Int_t kDumpChunkSize = 1000;
+
     // version numbers
     const Char_t kCaLibVersion[] = "0.3.0beta";
     const Int_t kContainerFormatVersion = 4;
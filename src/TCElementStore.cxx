@@ -0,0 +1,289 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCElementStore                                                       //
+//                                                                      //
+// Element-sliced store of the 2D histograms of one run file.           //
+//                                                                      //
+// The main calibration histograms have the detector element on the     //
+// y-axis. Reading one element from the AR file requires to read and    //
+// decompress the whole matrix. In the store every 2D histogram is      //
+// kept in its own directory containing an empty x-projection as axis   //
+// template ('Template'), the store information ('Info') and one        //
+// separately compressed row per non-empty element ('E_<elem>', and     //
+// 'W_<elem>' for the sum of squares of weights). The key list of the   //
+// directory serves as offset index, i.e., only the rows of the         //
+// requested elements are read from disk.                               //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "TFile.h"
+#include "TKey.h"
+#include "TClass.h"
+#include "TH2.h"
+#include "TArrayI.h"
+#include "TArrayD.h"
+#include "TError.h"
+
+#include "TCElementStore.h"
+
+ClassImp(TCElementStore)
+
+//______________________________________________________________________________
+TCElementStore::TCElementStore(const Char_t* filename)
+{
+    // Constructor opening the store file 'filename'.
+
+    // init members
+    fFile = 0;
+
+    // open the file
+    TFile* f = TFile::Open(filename);
+    if (!f || f->IsZombie())
+    {
+        Error("TCElementStore", "Could not open the store file '%s'!", filename);
+        if (f) delete f;
+        return;
+    }
+
+    // set members
+    fFile = f;
+}
+
+//______________________________________________________________________________
+TCElementStore::~TCElementStore()
+{
+    // Destructor.
+
+    if (fFile) delete fFile;
+}
+
+//______________________________________________________________________________
+TDirectory* TCElementStore::GetHistoDirectory(const Char_t* name) const
+{
+    // Return the directory of the histogram 'name' or 0 if it is not stored.
+
+    if (!fFile) return 0;
+
+    return fFile->GetDirectory(name);
+}
+
+//______________________________________________________________________________
+Int_t TCElementStore::GetNElements(const Char_t* name) const
+{
+    // Return the number of elements of the histogram 'name' or 0 if it is not
+    // stored.
+
+    // get directory
+    TDirectory* dir = GetHistoDirectory(name);
+    if (!dir) return 0;
+
+    // read the store information
+    TArrayI* info = 0;
+    dir->GetObject("Info", info);
+    if (!info) return 0;
+    Int_t n = info->GetSize() > 1 ? info->At(1) : 0;
+    delete info;
+
+    return n;
+}
+
+//______________________________________________________________________________
+TH1* TCElementStore::GetElement(const Char_t* name, Int_t elem) const
+{
+    // Return the row of the element 'elem' of the histogram 'name' as a 1D
+    // histogram named '<name>_<elem>'. This corresponds to the projection
+    // ProjectionX(..., elem+1, elem+1, "e") of the original histogram.
+    // Return 0 if the histogram is not stored.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    TH1* h = 0;
+    if (!AddElement(h, name, elem)) return 0;
+
+    return h;
+}
+
+//______________________________________________________________________________
+Bool_t TCElementStore::AddElement(TH1*& hSum, const Char_t* name, Int_t elem) const
+{
+    // Add the row of the element 'elem' of the histogram 'name' to the
+    // histogram 'hSum'. 'hSum' is created from the axis template if it is 0.
+    // Return kFALSE if the histogram is not stored, otherwise kTRUE.
+
+    // get directory
+    TDirectory* dir = GetHistoDirectory(name);
+    if (!dir) return kFALSE;
+
+    // do not keep histograms in memory
+    TH1::AddDirectory(kFALSE);
+
+    // create the histogram from the axis template
+    if (!hSum)
+    {
+        TH1* t = (TH1*) dir->Get("Template");
+        if (!t)
+        {
+            Error("AddElement", "No axis template of histogram '%s' found!", name);
+            return kFALSE;
+        }
+        t->ResetBit(kMustCleanup);
+        t->SetName(TString::Format("%s_%d", name, elem).Data());
+        if (!t->GetSumw2N()) t->Sumw2();
+        hSum = t;
+    }
+
+    // read the row (empty rows are not stored)
+    TArrayD* c = 0;
+    dir->GetObject(TString::Format("E_%d", elem).Data(), c);
+    if (!c) return kTRUE;
+    TArrayD* w = 0;
+    dir->GetObject(TString::Format("W_%d", elem).Data(), w);
+
+    // add contents and sum of squares of weights
+    Int_t n = hSum->GetNcells();
+    if (c->GetSize() < n) n = c->GetSize();
+    Double_t* sumw2 = hSum->GetSumw2()->fArray;
+    for (Int_t i = 0; i < n; i++)
+    {
+        hSum->SetBinContent(i, hSum->GetBinContent(i) + c->fArray[i]);
+        sumw2[i] += w ? w->fArray[i] : c->fArray[i];
+    }
+
+    // recalculate statistics
+    hSum->ResetStats();
+
+    // clean-up
+    delete c;
+    if (w) delete w;
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+void TCElementStore::WriteHisto(TDirectory* dir, TH2* h)
+{
+    // Write the axis template, the store information and the rows of the
+    // histogram 'h' to the directory 'dir'.
+
+    // write the axis template
+    TH1* t = h->ProjectionX("Template", 1, 1, "e");
+    t->Reset();
+    t->SetTitle(h->GetTitle());
+    dir->WriteTObject(t, "Template");
+    delete t;
+
+    // write the store information
+    Int_t nx = h->GetNbinsX() + 2;
+    Int_t ny = h->GetNbinsY();
+    Bool_t sumw2 = h->GetSumw2N() != 0;
+    TArrayI info(3);
+    info[0] = 1;
+    info[1] = ny;
+    info[2] = sumw2;
+    dir->WriteObjectAny(&info, "TArrayI", "Info");
+
+    // loop over elements
+    TArrayD c(nx);
+    TArrayD w(nx);
+    for (Int_t y = 1; y <= ny; y++)
+    {
+        // copy the row
+        Bool_t empty = kTRUE;
+        for (Int_t x = 0; x < nx; x++)
+        {
+            Int_t bin = h->GetBin(x, y);
+            c.fArray[x] = h->GetBinContent(bin);
+            w.fArray[x] = sumw2 ? h->GetSumw2()->fArray[bin] : c.fArray[x];
+            if (c.fArray[x] != 0 || w.fArray[x] != 0) empty = kFALSE;
+        }
+
+        // skip empty rows
+        if (empty) continue;
+
+        // write the row (each key is compressed separately)
+        dir->WriteObjectAny(&c, "TArrayD", TString::Format("E_%d", y-1).Data());
+        if (sumw2) dir->WriteObjectAny(&w, "TArrayD", TString::Format("W_%d", y-1).Data());
+    }
+}
+
+//______________________________________________________________________________
+Bool_t TCElementStore::Convert(const Char_t* inFile, const Char_t* outFile,
+                               Int_t nName, const Char_t** names)
+{
+    // Convert the 2D histograms of the AR file 'inFile' to the element-sliced
+    // store file 'outFile'. If 'nName' is non-zero only the 'nName' histograms
+    // 'names' are converted, otherwise all 2D histograms of the file.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // open the input file
+    TFile* in = TFile::Open(inFile);
+    if (!in || in->IsZombie())
+    {
+        Error("Convert", "Could not open file '%s'!", inFile);
+        if (in) delete in;
+        return kFALSE;
+    }
+
+    // create the store file
+    TFile* out = new TFile(outFile, "recreate");
+    if (out->IsZombie())
+    {
+        Error("Convert", "Could not create the store file '%s'!", outFile);
+        delete out;
+        delete in;
+        return kFALSE;
+    }
+
+    // do not keep histograms in memory
+    TH1::AddDirectory(kFALSE);
+
+    // loop over keys
+    Int_t nConv = 0;
+    TIter next(in->GetListOfKeys());
+    TKey* key;
+    while ((key = (TKey*)next()))
+    {
+        // check for 2D histogram
+        TClass* cl = TClass::GetClass(key->GetClassName());
+        if (!cl || !cl->InheritsFrom("TH2")) continue;
+
+        // check name
+        if (nName)
+        {
+            Bool_t found = kFALSE;
+            for (Int_t i = 0; i < nName; i++)
+                if (!strcmp(key->GetName(), names[i])) found = kTRUE;
+            if (!found) continue;
+        }
+
+        // skip older cycles
+        if (out->GetDirectory(key->GetName())) continue;
+
+        // read histogram
+        TH2* h = (TH2*) key->ReadObj();
+        if (!h) continue;
+        h->ResetBit(kMustCleanup);
+
+        // write the sliced histogram
+        TDirectory* dir = out->mkdir(key->GetName());
+        WriteHisto(dir, h);
+        nConv++;
+
+        // clean-up
+        delete h;
+    }
+
+    // clean-up
+    delete out;
+    delete in;
+
+    // user information
+    Info("Convert", "Stored %d histograms of '%s' in '%s'", nConv, inFile, outFile);
+
+    return kTRUE;
+}
+
@@ -11,17 +11,94 @@
 //////////////////////////////////////////////////////////////////////////
 
 
+#include <time.h>
+
 #include "TList.h"
+#include "THashList.h"
 #include "TFile.h"
 #include "TH1.h"
+#include "TH2.h"
 #include "TError.h"
+#include "TSystem.h"
+#include "TMD5.h"
+#include "TObjString.h"
+#include "TMath.h"
+#include "TObjArray.h"
+#include "TDirectory.h"
 
 #include "TCFileManager.h"
 #include "TCReadConfig.h"
 #include "TCMySQLManager.h"
+#include "TCThreadPool.h"
+#include "TCRunHistoStore.h"
+#include "TCElementStore.h"
 
 ClassImp(TCFileManager)
 
+// init static class members
+const Int_t TCFileManager::kNFilesPerTask;
+
+// state of a parallel histogram summation
+struct TCFileManagerSum
+{
+    const Char_t* fName;                // name of the histogram
+    Int_t fNFile;                       // number of files
+    TFile** fFile;                      //[fNFile] files
+    Int_t* fStatus;                     //[fNFile] status (0: ok, 1: not found, 2: no histogram)
+    TH1** fSum;                         // partial sums of the tasks
+};
+
+//______________________________________________________________________________
+static void TCFileManagerSumTask(Int_t task, void* arg)
+{
+    // Sum the histograms of the files belonging to the task 'task' in the
+    // order of the files.
+
+    TCFileManagerSum* s = (TCFileManagerSum*) arg;
+
+    // get the range of files
+    Int_t first = task * TCFileManager::kNFilesPerTask;
+    Int_t last = first + TCFileManager::kNFilesPerTask;
+    if (last > s->fNFile) last = s->fNFile;
+
+    // loop over files
+    TH1* hSum = 0;
+    for (Int_t i = first; i < last; i++)
+    {
+        // get histogram
+        TH1* h = (TH1*) s->fFile[i]->Get(s->fName);
+
+        // check if histogram is there
+        if (!h)
+        {
+            s->fStatus[i] = 1;
+            continue;
+        }
+
+        // correct destroying
+        h->ResetBit(kMustCleanup);
+
+        // check if object is really a histogram
+        if (h->InheritsFrom("TH1"))
+        {
+            // keep the first one and add the others
+            if (!hSum)
+            {
+                hSum = h;
+                h = 0;
+            }
+            else hSum->Add(h);
+            s->fStatus[i] = 0;
+        }
+        else s->fStatus[i] = 2;
+
+        // clean-up
+        if (h) delete h;
+    }
+
+    s->fSum[task] = hSum;
+}
+
 //______________________________________________________________________________
 TCFileManager::TCFileManager(const Char_t* data, const Char_t* calibration,
                              Int_t nSet, Int_t* set, const Char_t* filePat)
@@ -39,6 +116,15 @@ TCFileManager::TCFileManager(const Char_t* data, const Char_t* calibration,
     for (Int_t i = 0; i < fNset; i++) fSet[i] = set[i];
     fFiles = new TList();
     fFiles->SetOwner(kTRUE);
+    fNThreads = TCThreadPool::GetNThreads();
+    fStore = new THashList();
+    fStore->SetOwner(kTRUE);
+    fCacheSize = 0;
+    fNCacheHit = 0;
+    fNCacheMiss = 0;
+    fElementFiles = new TList();
+    fElementFiles->SetOwner(kTRUE);
+    fElementStores = 0;
 
     // read input file pattern
     if (filePat) fInputFilePatt = filePat;
@@ -62,8 +148,29 @@ TCFileManager::TCFileManager(const Char_t* data, const Char_t* calibration,
         }
     }
 
+    // read element-sliced file pattern
+    if (TString* f = TCReadConfig::GetReader()->GetConfig("File.Element.Rootfiles"))
+    {
+        if (f->Contains("RUN")) fElementFilePatt = *f;
+        else Warning("TCFileManager", "Error in element-sliced file pattern configuration!");
+    }
+
     // build the list of files
     BuildFileList();
+
+    // get the directory of the run histogram stores
+    if (TString* dir = TCReadConfig::GetReader()->GetConfig("File.RunStore.Dir"))
+    {
+        fRunStoreDir = *dir;
+        gSystem->ExpandPathName(fRunStoreDir);
+    }
+
+    // configure the histogram cache
+    if (TString* dir = TCReadConfig::GetReader()->GetConfig("File.Cache.Dir"))
+    {
+        Long64_t size = TCReadConfig::GetReader()->GetConfigInt("File.Cache.Size");
+        SetCache(dir->Data(), size > 0 ? size*1024*1024 : 0);
+    }
 }
 
 //______________________________________________________________________________
@@ -73,6 +180,17 @@ TCFileManager::~TCFileManager()
 
     if (fFiles) delete fFiles;
     if (fSet) delete [] fSet;
+    if (fStore) delete fStore;
+    if (fElementStores)
+    {
+        for (Int_t i = 0; i < fElementFiles->GetSize(); i++)
+            if (fElementStores[i]) delete fElementStores[i];
+        delete [] fElementStores;
+    }
+    if (fElementFiles) delete fElementFiles;
+
+    // report cache usage
+    if (fCacheDir != "") PrintCacheStats();
 }
 
 //______________________________________________________________________________
@@ -90,25 +208,27 @@ void TCFileManager::BuildFileList()
         // user information
         Info("BuildFileList", "Trying to add %d runs of set %d", nRun, fSet[i]);
 
-        // loop over runs
+        // construct file names
+        TString* filenames = new TString[nRun];
         for (Int_t j = 0; j < nRun; j++)
         {
-            // construct file name
-            TString filename(fInputFilePatt);
-            filename.ReplaceAll("RUN", TString::Format("%d", runs[j]));
+            filenames[j] = fInputFilePatt;
+            filenames[j].ReplaceAll("RUN", TString::Format("%d", runs[j]));
+        }
 
-            // open the file
-            TFile* f = TFile::Open(filename.Data());
+        // open the files concurrently (keeps the order of the runs)
+        TFile** files = new TFile*[nRun];
+        Int_t* status = new Int_t[nRun];
+        TCThreadPool::OpenFiles(nRun, filenames, files, status);
 
-            // check nonexisting file
-            if (!f)
-            {
-                Warning("BuildFileList", "Could not open file '%s'", filename.Data());
-                continue;
-            }
+        // loop over runs
+        for (Int_t j = 0; j < nRun; j++)
+        {
+            const TString& filename = filenames[j];
+            TFile* f = files[j];
 
-            // check bad file
-            if (f->IsZombie())
+            // check nonexisting or bad file
+            if (status[j] != TCThreadPool::kFileOK)
             {
                 Warning("BuildFileList", "Could not open file '%s'", filename.Data());
                 continue;
@@ -117,12 +237,29 @@ void TCFileManager::BuildFileList()
             // add good file to list
             fFiles->Add(f);
 
+            // add file name, size and modification time to the cache key
+            Long_t id, flags, modtime;
+            Long64_t size;
+            if (gSystem->GetPathInfo(filename.Data(), &id, &size, &flags, &modtime)) size = modtime = -1;
+            fCacheKey.Append(TString::Format("%s:%lld:%ld;", filename.Data(), size, modtime));
+
+            // add the name of the element-sliced file
+            if (fElementFilePatt != "")
+            {
+                TString elemname(fElementFilePatt);
+                elemname.ReplaceAll("RUN", TString::Format("%d", runs[j]));
+                fElementFiles->Add(new TObjString(elemname.Data()));
+            }
+
             // user information
             Info("BuildFileList", "%03d : added file '%s'", j, f->GetName());
         }
 
         // clean-up
-        delete runs;
+        delete [] filenames;
+        delete [] files;
+        delete [] status;
+        delete [] runs;
     }
 }
 
@@ -130,6 +267,65 @@ void TCFileManager::BuildFileList()
 TH1* TCFileManager::GetHistogram(const Char_t* name)
 {
     // Get the summed-up histogram with name 'name'.
+    // A copy of the stored histogram is returned if it was prefetched via
+    // Prefetch(). Otherwise the histogram is built from the run histogram
+    // store or read from the histogram cache if available or summed-up by
+    // GetHistogramParallel() using several threads if configured via
+    // Parallel.Threads or set via SetNThreads(). The summation order does not
+    // depend on the number of threads.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    // return copy of prefetched histogram
+    if (fStore)
+    {
+        TH1* h = (TH1*) fStore->FindObject(name);
+        if (h)
+        {
+            TH1::AddDirectory(kFALSE);
+            return (TH1*) h->Clone();
+        }
+    }
+
+    // try to sum up the sets using the run histogram store
+    TH1* h = GetHistogramFromRunStore(name);
+    if (h) return h;
+
+    // try to read from the histogram cache
+    h = ReadCache(name);
+    if (h) return h;
+
+    // sum up the histograms
+    h = GetHistogramParallel(name);
+
+    // add to the histogram cache
+    if (h) WriteCache(h);
+
+    return h;
+}
+
+//______________________________________________________________________________
+TH1* TCFileManager::GetSetHistogram(const Char_t* data, const Char_t* calibration, Int_t set,
+                                    const Char_t* name, const Char_t* filePat,
+                                    const Char_t* storeDir)
+{
+    // Get the summed-up histogram with name 'name' of the set 'set' of the
+    // calibration data 'data' and the calibration identifier 'calibration'.
+    // The file pattern 'filePat' and the run histogram store directory
+    // 'storeDir' are used instead of the configured ones if they are non-zero.
+    // See GetHistogram().
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    TCFileManager m(data, calibration, 1, &set, filePat);
+    if (storeDir) m.SetRunStoreDir(storeDir);
+
+    return m.GetHistogram(name);
+}
+
+//______________________________________________________________________________
+TH1* TCFileManager::GetHistogramSerial(const Char_t* name)
+{
+    // Get the summed-up histogram with name 'name' by adding the histograms
+    // of all files one after the other (reference implementation).
     // NOTE: the histogram has to be destroyed by the caller.
 
     TH1* hOut = 0;
@@ -137,7 +333,7 @@ TH1* TCFileManager::GetHistogram(const Char_t* name)
     // check if there are some runs
     if (!fFiles->GetSize())
     {
-        Error("GetHistogram", "ROOT file list is empty!");
+        Error("GetHistogramSerial", "ROOT file list is empty!");
         return 0;
     }
 
@@ -172,7 +368,7 @@ TH1* TCFileManager::GetHistogram(const Char_t* name)
             }
             else
             {
-                Error("GetHistogram", "Object '%s' found in file '%s' is not a histogram!",
+                Error("GetHistogramSerial", "Object '%s' found in file '%s' is not a histogram!",
                                       name, f->GetName());
             }
 
@@ -181,7 +377,7 @@ TH1* TCFileManager::GetHistogram(const Char_t* name)
         }
         else
         {
-            Warning("GetHistogram", "Histogram '%s' was not found in file '%s'",
+            Warning("GetHistogramSerial", "Histogram '%s' was not found in file '%s'",
                                     name, f->GetName());
         }
     } // loop over files
@@ -189,3 +385,687 @@ TH1* TCFileManager::GetHistogram(const Char_t* name)
     return hOut;
 }
 
+//______________________________________________________________________________
+TH1* TCFileManager::GetHistogramParallel(const Char_t* name)
+{
+    // Get the summed-up histogram with name 'name' reading the files in
+    // several threads (or serially if only one thread is used).
+    // The files are split into blocks of kNFilesPerTask files that are summed
+    // in file order by the worker threads. The partial sums are combined by
+    // a pairwise tree reduction. As the blocks and the reduction tree do not
+    // depend on the number of threads, the result is the same for any number
+    // of threads.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    // check if there are some runs
+    Int_t nFile = fFiles->GetSize();
+    if (!nFile)
+    {
+        Error("GetHistogramParallel", "ROOT file list is empty!");
+        return 0;
+    }
+
+    // do not keep histograms in memory
+    TH1::AddDirectory(kFALSE);
+
+    // init the summation
+    Int_t nTask = (nFile + kNFilesPerTask - 1) / kNFilesPerTask;
+    TCFileManagerSum s;
+    s.fName = name;
+    s.fNFile = nFile;
+    s.fFile = new TFile*[nFile];
+    s.fStatus = new Int_t[nFile];
+    s.fSum = new TH1*[nTask];
+    TIter next(fFiles);
+    for (Int_t i = 0; i < nFile; i++) s.fFile[i] = (TFile*) next();
+
+    // sum the blocks of files
+    TCThreadPool::Run(nTask, TCFileManagerSumTask, &s, TCThreadPool::LimitIOThreads(fNThreads));
+
+    // report problems in file order
+    for (Int_t i = 0; i < nFile; i++)
+    {
+        if (s.fStatus[i] == 1)
+            Warning("GetHistogramParallel", "Histogram '%s' was not found in file '%s'",
+                                            name, s.fFile[i]->GetName());
+        else if (s.fStatus[i] == 2)
+            Error("GetHistogramParallel", "Object '%s' found in file '%s' is not a histogram!",
+                                          name, s.fFile[i]->GetName());
+    }
+
+    // pairwise tree reduction of the partial sums
+    for (Int_t step = 1; step < nTask; step *= 2)
+    {
+        for (Int_t i = 0; i + step < nTask; i += 2*step)
+        {
+            if (!s.fSum[i + step]) continue;
+            if (!s.fSum[i]) s.fSum[i] = s.fSum[i + step];
+            else
+            {
+                s.fSum[i]->Add(s.fSum[i + step]);
+                delete s.fSum[i + step];
+            }
+            s.fSum[i + step] = 0;
+        }
+    }
+    TH1* hOut = s.fSum[0];
+
+    // clean-up
+    delete [] s.fFile;
+    delete [] s.fStatus;
+    delete [] s.fSum;
+
+    return hOut;
+}
+
+//______________________________________________________________________________
+Int_t TCFileManager::Prefetch(Int_t nName, const Char_t** names)
+{
+    // Build the summed-up histograms of the 'nName' histograms with the names
+    // 'names' in a single pass over the files and store them. Subsequent calls
+    // of GetHistogram() return copies of the stored histograms.
+    // Return the number of stored histograms.
+
+    // check if there are some runs
+    if (!fFiles->GetSize())
+    {
+        Error("Prefetch", "ROOT file list is empty!");
+        return 0;
+    }
+
+    // do not keep histograms in memory
+    TH1::AddDirectory(kFALSE);
+
+    // init sums (try the histogram cache first)
+    TH1* sum[nName];
+    Int_t nMissing[nName];
+    Bool_t cached[nName];
+    Int_t nRead = 0;
+    for (Int_t i = 0; i < nName; i++)
+    {
+        sum[i] = ReadCache(names[i]);
+        cached[i] = sum[i] ? kTRUE : kFALSE;
+        if (!cached[i]) nRead++;
+        nMissing[i] = 0;
+    }
+
+    // loop over files
+    TIter next(fFiles);
+    TFile* f;
+    while (nRead && (f = (TFile*)next()))
+    {
+        // loop over histograms
+        for (Int_t i = 0; i < nName; i++)
+        {
+            // skip cached histograms
+            if (cached[i]) continue;
+
+            // get histogram
+            TH1* h = (TH1*) f->Get(names[i]);
+
+            // check if histogram is there
+            if (!h)
+            {
+                nMissing[i]++;
+                continue;
+            }
+
+            // correct destroying
+            h->ResetBit(kMustCleanup);
+
+            // check if object is really a histogram
+            if (!h->InheritsFrom("TH1"))
+            {
+                Error("Prefetch", "Object '%s' found in file '%s' is not a histogram!",
+                                  names[i], f->GetName());
+                delete h;
+                continue;
+            }
+
+            // keep the first one and add the others
+            if (!sum[i]) sum[i] = h;
+            else
+            {
+                sum[i]->Add(h);
+                delete h;
+            }
+        }
+    }
+
+    // store the histograms
+    Int_t nStored = 0;
+    for (Int_t i = 0; i < nName; i++)
+    {
+        // report missing histograms
+        if (nMissing[i])
+            Warning("Prefetch", "Histogram '%s' was not found in %d of %d files",
+                                names[i], nMissing[i], fFiles->GetSize());
+
+        // check histogram
+        if (!sum[i]) continue;
+
+        // replace old histogram
+        TObject* old = fStore->FindObject(names[i]);
+        if (old)
+        {
+            fStore->Remove(old);
+            delete old;
+        }
+
+        // store histogram under the requested name
+        sum[i]->SetName(names[i]);
+        fStore->Add(sum[i]);
+        nStored++;
+
+        // add to the histogram cache
+        if (!cached[i]) WriteCache(sum[i]);
+    }
+
+    // user information
+    Info("Prefetch", "Stored %d of %d histograms (%d read from %d files)",
+                     nStored, nName, nRead, fFiles->GetSize());
+
+    return nStored;
+}
+
+//______________________________________________________________________________
+Int_t TCFileManager::PrefetchElements(const Char_t* name, Int_t first, Int_t last)
+{
+    // Prefetch the per-element histograms 'name'_000, 'name'_001 etc. of the
+    // elements 'first' to 'last' in a single pass over the files.
+    // Return the number of stored histograms.
+
+    // check range
+    if (last < first) return 0;
+
+    // create the names
+    Int_t n = last - first + 1;
+    TString* names = new TString[n];
+    const Char_t* pnames[n];
+    for (Int_t i = 0; i < n; i++)
+    {
+        names[i] = TString::Format("%s_%03d", name, first + i);
+        pnames[i] = names[i].Data();
+    }
+
+    // prefetch
+    Int_t nStored = Prefetch(n, pnames);
+
+    // clean-up
+    delete [] names;
+
+    return nStored;
+}
+
+//______________________________________________________________________________
+Bool_t TCFileManager::IsPrefetched(const Char_t* name) const
+{
+    // Check if the histogram 'name' was prefetched.
+
+    return fStore && fStore->FindObject(name);
+}
+
+//______________________________________________________________________________
+void TCFileManager::ClearPrefetched()
+{
+    // Delete all prefetched histograms.
+
+    if (fStore) fStore->Delete();
+}
+
+//______________________________________________________________________________
+void TCFileManager::SetCache(const Char_t* dir, Long64_t maxSize)
+{
+    // Enable the persistent histogram cache in the directory 'dir' with a
+    // maximum size of 'maxSize' bytes (unlimited if 0). The cache is disabled
+    // if 'dir' is 0.
+    // The summed-up histograms are stored in one ROOT file per histogram
+    // named after the MD5 sum of the histogram name and the names, sizes and
+    // modification times of all input files. Cached histograms are therefore
+    // rebuilt automatically when the run list or an input file changes.
+    // The least recently used files are deleted when the size limit is
+    // exceeded.
+
+    // disable cache
+    if (!dir)
+    {
+        fCacheDir = "";
+        return;
+    }
+
+    // set directory and size
+    fCacheDir = dir;
+    gSystem->ExpandPathName(fCacheDir);
+    fCacheSize = maxSize;
+
+    // create the directory
+    if (gSystem->AccessPathName(fCacheDir.Data()) && gSystem->mkdir(fCacheDir.Data(), kTRUE))
+    {
+        Error("SetCache", "Could not create the histogram cache directory '%s'!", fCacheDir.Data());
+        fCacheDir = "";
+        return;
+    }
+
+    // user information
+    Info("SetCache", "Using histogram cache '%s'", fCacheDir.Data());
+}
+
+//______________________________________________________________________________
+TString TCFileManager::GetCacheFile(const Char_t* name) const
+{
+    // Return the path of the cache file of the histogram 'name'.
+
+    // calculate the cache key
+    TString key = TString::Format("%s|%s", name, fCacheKey.Data());
+    TMD5 md5;
+    md5.Update((const UChar_t*)key.Data(), key.Length());
+    md5.Final();
+
+    return TString::Format("%s/%s.root", fCacheDir.Data(), md5.AsString());
+}
+
+//______________________________________________________________________________
+TH1* TCFileManager::ReadCache(const Char_t* name)
+{
+    // Read the summed-up histogram 'name' from the histogram cache.
+    // Return 0 if the cache is disabled or the histogram is not cached.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    // check if cache is enabled
+    if (fCacheDir == "") return 0;
+
+    // check for cache file
+    TString fn = GetCacheFile(name);
+    if (gSystem->AccessPathName(fn.Data()))
+    {
+        fNCacheMiss++;
+        return 0;
+    }
+
+    // do not keep histograms in memory
+    TH1::AddDirectory(kFALSE);
+
+    // read histogram and key
+    TDirectory* dirOrig = gDirectory;
+    TFile* f = new TFile(fn.Data());
+    TH1* h = f->IsZombie() ? 0 : (TH1*) f->Get(name);
+    TObjString* key = f->IsZombie() ? 0 : (TObjString*) f->Get("CacheKey");
+    delete f;
+    dirOrig->cd();
+
+    // verify key
+    if (!h || !key || key->GetString() != TString::Format("%s|%s", name, fCacheKey.Data()))
+    {
+        if (h) delete h;
+        if (key) delete key;
+        fNCacheMiss++;
+        return 0;
+    }
+    delete key;
+
+    // mark file as recently used
+    gSystem->Utime(fn.Data(), time(0), 0);
+
+    // user information
+    fNCacheHit++;
+    Info("ReadCache", "Read histogram '%s' from cache", name);
+
+    return h;
+}
+
+//______________________________________________________________________________
+void TCFileManager::WriteCache(TH1* h)
+{
+    // Write the summed-up histogram 'h' to the histogram cache.
+
+    // check if cache is enabled
+    if (fCacheDir == "") return;
+
+    // write to temporary file
+    TString fn = GetCacheFile(h->GetName());
+    TString tmp = TString::Format("%s.%d.tmp", fn.Data(), gSystem->GetPid());
+    TDirectory* dirOrig = gDirectory;
+    TFile* f = new TFile(tmp.Data(), "recreate");
+    if (f->IsZombie())
+    {
+        Error("WriteCache", "Could not write to the histogram cache '%s'!", fCacheDir.Data());
+        delete f;
+        dirOrig->cd();
+        return;
+    }
+    f->cd();
+    h->Write(h->GetName());
+    TObjString key(TString::Format("%s|%s", h->GetName(), fCacheKey.Data()));
+    key.Write("CacheKey");
+    delete f;
+    dirOrig->cd();
+
+    // move to final location
+    if (gSystem->Rename(tmp.Data(), fn.Data()))
+    {
+        Error("WriteCache", "Could not move the histogram to the cache file '%s'!", fn.Data());
+        gSystem->Unlink(tmp.Data());
+        return;
+    }
+
+    // apply size limit
+    EvictCache();
+}
+
+//______________________________________________________________________________
+void TCFileManager::EvictCache()
+{
+    // Delete the least recently used files of the histogram cache until its
+    // size is below the maximum size.
+
+    // check size limit
+    if (fCacheDir == "" || fCacheSize <= 0) return;
+
+    // open directory
+    void* dir = gSystem->OpenDirectory(fCacheDir.Data());
+    if (!dir) return;
+
+    // collect cache files
+    TObjArray files;
+    files.SetOwner(kTRUE);
+    Int_t n = 0;
+    Int_t nMax = 256;
+    Long64_t* size = new Long64_t[nMax];
+    Long_t* mtime = new Long_t[nMax];
+    Long64_t total = 0;
+    const Char_t* entry;
+    while ((entry = gSystem->GetDirEntry(dir)))
+    {
+        // check file
+        TString fn(entry);
+        if (!fn.EndsWith(".root")) continue;
+        fn = TString::Format("%s/%s", fCacheDir.Data(), entry);
+        Long_t id, flags, modtime;
+        Long64_t sz;
+        if (gSystem->GetPathInfo(fn.Data(), &id, &sz, &flags, &modtime)) continue;
+
+        // enlarge arrays if necessary
+        if (n == nMax)
+        {
+            Long64_t* size_new = new Long64_t[2*nMax];
+            Long_t* mtime_new = new Long_t[2*nMax];
+            for (Int_t i = 0; i < n; i++)
+            {
+                size_new[i] = size[i];
+                mtime_new[i] = mtime[i];
+            }
+            delete [] size;
+            delete [] mtime;
+            size = size_new;
+            mtime = mtime_new;
+            nMax *= 2;
+        }
+
+        // add file
+        files.Add(new TObjString(fn.Data()));
+        size[n] = sz;
+        mtime[n] = modtime;
+        total += sz;
+        n++;
+    }
+    gSystem->FreeDirectory(dir);
+
+    // delete oldest files
+    if (total > fCacheSize)
+    {
+        Int_t index[n];
+        TMath::Sort(n, mtime, index, kFALSE);
+        for (Int_t i = 0; i < n && total > fCacheSize; i++)
+        {
+            TObjString* fn = (TObjString*) files.At(index[i]);
+            gSystem->Unlink(fn->GetString().Data());
+            total -= size[index[i]];
+            Info("EvictCache", "Removed '%s' from the histogram cache", fn->GetString().Data());
+        }
+    }
+
+    // clean-up
+    delete [] size;
+    delete [] mtime;
+}
+
+//______________________________________________________________________________
+void TCFileManager::PrintCacheStats() const
+{
+    // Print the usage statistics of the histogram cache.
+
+    Info("PrintCacheStats", "Histogram cache '%s': %d hits, %d misses",
+                            fCacheDir.Data(), fNCacheHit, fNCacheMiss);
+}
+
+//______________________________________________________________________________
+void TCFileManager::SetRunStoreDir(const Char_t* dir)
+{
+    // Set the directory of the run histogram stores to 'dir' overriding the
+    // configured File.RunStore.Dir. An empty directory disables the stores.
+
+    fRunStoreDir = dir ? dir : "";
+    gSystem->ExpandPathName(fRunStoreDir);
+}
+
+//______________________________________________________________________________
+TH1* TCFileManager::GetHistogramFromRunStore(const Char_t* name)
+{
+    // Build the summed-up histogram with name 'name' from the run histogram
+    // store '<File.RunStore.Dir>/<name>.root' (see TCRunHistoStore) if it
+    // exists. The store has to contain exactly the runs of the sets and the
+    // run files must not have changed since the store was built.
+    // Return 0 if there is no such store.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    // check for store
+    if (fRunStoreDir == "") return 0;
+    TString fn = TString::Format("%s/%s.root", fRunStoreDir.Data(), name);
+    if (gSystem->AccessPathName(fn.Data())) return 0;
+
+    // open the store
+    TCRunHistoStore store(fn.Data());
+    if (!store.IsOpen()) return 0;
+
+    // check the runs of all sets
+    TCMySQLManager* m = TCMySQLManager::GetManager();
+    for (Int_t i = 0; i < fNset; i++)
+    {
+        Int_t nRun;
+        Int_t* runs = m->GetRunsOfSet(fCalibData.Data(), fCalibration.Data(), fSet[i], &nRun);
+        Bool_t ok = store.IsUpToDate(m->GetFirstRunOfSet(fCalibData.Data(), fCalibration.Data(), fSet[i]),
+                                     m->GetLastRunOfSet(fCalibData.Data(), fCalibration.Data(), fSet[i]),
+                                     nRun, runs, fInputFilePatt.Data());
+        if (runs) delete [] runs;
+        if (!ok)
+        {
+            Warning("GetHistogramFromRunStore", "Store '%s' is incomplete or outdated for set %d - summing the files",
+                    fn.Data(), fSet[i]);
+            return 0;
+        }
+    }
+
+    // sum up the sets
+    TH1* hOut = 0;
+    for (Int_t i = 0; i < fNset; i++)
+    {
+        TH1* h = store.GetSetSum(fCalibData.Data(), fCalibration.Data(), fSet[i]);
+        if (!h) continue;
+        if (!hOut) hOut = h;
+        else
+        {
+            hOut->Add(h);
+            delete h;
+        }
+    }
+
+    // user information
+    if (hOut) Info("GetHistogramFromRunStore", "Built histogram '%s' from the store '%s'",
+                                               name, fn.Data());
+
+    return hOut;
+}
+
+//______________________________________________________________________________
+TCElementStore* TCFileManager::GetElementStore(Int_t i)
+{
+    // Return the element-sliced file with index 'i' of the list of
+    // element-sliced files. The files are opened on first access and kept
+    // open until the file manager is destroyed. Return 0 if the file does not
+    // exist or could not be opened.
+
+    // check for element-sliced files
+    if (!fElementFiles || i < 0 || i >= fElementFiles->GetSize()) return 0;
+
+    // create the array of stores
+    if (!fElementStores)
+    {
+        fElementStores = new TCElementStore*[fElementFiles->GetSize()];
+        for (Int_t j = 0; j < fElementFiles->GetSize(); j++) fElementStores[j] = 0;
+    }
+
+    // open the store
+    if (!fElementStores[i])
+    {
+        TObjString* fn = (TObjString*) fElementFiles->At(i);
+        if (gSystem->AccessPathName(fn->GetString().Data())) return 0;
+        TCElementStore* store = new TCElementStore(fn->GetString().Data());
+        if (!store->IsOpen())
+        {
+            delete store;
+            return 0;
+        }
+        fElementStores[i] = store;
+    }
+
+    return fElementStores[i];
+}
+
+//______________________________________________________________________________
+Bool_t TCFileManager::HasElementHistogram(const Char_t* name)
+{
+    // Check if the rows of the 2D histogram with name 'name' can be read from
+    // the element-sliced files, i.e. if element-sliced files are configured
+    // and all of them exist and contain the histogram.
+
+    // check for element-sliced files
+    if (!fElementFiles || !fElementFiles->GetSize() ||
+        fElementFiles->GetSize() != fFiles->GetSize()) return kFALSE;
+
+    // check all files
+    for (Int_t i = 0; i < fElementFiles->GetSize(); i++)
+    {
+        TCElementStore* store = GetElementStore(i);
+        if (!store || !store->HasHisto(name)) return kFALSE;
+    }
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+TH1* TCFileManager::GetElementHistogram(const Char_t* name, Int_t elem)
+{
+    // Get the summed-up projection of the element 'elem' (y-bin 'elem'+1) of
+    // the 2D histogram with name 'name'. See GetElementHistograms().
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    TH1* h = 0;
+    if (!GetElementHistograms(name, 1, &elem, &h)) return 0;
+
+    return h;
+}
+
+//______________________________________________________________________________
+Bool_t TCFileManager::GetElementHistograms(const Char_t* name, Int_t nElem, const Int_t* elem,
+                                           TH1** outHistos)
+{
+    // Get the summed-up projections of the 'nElem' elements 'elem' (y-bins
+    // 'elem'+1) of the 2D histogram with name 'name' and save them to
+    // 'outHistos'. Only the rows of these elements are read if element-sliced
+    // files (see TCElementStore) are configured via File.Element.Rootfiles,
+    // the full histogram is not prefetched and all runs were converted.
+    // Otherwise the projections of the summed-up histogram are returned.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+    // NOTE: the histograms have to be destroyed by the caller.
+
+    // init output
+    for (Int_t i = 0; i < nElem; i++) outHistos[i] = 0;
+
+    // try the element-sliced files
+    if (!IsPrefetched(name) && GetElementsFromStore(name, nElem, elem, outHistos)) return kTRUE;
+
+    // get the summed-up histogram
+    TH2* h = (TH2*) GetHistogram(name);
+    if (!h) return kFALSE;
+    if (!h->InheritsFrom("TH2"))
+    {
+        Error("GetElementHistograms", "Histogram '%s' is not a 2D histogram!", name);
+        delete h;
+        return kFALSE;
+    }
+
+    // project the elements
+    for (Int_t i = 0; i < nElem; i++)
+        outHistos[i] = h->ProjectionX(TString::Format("%s_%d", name, elem[i]).Data(),
+                                      elem[i]+1, elem[i]+1, "e");
+
+    // clean-up
+    delete h;
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCFileManager::GetElementsFromStore(const Char_t* name, Int_t nElem, const Int_t* elem,
+                                           TH1** outHistos)
+{
+    // Sum up the rows of the 'nElem' elements 'elem' of the histogram 'name'
+    // using the element-sliced files and save them to 'outHistos'.
+    // Return kFALSE if the rows could not be read from all files.
+
+    // check for element-sliced files
+    if (!fElementFiles || !fElementFiles->GetSize() ||
+        fElementFiles->GetSize() != fFiles->GetSize()) return kFALSE;
+
+    // loop over files
+    Bool_t ok = kTRUE;
+    for (Int_t j = 0; ok && j < fElementFiles->GetSize(); j++)
+    {
+        // get the store
+        TCElementStore* store = GetElementStore(j);
+        if (!store)
+        {
+            ok = kFALSE;
+            break;
+        }
+
+        // add the rows
+        for (Int_t i = 0; i < nElem; i++)
+        {
+            if (!store->AddElement(outHistos[i], name, elem[i]))
+            {
+                ok = kFALSE;
+                break;
+            }
+        }
+    }
+
+    // clean-up on failure
+    if (!ok)
+    {
+        Warning("GetElementsFromStore", "Histogram '%s' not available in all element-sliced files", name);
+        for (Int_t i = 0; i < nElem; i++)
+        {
+            if (outHistos[i]) delete outHistos[i];
+            outHistos[i] = 0;
+        }
+        return kFALSE;
+    }
+
+    // user information
+    Info("GetElementsFromStore", "Summed up %d elements of histogram '%s' from %d element-sliced files",
+                                 nElem, name, fElementFiles->GetSize());
+
+    return kTRUE;
+}
+
@@ -15,15 +15,20 @@
 #include "TH1.h"
 #include "TF1.h"
 #include "TRandom.h"
+#include "TMath.h"
 
 #include "TCFitUtils.h"
 
 
 //______________________________________________________________________________
-Bool_t TCFitUtils::ReFit(TH1* h, TF1* f, Option_t* option /*= ""*/, Int_t n /*= 10*/)
+Bool_t TCFitUtils::ReFit(TH1* h, TF1* f, Option_t* option /*= ""*/, Int_t n /*= 10*/,
+                         TRandom* rnd /*= 0*/, Double_t tol /*= 0*/, Int_t* outNFit /*= 0*/)
 {
     // Returns the best fit out of 'n' tries. Between the tries the parameter
-    // are randomized.
+    // are randomized using the random generator 'rnd' (gRandom if 0).
+    // If 'tol' is positive, no more tries are made as soon as a try reproduces
+    // the best chi square within the relative tolerance 'tol'. The number of
+    // performed fits is saved to 'outNFit' if provided.
 
     // check input
     if (!h || !f) return kFALSE;
@@ -33,22 +38,34 @@ Bool_t TCFitUtils::ReFit(TH1* h, TF1* f, Option_t* option /*= ""*/, Int_t n /*=
 
     // init return value
     Bool_t success = kFALSE;
+    Int_t nFit = 0;
 
     // try n times
     for (Int_t i = 0; i < n; i++)
     {
         // try a fit
+        nFit++;
         if (h->Fit(&func, option)) continue;
+
+        // check if the best minimum was found again
+        Bool_t found = success && tol > 0 && f->GetChisquare() > 0 &&
+                       TMath::Abs(func.GetChisquare() - f->GetChisquare()) <= tol*f->GetChisquare();
         success = kTRUE;
 
         // get better fit
         TF1* g = GetBestChi2Func(&func, f);
         if (g) *f = *g;
 
+        // stop if converged
+        if (found) break;
+
         // randomize parameters
-        RandomizeParameters(&func);
+        RandomizeParameters(&func, 0, rnd);
     }
 
+    // save number of fits
+    if (outNFit) *outNFit = nFit;
+
     // return
     return success;
 }
@@ -76,10 +93,10 @@ TF1* TCFitUtils::GetBestChi2Func(TF1* f1, TF1* f2)
 }
 
 //______________________________________________________________________________
-void TCFitUtils::RandomizeParameter(TF1* f, Int_t i)
+void TCFitUtils::RandomizeParameter(TF1* f, Int_t i, TRandom* rnd /*= 0*/)
 {
     // Sets the i-th parameter of function 'f' to a random value within the
-    // parameter limits.
+    // parameter limits using the random generator 'rnd' (gRandom if 0).
 
     // get par limits
     Double_t lo, hi;
@@ -89,13 +106,15 @@ void TCFitUtils::RandomizeParameter(TF1* f, Int_t i)
     if (lo >= hi) return;
 
     // randomize parameter
-    f->SetParameter(i, lo + (hi-lo)*gRandom->Rndm());
+    if (!rnd) rnd = gRandom;
+    f->SetParameter(i, lo + (hi-lo)*rnd->Rndm());
 }
 
 //______________________________________________________________________________
-void TCFitUtils::RandomizeParameters(TF1* f, Bool_t* isrand /*= 0*/)
+void TCFitUtils::RandomizeParameters(TF1* f, Bool_t* isrand /*= 0*/, TRandom* rnd /*= 0*/)
 {
-    // Randomizes the parameters of function 'f'
+    // Randomizes the parameters of function 'f' using the random generator
+    // 'rnd' (gRandom if 0).
 
     // loop over parameters
     for (Int_t i = 0; i < f->GetNpar(); i++)
@@ -104,7 +123,148 @@ void TCFitUtils::RandomizeParameters(TF1* f, Bool_t* isrand /*= 0*/)
         if (isrand && !isrand[i]) continue;
 
         // randomize
-        RandomizeParameter(f, i);
+        RandomizeParameter(f, i, rnd);
     }
 }
 
+//______________________________________________________________________________
+void TCFitUtils::SetParameterInLimits(TF1* f, Int_t i, Double_t value)
+{
+    // Sets the i-th parameter of function 'f' to 'value' restricted to the
+    // parameter limits. Fixed parameters are not changed.
+
+    // get par limits
+    Double_t lo, hi;
+    f->GetParLimits(i, lo, hi);
+
+    // check for fixed parameter
+    if (lo == hi && lo != 0) return;
+
+    // restrict value
+    if (lo < hi) value = TMath::Min(TMath::Max(value, lo), hi);
+
+    f->SetParameter(i, value);
+}
+
+//______________________________________________________________________________
+static Double_t TCFitUtilsNetContent(const TH1* h, Int_t bin, Double_t bg0, Double_t bg1)
+{
+    // Return the content of the bin 'bin' of the histogram 'h' above the
+    // linear background with the parameters 'bg0' and 'bg1'.
+
+    return h->GetBinContent(bin) - bg0 - bg1*h->GetBinCenter(bin);
+}
+
+//______________________________________________________________________________
+Bool_t TCFitUtils::EstimatePeak(const TH1* h, Int_t first, Int_t last,
+                                Double_t* outPos, Double_t* outSigma, Double_t* outAmp,
+                                Double_t* outBg0 /*= 0*/, Double_t* outBg1 /*= 0*/)
+{
+    // Estimates the position, the width (gaussian sigma) and the amplitude of
+    // the highest peak of the histogram 'h' in the bin range ['first','last']
+    // without fitting. A linear background through the edges of the range is
+    // subtracted. The position and the amplitude are taken from a parabola
+    // through the logarithms of the three bins around the maximum (exact for
+    // a gaussian), the width from the full width at half maximum. The results
+    // are saved to 'outPos', 'outSigma' and 'outAmp', the background
+    // parameters to 'outBg0' and 'outBg1' if provided. Returns kFALSE if no
+    // peak was found, otherwise kTRUE.
+
+    // check input
+    if (!h) return kFALSE;
+    if (first < 1) first = 1;
+    if (last > h->GetNbinsX()) last = h->GetNbinsX();
+    Int_t n = last - first + 1;
+    if (n < 5) return kFALSE;
+
+    // estimate linear background from the edges of the range
+    Int_t nEdge = TMath::Max(n / 10, 1);
+    Double_t xl = 0, yl = 0, xr = 0, yr = 0;
+    for (Int_t i = 0; i < nEdge; i++)
+    {
+        xl += h->GetBinCenter(first + i);
+        yl += h->GetBinContent(first + i);
+        xr += h->GetBinCenter(last - i);
+        yr += h->GetBinContent(last - i);
+    }
+    Double_t bg1 = (yr - yl) / (xr - xl);
+    Double_t bg0 = yl/nEdge - bg1*xl/nEdge;
+
+    // find the maximum above the background
+    Int_t maxBin = 0;
+    Double_t max = 0;
+    for (Int_t i = first; i <= last; i++)
+    {
+        Double_t y = TCFitUtilsNetContent(h, i, bg0, bg1);
+        if (y > max)
+        {
+            max = y;
+            maxBin = i;
+        }
+    }
+    if (!maxBin) return kFALSE;
+
+    // init estimates
+    Double_t w = h->GetBinWidth(maxBin);
+    Double_t pos = h->GetBinCenter(maxBin);
+    Double_t amp = max;
+    Double_t sigma = 0;
+
+    // refine using a parabola through the logarithms around the maximum
+    if (maxBin > first && maxBin < last)
+    {
+        Double_t ym = TCFitUtilsNetContent(h, maxBin - 1, bg0, bg1);
+        Double_t yp = TCFitUtilsNetContent(h, maxBin + 1, bg0, bg1);
+        if (ym > 0 && yp > 0)
+        {
+            Double_t l0 = TMath::Log(max);
+            Double_t lm = TMath::Log(ym);
+            Double_t lp = TMath::Log(yp);
+            Double_t d = lm - 2*l0 + lp;
+            if (d < 0)
+            {
+                Double_t shift = 0.5*(lm - lp) / d;
+                pos += shift*w;
+                amp = TMath::Exp(l0 + 0.25*(lp - lm)*shift);
+                sigma = w*TMath::Sqrt(-1./d);
+            }
+        }
+    }
+
+    // find the half maximum on both sides
+    Double_t half = 0.5*amp;
+    Double_t xLeft = 0, xRight = 0;
+    Bool_t left = kFALSE, right = kFALSE;
+    for (Int_t i = maxBin - 1; i >= first; i--)
+    {
+        Double_t y = TCFitUtilsNetContent(h, i, bg0, bg1);
+        if (y > half) continue;
+        Double_t y1 = TCFitUtilsNetContent(h, i + 1, bg0, bg1);
+        xLeft = h->GetBinCenter(i) + (half - y) / (y1 - y) * h->GetBinWidth(i);
+        left = kTRUE;
+        break;
+    }
+    for (Int_t i = maxBin + 1; i <= last; i++)
+    {
+        Double_t y = TCFitUtilsNetContent(h, i, bg0, bg1);
+        if (y > half) continue;
+        Double_t y1 = TCFitUtilsNetContent(h, i - 1, bg0, bg1);
+        xRight = h->GetBinCenter(i) - (half - y) / (y1 - y) * h->GetBinWidth(i);
+        right = kTRUE;
+        break;
+    }
+
+    // width from the full width at half maximum
+    if (left && right) sigma = (xRight - xLeft) / (2*TMath::Sqrt(2*TMath::Log(2.)));
+    if (sigma <= 0) return kFALSE;
+
+    // save results
+    *outPos = pos;
+    *outSigma = sigma;
+    *outAmp = amp;
+    if (outBg0) *outBg0 = bg0;
+    if (outBg1) *outBg1 = bg1;
+
+    return kTRUE;
+}
+
@@ -0,0 +1,173 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCHistoRows                                                          //
+//                                                                      //
+// Element rows of a 2D histogram.                                      //
+//                                                                      //
+// The calibration histograms have the detector element on the y-axis   //
+// and the observable on the x-axis. Instead of creating a new          //
+// projection ProjectionX(..., elem+1, elem+1, "e") for every element,  //
+// the histogram is converted once to contiguous rows of contents and   //
+// optionally sums of squares of weights. The rows can be accessed      //
+// directly or copied to newly created or reused 1D histograms. Like    //
+// the projection, the rows contain only the bins in the x-axis range   //
+// of the histogram at the time of the conversion.                      //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include <cstring>
+
+#include "TH2.h"
+#include "TError.h"
+
+#include "TCHistoRows.h"
+
+ClassImp(TCHistoRows)
+
+//______________________________________________________________________________
+TCHistoRows::TCHistoRows(const TH2* h, Bool_t errors)
+{
+    // Constructor converting the 2D histogram 'h' to element rows. The sums of
+    // squares of weights are kept if 'errors' is kTRUE.
+
+    // init members
+    fNRows = 0;
+    fNCells = 0;
+    fContent = 0;
+    fSumw2 = 0;
+    fTemplate = 0;
+
+    // check histogram
+    if (!h) return;
+
+    // get the x-axis range (the rows are cut to it like ProjectionX() does)
+    const TAxis* axis = h->GetXaxis();
+    Int_t nx = h->GetNbinsX();
+    Int_t first = axis->GetFirst();
+    Int_t last = axis->GetLast();
+    Bool_t range = first > 1 || last < nx;
+    Int_t nBins = range ? last - first + 1 : nx;
+
+    // create the axis template (not kept in memory)
+    TString tname = TString::Format("%s_Rows", h->GetName());
+    Bool_t status = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(kFALSE);
+    if (axis->IsVariableBinSize())
+        fTemplate = new TH1D(tname.Data(), h->GetTitle(), nBins, axis->GetXbins()->GetArray() + first - 1);
+    else
+        fTemplate = new TH1D(tname.Data(), h->GetTitle(), nBins, axis->GetBinLowEdge(first), axis->GetBinUpEdge(last));
+    TH1::AddDirectory(status);
+    fTemplate->GetXaxis()->ImportAttributes(axis);
+    fTemplate->GetXaxis()->SetTitle(axis->GetTitle());
+    if (errors) fTemplate->Sumw2();
+
+    // set dimensions
+    fNRows = h->GetNbinsY();
+    fNCells = nBins + 2;
+
+    // create arrays
+    fContent = new Double_t[fNRows*fNCells];
+    memset(fContent, 0, fNRows*fNCells*sizeof(Double_t));
+    Bool_t sumw2 = h->GetSumw2N() != 0;
+    if (errors)
+    {
+        fSumw2 = new Double_t[fNRows*fNCells];
+        memset(fSumw2, 0, fNRows*fNCells*sizeof(Double_t));
+    }
+
+    // cells to copy (under-/overflow stay empty if a range is set)
+    Int_t start = range ? first : 0;
+    Int_t pos = range ? 1 : 0;
+    Int_t nCopy = range ? nBins : fNCells;
+
+    // copy the rows (the cells of a row are contiguous in the histogram)
+    for (Int_t y = 0; y < fNRows; y++)
+    {
+        Int_t offset = (y+1)*(nx+2) + start;
+        Double_t* c = fContent + y*fNCells + pos;
+        for (Int_t x = 0; x < nCopy; x++) c[x] = h->GetBinContent(offset + x);
+        if (fSumw2)
+        {
+            Double_t* w = fSumw2 + y*fNCells + pos;
+            if (sumw2) memcpy(w, h->GetSumw2()->fArray + offset, nCopy*sizeof(Double_t));
+            else memcpy(w, c, nCopy*sizeof(Double_t));
+        }
+    }
+}
+
+//______________________________________________________________________________
+TCHistoRows::~TCHistoRows()
+{
+    // Destructor.
+
+    if (fContent) delete [] fContent;
+    if (fSumw2) delete [] fSumw2;
+    if (fTemplate) delete fTemplate;
+}
+
+//______________________________________________________________________________
+TH1D* TCHistoRows::GetRowHisto(Int_t row, const Char_t* name) const
+{
+    // Return the row 'row' as a 1D histogram named 'name'. This corresponds to
+    // the projection ProjectionX(name, row+1, row+1, "e") of the original
+    // histogram, i.e. only the bins in the x-axis range of the original
+    // histogram are kept. Return 0 if the row does not exist.
+    // NOTE: the histogram is not added to the current directory and has to be
+    //       destroyed by the caller.
+
+    // check row
+    if (row < 0 || row >= fNRows)
+    {
+        Error("GetRowHisto", "Row %d does not exist!", row);
+        return 0;
+    }
+
+    // create the histogram from the axis template
+    Bool_t status = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(kFALSE);
+    TH1D* h = new TH1D(*fTemplate);
+    TH1::AddDirectory(status);
+    h->SetName(name);
+
+    // copy the row
+    FillRowHisto(h, row);
+
+    return h;
+}
+
+//______________________________________________________________________________
+Bool_t TCHistoRows::FillRowHisto(TH1D* h, Int_t row) const
+{
+    // Replace the content of the histogram 'h', which has to have the binning
+    // of the rows, by the row 'row'. Can be used to reuse the same histogram
+    // for several rows. Return kFALSE if the row does not exist or the
+    // binning does not match, otherwise kTRUE.
+
+    // check row and binning
+    if (row < 0 || row >= fNRows || h->GetNcells() != fNCells)
+    {
+        Error("FillRowHisto", "Cannot fill row %d into histogram '%s'!", row, h->GetName());
+        return kFALSE;
+    }
+
+    // copy contents
+    memcpy(h->GetArray(), GetRow(row), fNCells*sizeof(Double_t));
+
+    // copy sums of squares of weights
+    if (h->GetSumw2N())
+    {
+        const Double_t* w = fSumw2 ? GetRowSumw2(row) : GetRow(row);
+        memcpy(h->GetSumw2()->fArray, w, fNCells*sizeof(Double_t));
+    }
+
+    // recalculate statistics
+    h->ResetStats();
+
+    return kTRUE;
+}
+
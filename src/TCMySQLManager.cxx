@@ -14,14 +14,19 @@
 #include <fstream>
 
 #include "THashList.h"
+#include "TNamed.h"
 #include "TError.h"
 #include "TSystem.h"
 #include "TSQLServer.h"
 #include "TSQLRow.h"
 #include "TSQLResult.h"
+#include "TSQLStatement.h"
+#include "THashTable.h"
 #include "TObjArray.h"
 #include "TObjString.h"
 #include "TFile.h"
+#include "TMath.h"
+#include "TStopwatch.h"
 
 #include "TCMySQLManager.h"
 #include "TCReadConfig.h"
@@ -32,6 +37,9 @@
 #include "TCCalibType.h"
 #include "TCBadScRElement.h"
 #include "TCContainer.h"
+#include "TCSetCatalog.h"
+#include "TCQueryStats.h"
+#include "TCBufferedResult.h"
 
 ClassImp(TCMySQLManager)
 
@@ -50,6 +58,29 @@ TCMySQLManager::TCMySQLManager()
     fData->SetOwner(kTRUE);
     fTypes = new THashList();
     fTypes->SetOwner(kTRUE);
+    fSetCatalogs = new THashList();
+    fSetCatalogs->SetOwner(kTRUE);
+    fNRunIndex = 0;
+    fRunIndex = 0;
+    fBulkSize = TCConfig::kBulkInsertSize;
+    fQueryStats = 0;
+    fSlowQuery = 0;
+    fNUnsettled = 0;
+    fParSQL = new THashList();
+    fParSQL->SetOwner(kTRUE);
+
+    // read bulk insert size
+    Int_t bulkSize = TCReadConfig::GetReader()->GetConfigInt("DB.BulkSize");
+    if (bulkSize > 0) fBulkSize = bulkSize;
+
+    // read query instrumentation settings
+    if (TCReadConfig::GetReader()->GetConfigInt("DB.Stats")) SetQueryStats(kTRUE);
+    fSlowQuery = TCReadConfig::GetReader()->GetConfigDouble("DB.SlowQuery");
+    if (TCReadConfig::GetReader()->GetConfig("DB.Stats.File"))
+    {
+        SetQueryStats(kTRUE);
+        atexit(DumpQueryStatsAtExit);
+    }
 
     // read CaLib data
     if (!ReadCaLibData())
@@ -174,6 +205,10 @@ TCMySQLManager::~TCMySQLManager()
     if (fDB) delete fDB;
     if (fData) delete fData;
     if (fTypes) delete fTypes;
+    if (fSetCatalogs) delete fSetCatalogs;
+    if (fRunIndex) delete [] fRunIndex;
+    if (fQueryStats) delete fQueryStats;
+    if (fParSQL) delete fParSQL;
 }
 
 //______________________________________________________________________________
@@ -391,9 +426,10 @@ Bool_t TCMySQLManager::ReadCaLibTypes()
 }
 
 //______________________________________________________________________________
-TSQLResult* TCMySQLManager::SendQuery(const Char_t* query)
+TSQLResult* TCMySQLManager::SendQuery(const Char_t* query, const Char_t* site)
 {
-    // Send a query to the database and return the result.
+    // Send a query to the database and return the result. 'site' is the name
+    // of the calling method used for the query statistics.
 
     // check server connection
     if (!IsConnected())
@@ -403,7 +439,16 @@ TSQLResult* TCMySQLManager::SendQuery(const Char_t* query)
     }
 
     // execute query
-    return fDB->Query(query);
+    if (!IsInstrumented()) return fDB->Query(query);
+
+    // execute query and fetch all rows to time the complete transfer and
+    // to count the rows for all back-ends
+    TStopwatch t;
+    TSQLResult* res = fDB->Query(query);
+    if (res) res = new TCBufferedResult(res);
+    RecordQuery(site, query, 1000.*t.RealTime(), res ? res->GetRowCount() : 0);
+
+    return res;
 }
 
 //______________________________________________________________________________
@@ -472,9 +517,10 @@ TCMySQLManager* TCMySQLManager::GetManager()
 }
 
 //______________________________________________________________________________
-Bool_t TCMySQLManager::SendExec(const Char_t* sql)
+Bool_t TCMySQLManager::SendExec(const Char_t* sql, const Char_t* site)
 {
     // Send the SQL command 'sql' without returned result to the database.
+    // 'site' is the name of the calling method used for the query statistics.
     // Return kTRUE on success, otherwise kFALSE.
 
     // check server connection
@@ -485,7 +531,241 @@ Bool_t TCMySQLManager::SendExec(const Char_t* sql)
     }
 
     // execute command
-    return fDB->Exec(sql);
+    if (!IsInstrumented()) return fDB->Exec(sql);
+
+    // execute and time command
+    TStopwatch t;
+    Bool_t res = fDB->Exec(sql);
+    RecordQuery(site, sql, 1000.*t.RealTime(), 0);
+
+    return res;
+}
+
+//______________________________________________________________________________
+void TCMySQLManager::RecordQuery(const Char_t* site, const Char_t* sql,
+                                 Double_t time, Long64_t rows)
+{
+    // Add the query 'sql' of the call site 'site' that took 'time' milliseconds
+    // and returned 'rows' rows to the query statistics and log it if it was
+    // slower than the slow query threshold.
+
+    // check call site
+    if (!site) site = "unknown";
+
+    // update statistics
+    if (fQueryStats)
+    {
+        TCQueryStats* s = (TCQueryStats*) fQueryStats->FindObject(site);
+        if (!s)
+        {
+            s = new TCQueryStats(site);
+            fQueryStats->Add(s);
+        }
+        s->Fill(time, rows);
+    }
+
+    // slow query log
+    if (fSlowQuery > 0 && time >= fSlowQuery)
+        Warning("RecordQuery", "Slow query in %s (%.1f ms): %.200s", site, time, sql);
+}
+
+//______________________________________________________________________________
+void TCMySQLManager::SetQueryStats(Bool_t s)
+{
+    // Enable/disable the collection of query statistics. Disabling deletes
+    // all collected statistics.
+
+    if (s && !fQueryStats)
+    {
+        fQueryStats = new THashList();
+        fQueryStats->SetOwner(kTRUE);
+    }
+    else if (!s && fQueryStats)
+    {
+        delete fQueryStats;
+        fQueryStats = 0;
+    }
+}
+
+//______________________________________________________________________________
+void TCMySQLManager::ResetQueryStats()
+{
+    // Delete all collected query statistics.
+
+    if (fQueryStats) fQueryStats->Delete();
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::DumpQueryStats(const Char_t* filename, Bool_t json)
+{
+    // Write the collected query statistics as table or as JSON array if 'json'
+    // is kTRUE to the file 'filename' or to the standard output if 'filename'
+    // is 0.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // check statistics
+    if (!fQueryStats)
+    {
+        if (!fSilence) Error("DumpQueryStats", "Query statistics are not enabled!");
+        return kFALSE;
+    }
+
+    // open output
+    FILE* out = stdout;
+    if (filename)
+    {
+        Char_t* fn = gSystem->ExpandPathName(filename);
+        out = fopen(fn, "w");
+        delete fn;
+        if (!out)
+        {
+            if (!fSilence) Error("DumpQueryStats", "Could not open the file '%s'!", filename);
+            return kFALSE;
+        }
+    }
+
+    // sort call sites by total time
+    TList sites;
+    TIter next(fQueryStats);
+    TCQueryStats* s;
+    while ((s = (TCQueryStats*)next())) sites.Add(s);
+    sites.Sort(kSortDescending);
+
+    // write statistics
+    if (json) fprintf(out, "[\n");
+    else fprintf(out, "%s\n", TCQueryStats::GetTableHeader().Data());
+    TIter nextSorted(&sites);
+    Int_t n = 0;
+    while ((s = (TCQueryStats*)nextSorted()))
+    {
+        if (json) fprintf(out, "%s  %s", n ? ",\n" : "", s->GetJSON().Data());
+        else fprintf(out, "%s\n", s->GetTableRow().Data());
+        n++;
+    }
+    if (json) fprintf(out, "\n]\n");
+
+    // close output
+    if (out != stdout) fclose(out);
+    else fflush(out);
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+void TCMySQLManager::DumpQueryStatsAtExit()
+{
+    // Dump the query statistics to the file configured via DB.Stats.File.
+    // Files ending with '.json' are written in JSON format.
+
+    // check manager
+    if (!fgMySQLManager) return;
+
+    // get file
+    TString* f = TCReadConfig::GetReader()->GetConfig("DB.Stats.File");
+    if (!f) return;
+
+    fgMySQLManager->DumpQueryStats(f->Data(), f->EndsWith(".json"));
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::BeginTransaction()
+{
+    // Start a new transaction.
+    // Return kTRUE on success, otherwise kFALSE.
+
+    if (fDBType == kSQLite) return SendExec("BEGIN TRANSACTION", "BeginTransaction");
+    else return SendExec("START TRANSACTION", "BeginTransaction");
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::CommitTransaction()
+{
+    // Commit the current transaction.
+    // Return kTRUE on success, otherwise kFALSE.
+
+    return SendExec("COMMIT", "CommitTransaction");
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::RollbackTransaction()
+{
+    // Roll back the current transaction.
+    // Return kTRUE on success, otherwise kFALSE.
+
+    return SendExec("ROLLBACK", "RollbackTransaction");
+}
+
+//______________________________________________________________________________
+Int_t TCMySQLManager::InsertBulk(const Char_t* method, const Char_t* head,
+                                 Int_t nRows, const TString* rows, Bool_t* outAdded)
+{
+    // Insert the 'nRows' rows 'rows' using the INSERT statement head 'head'
+    // ("INSERT INTO table (columns) VALUES "). Each row has to be formatted
+    // as value list "(value1, value2, ...)".
+    // The rows are inserted by multi-row INSERT statements of at most
+    // fBulkSize rows in one transaction per batch. If a batch fails, it is
+    // rolled back and its rows are inserted one by one to skip the bad rows.
+    // The success of inserting the i-th row is stored in 'outAdded[i]'.
+    // 'method' is used for the user information.
+    // Return the number of inserted rows.
+
+    Int_t nAdded = 0;
+
+    // loop over batches
+    Int_t i = 0;
+    while (i < nRows)
+    {
+        // create multi-row statement of the batch
+        Int_t first = i;
+        TString query(head);
+        query.Append(rows[i++]);
+        while (i < nRows && i - first < fBulkSize &&
+               query.Length() + rows[i].Length() < TCConfig::kBulkInsertMaxLength)
+        {
+            query.Append(", ");
+            query.Append(rows[i++]);
+        }
+
+        // insert the batch
+        Bool_t res = BeginTransaction();
+        if (res) res = SendExec(query.Data(), "InsertBulk");
+        if (res) res = CommitTransaction();
+
+        // check result
+        if (res)
+        {
+            for (Int_t j = first; j < i; j++) outAdded[j] = kTRUE;
+            nAdded += i - first;
+            if (!fSilence) Info(method, "Inserted %d rows", nAdded);
+            continue;
+        }
+
+        // roll back batch
+        RollbackTransaction();
+        if (!fSilence) Warning(method, "Insertion of rows %d to %d failed - inserting rows separately",
+                               first, i-1);
+
+        // insert rows of the batch separately
+        Int_t nBatch = 0;
+        BeginTransaction();
+        for (Int_t j = first; j < i; j++)
+        {
+            TString q(head);
+            q.Append(rows[j]);
+            outAdded[j] = SendExec(q.Data(), "InsertBulk");
+            if (outAdded[j]) nBatch++;
+        }
+
+        // commit separately inserted rows
+        if (CommitTransaction()) nAdded += nBatch;
+        else
+        {
+            RollbackTransaction();
+            for (Int_t j = first; j < i; j++) outAdded[j] = kFALSE;
+        }
+    }
+
+    return nAdded;
 }
 
 //______________________________________________________________________________
@@ -536,7 +816,7 @@ Bool_t TCMySQLManager::SearchRunEntry(Int_t run, const Char_t* name, TString& ou
                name, TCConfig::kCalibMainTableName, run);
 
     // read from database
-    TSQLResult* res = SendQuery(query.Data());
+    TSQLResult* res = SendQuery(query.Data(), "SearchRunEntry");
 
     // check result
     if (!res)
@@ -599,7 +879,7 @@ Bool_t TCMySQLManager::SearchSetEntry(const Char_t* data, const Char_t* calibrat
                name, table, calibration, set);
 
     // read from database
-    TSQLResult* res = SendQuery(query.Data());
+    TSQLResult* res = SendQuery(query.Data(), "SearchSetEntry");
 
     // check result
     if (!res)
@@ -654,7 +934,7 @@ Bool_t TCMySQLManager::ChangeRunEntries(Int_t first_run, Int_t last_run,
                TCConfig::kCalibMainTableName, name, value, first_run, last_run);
 
     // read from database
-    Bool_t res = SendExec(query.Data());
+    Bool_t res = SendExec(query.Data(), "ChangeRunEntries");
 
     // check result
     if (!res)
@@ -698,7 +978,10 @@ Bool_t TCMySQLManager::ChangeSetEntry(const Char_t* data, const Char_t* calibrat
                table, name, value, calibration, first_run);
 
     // read from database
-    Bool_t res = SendExec(query.Data());
+    Bool_t res = SendExec(query.Data(), "ChangeSetEntry");
+
+    // invalidate cached sets
+    InvalidateSetCatalog(data, calibration);
 
     // check result
     if (!res)
@@ -712,52 +995,334 @@ Bool_t TCMySQLManager::ChangeSetEntry(const Char_t* data, const Char_t* calibrat
 }
 
 //______________________________________________________________________________
-Int_t TCMySQLManager::GetNsets(const Char_t* data, const Char_t* calibration)
+TCSetCatalog* TCMySQLManager::GetSetCatalog(const Char_t* data, const Char_t* calibration)
 {
-    // Get the number of runsets for the calibration identifier 'calibration'
-    // and the calibration data 'data'.
+    // Return the catalog of all sets of the calibration data 'data' for the
+    // calibration identifier 'calibration'. The catalog is read from the
+    // database with a single query on first access and kept in memory until
+    // it is invalidated by a modification of the sets.
+    // Return 0 if an error occurred.
 
     TString query;
-    Char_t table[256];
 
-    // check for data
-    if (!GetCalibData(data)) return 0;
+    // look for cached catalog
+    TString key = TString::Format("%s/%s", data, calibration);
+    TCSetCatalog* cat = (TCSetCatalog*) fSetCatalogs->FindObject(key.Data());
+    if (cat) return cat;
 
-    // get the data table
-    if (!SearchTable(data, table))
-    {
-        if (!fSilence) Error("GetNsets", "No data table found!");
-        return 0;
-    }
+    // get data
+    TCCalibData* d = GetCalibData(data);
+    if (!d) return 0;
 
     // create the query
-    query.Form("SELECT first_run FROM %s WHERE "
+    query.Form("SELECT first_run, last_run, changed, description FROM %s WHERE "
                "calibration = '%s' "
                "ORDER BY first_run ASC",
-               table, calibration);
+               d->GetTableName(), calibration);
 
     // read from database
-    TSQLResult* res = SendQuery(query.Data());
+    TSQLResult* res = SendQuery(query.Data(), "GetSetCatalog");
 
     // check result
     if (!res)
     {
-        if (!fSilence) Error("GetNsets", "No runsets found in table '%s'!", table);
+        if (!fSilence) Error("GetSetCatalog", "No runsets found in table '%s'!", d->GetTableName());
         return 0;
     }
 
-    // count rows
-    Int_t rows = 0;
+    // create the catalog
+    cat = new TCSetCatalog(key.Data());
+
+    // read all sets
     TSQLRow* r = res->Next();
     while (r)
     {
-        rows++;
+        cat->AddSet(atoi(r->GetField(0)), atoi(r->GetField(1)),
+                    r->GetField(2), r->GetField(3));
         delete r;
         r = res->Next();
     }
     delete res;
 
-    return rows;
+    // add catalog to cache
+    fSetCatalogs->Add(cat);
+
+    return cat;
+}
+
+//______________________________________________________________________________
+void TCMySQLManager::InvalidateSetCatalog(const Char_t* data, const Char_t* calibration)
+{
+    // Remove the cached set catalog of the calibration data 'data' for the
+    // calibration identifier 'calibration'.
+
+    TString key = TString::Format("%s/%s", data, calibration);
+    TObject* cat = fSetCatalogs->FindObject(key.Data());
+    if (cat)
+    {
+        fSetCatalogs->Remove(cat);
+        delete cat;
+    }
+}
+
+//______________________________________________________________________________
+void TCMySQLManager::InvalidateSetCatalogs()
+{
+    // Remove all cached set catalogs.
+
+    fSetCatalogs->Delete();
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::LoadRunIndex()
+{
+    // Read the sorted list of all run numbers from the database using a single
+    // query if it is not cached yet.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    TString query;
+
+    // check cache
+    if (fRunIndex) return kTRUE;
+
+    // create the query
+    query.Form("SELECT run FROM %s "
+               "ORDER by run",
+               TCConfig::kCalibMainTableName);
+
+    // read from database
+    TSQLResult* res = SendQuery(query.Data(), "LoadRunIndex");
+
+    // check result
+    if (!res)
+    {
+        if (!fSilence) Error("LoadRunIndex", "Could not read the run numbers!");
+        return kFALSE;
+    }
+
+    // read all rows/runs
+    Int_t n = 0;
+    Int_t size = 256;
+    Int_t* runs = new Int_t[size];
+    TSQLRow* r = res->Next();
+    while (r)
+    {
+        // enlarge array if necessary
+        if (n == size)
+        {
+            Int_t* tmp = new Int_t[2*size];
+            for (Int_t i = 0; i < n; i++) tmp[i] = runs[i];
+            delete [] runs;
+            runs = tmp;
+            size *= 2;
+        }
+
+        // save run number
+        runs[n++] = atoi(r->GetField(0));
+
+        delete r;
+        r = res->Next();
+    }
+    delete res;
+
+    // set the index
+    fNRunIndex = n;
+    fRunIndex = runs;
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+void TCMySQLManager::InvalidateRunIndex()
+{
+    // Remove the cached run index.
+
+    if (fRunIndex) delete [] fRunIndex;
+    fRunIndex = 0;
+    fNRunIndex = 0;
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::HasRun(Int_t run)
+{
+    // Check if the run 'run' exists in the database using the cached run index.
+
+    // load run index
+    if (!LoadRunIndex()) return kFALSE;
+
+    // look for run
+    Long64_t i = TMath::BinarySearch((Long64_t)fNRunIndex, fRunIndex, run);
+    if (i >= 0 && fRunIndex[i] == run) return kTRUE;
+    else return kFALSE;
+}
+
+//______________________________________________________________________________
+void TCMySQLManager::ClearCache()
+{
+    // Clear all cached set catalogs and the run index. This has to be called
+    // when the database was modified by somebody else while this manager
+    // is in use.
+
+    InvalidateSetCatalogs();
+    InvalidateRunIndex();
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::GetChangeStamps(Int_t nTable, const Char_t** tables, TString* outStamps)
+{
+    // Read the change stamps of the 'nTable' tables 'tables' to 'outStamps' using
+    // a single query. The stamp of a table consists of the latest change time
+    // and the number of rows and changes whenever a row is added, modified
+    // or removed.
+    // The change times have a resolution of one second, so further changes
+    // within the second of the latest change would not alter the stamp. Stamps
+    // read within that second are therefore marked as unsettled by a unique
+    // suffix and never compare equal to any other stamp.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // check number of tables
+    if (nTable <= 0) return kTRUE;
+
+    // create the query
+    TString query;
+    for (Int_t i = 0; i < nTable; i++)
+    {
+        if (i) query.Append(" UNION ALL ");
+        query.Append(TString::Format("SELECT %d, MAX(changed), COUNT(*), CURRENT_TIMESTAMP FROM %s", i, tables[i]));
+    }
+
+    // read from database
+    TSQLResult* res = SendQuery(query.Data(), "GetChangeStamps");
+
+    // check result
+    if (!res)
+    {
+        if (!fSilence) Error("GetChangeStamps", "Could not read the change stamps!");
+        return kFALSE;
+    }
+
+    // read the stamps
+    for (Int_t i = 0; i < nTable; i++) outStamps[i] = "";
+    TSQLRow* row;
+    while ((row = res->Next()))
+    {
+        Int_t id = atoi(row->GetField(0));
+        if (id >= 0 && id < nTable)
+        {
+            const Char_t* changed = row->GetField(1) ? row->GetField(1) : "";
+            const Char_t* now = row->GetField(3) ? row->GetField(3) : "";
+            outStamps[id] = TString::Format("%s/%s", changed, row->GetField(2));
+
+            // mark stamps of tables changed in the current second as unsettled
+            if (*changed && strcmp(changed, now) >= 0)
+                outStamps[id].Append(TString::Format("/unsettled-%lld", ++fNUnsettled));
+        }
+        delete row;
+    }
+    delete res;
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+TSQLStatement* TCMySQLManager::CreateParStatement(const Char_t* op, const Char_t* table,
+                                                  Int_t length)
+{
+    // Return a new prepared statement of the operation 'op' ("SELECT", "UPDATE"
+    // or "INSERT") on 'length' parameters of the data table 'table'. The
+    // statement is prepared per call because a TSQLStatement cannot be
+    // executed again after Process(). The SQL text is built only once per
+    // operation, table and length and cached. The returned statement is ready
+    // for binding the parameters:
+    //   SELECT : calibration, first_run
+    //   UPDATE : par_000..par_<length-1>, calibration, first_run
+    //   INSERT : calibration, description, first_run, last_run, par_000..par_<length-1>
+    // The statement has to be destroyed by the caller.
+    // Return 0 if an error occurred.
+
+    // check server connection
+    if (!IsConnected())
+    {
+        if (!fSilence) Error("CreateParStatement", "No connection to the database!");
+        return 0;
+    }
+
+    // look up the cached SQL statement
+    TString key = TString::Format("%s:%s:%d", op, table, length);
+    TNamed* cached = (TNamed*) fParSQL->FindObject(key.Data());
+
+    // create the SQL statement
+    TString sql;
+    if (cached) sql = cached->GetTitle();
+    else if (!strcmp(op, "SELECT"))
+    {
+        sql = "SELECT ";
+        for (Int_t j = 0; j < length; j++)
+            sql.Append(TString::Format(j ? ", par_%03d" : "par_%03d", j));
+        sql.Append(TString::Format(" FROM %s WHERE calibration = ? AND first_run = ?", table));
+    }
+    else if (!strcmp(op, "UPDATE"))
+    {
+        sql.Form("UPDATE %s SET ", table);
+        for (Int_t j = 0; j < length; j++)
+            sql.Append(TString::Format(j ? ", par_%03d = ?" : "par_%03d = ?", j));
+        sql.Append(" WHERE calibration = ? AND first_run = ?");
+    }
+    else if (!strcmp(op, "INSERT"))
+    {
+        sql.Form("INSERT INTO %s (calibration, description, first_run, last_run", table);
+        for (Int_t j = 0; j < length; j++) sql.Append(TString::Format(", par_%03d", j));
+        sql.Append(") VALUES (?, ?, ?, ?");
+        for (Int_t j = 0; j < length; j++) sql.Append(", ?");
+        sql.Append(")");
+    }
+    else
+    {
+        if (!fSilence) Error("CreateParStatement", "Unknown operation '%s'!", op);
+        return 0;
+    }
+
+    // cache the SQL statement
+    if (!cached) fParSQL->Add(new TNamed(key.Data(), sql.Data()));
+
+    // prepare the statement
+    TSQLStatement* stmt = fDB->Statement(sql.Data());
+    if (!stmt)
+    {
+        if (!fSilence) Error("CreateParStatement", "Could not prepare statement for table '%s'!", table);
+        return 0;
+    }
+
+    // start the execution
+    if (!stmt->NextIteration())
+    {
+        if (!fSilence) Error("CreateParStatement", "Could not prepare statement for table '%s'!", table);
+        delete stmt;
+        return 0;
+    }
+
+    return stmt;
+}
+
+//______________________________________________________________________________
+Int_t TCMySQLManager::GetNsets(const Char_t* data, const Char_t* calibration)
+{
+    // Get the number of runsets for the calibration identifier 'calibration'
+    // and the calibration data 'data'.
+
+    // check for data
+    if (!GetCalibData(data)) return 0;
+
+    // get the set catalog
+    TCSetCatalog* cat = GetSetCatalog(data, calibration);
+    if (!cat)
+    {
+        if (!fSilence) Error("GetNsets", "No runsets found for '%s' in calibration '%s'!",
+                             data, calibration);
+        return 0;
+    }
+
+    return cat->GetNsets();
 }
 
 //______________________________________________________________________________
@@ -766,13 +1331,12 @@ Int_t TCMySQLManager::GetFirstRunOfSet(const Char_t* data, const Char_t* calibra
     // Get the first run of the runsets 'set' for the calibration identifier
     // 'calibration' and the calibration data 'data'.
 
-    Char_t tmp[256];
-
     // check for data
     if (!GetCalibData(data)) return 0;
 
     // get the data
-    if (SearchSetEntry(data, calibration, set, "first_run", tmp)) return atoi(tmp);
+    TCSetCatalog* cat = GetSetCatalog(data, calibration);
+    if (cat && cat->IsValidSet(set)) return cat->GetFirstRun(set);
     else
     {
         if (!fSilence) Error("GetFirstRunOfSet", "Could not find first run of set!");
@@ -786,13 +1350,12 @@ Int_t TCMySQLManager::GetLastRunOfSet(const Char_t* data, const Char_t* calibrat
     // Get the last run of the runsets 'set' for the calibration identifier
     // 'calibration' and the calibration data 'data'.
 
-    Char_t tmp[256];
-
     // check for data
     if (!GetCalibData(data)) return 0;
 
     // get the data
-    if (SearchSetEntry(data, calibration, set, "last_run", tmp)) return atoi(tmp);
+    TCSetCatalog* cat = GetSetCatalog(data, calibration);
+    if (cat && cat->IsValidSet(set)) return cat->GetLastRun(set);
     else
     {
         if (!fSilence) Error("GetLastRunOfSet", "Could not find last run of set!");
@@ -807,13 +1370,12 @@ void TCMySQLManager::GetDescriptionOfSet(const Char_t* data, const Char_t* calib
     // Get the description of the runsets 'set' for the calibration identifier
     // 'calibration' and the calibration data 'data'.
 
-    Char_t tmp[256];
-
     // check for data
     if (!GetCalibData(data)) return;
 
     // get the data
-    if (SearchSetEntry(data, calibration, set, "description", tmp)) strcpy(outDesc, tmp);
+    TCSetCatalog* cat = GetSetCatalog(data, calibration);
+    if (cat && cat->IsValidSet(set)) strcpy(outDesc, cat->GetDescription(set));
     else
     {
         if (!fSilence) Error("GetDescriptionOfSet", "Could not find description of set!");
@@ -827,13 +1389,12 @@ void TCMySQLManager::GetChangeTimeOfSet(const Char_t* data, const Char_t* calibr
     // Get the change time of the runsets 'set' for the calibration identifier
     // 'calibration' and the calibration data 'data'.
 
-    Char_t tmp[256];
-
     // check for data
     if (!GetCalibData(data)) return;
 
     // get the data
-    if (SearchSetEntry(data, calibration, set, "changed", tmp)) strcpy(outTime, tmp);
+    TCSetCatalog* cat = GetSetCatalog(data, calibration);
+    if (cat && cat->IsValidSet(set)) strcpy(outTime, cat->GetChangeTime(set));
     else
     {
         if (!fSilence) Error("GetChangeTimeOfSet", "Could not find change time of set!");
@@ -910,7 +1471,6 @@ Int_t* TCMySQLManager::GetRunsOfSet(const Char_t* data, const Char_t* calibratio
     // If 'outNruns' is not zero the number of runs will be written to this variable.
     // NOTE: the run array must be destroyed by the caller.
 
-    TString query;
     // check for data
     if (!GetCalibData(data)) return 0;
 
@@ -929,47 +1489,26 @@ Int_t* TCMySQLManager::GetRunsOfSet(const Char_t* data, const Char_t* calibratio
     // get all the runs that lie between first and last run
     //
 
-    // create the query
-    query.Form("SELECT run FROM %s "
-               "WHERE run >= %d "
-               "AND run <= %d "
-               "ORDER by run,time",
-               TCConfig::kCalibMainTableName, first_run, last_run);
-
-    // read from database
-    TSQLResult* res = SendQuery(query.Data());
-
-    // create list for run numbers
-    TList run_numbers;
-    run_numbers.SetOwner(kTRUE);
-
-    // read all rows/runs
-    TSQLRow* r = res->Next();
-    while (r)
+    // load the run index
+    if (!LoadRunIndex())
     {
-        run_numbers.Add(new TObjString(r->GetField(0)));
-        delete r;
-        r = res->Next();
+        if (!fSilence) Error("GetRunsOfSet", "Could not find runs of set %d!", set);
+        return 0;
     }
 
-    // get number of runs
-    Int_t nruns = run_numbers.GetSize();
+    // find the first run of the set in the index
+    Long64_t start = TMath::BinarySearch((Long64_t)fNRunIndex, fRunIndex, first_run);
+    if (start < 0 || fRunIndex[start] != first_run) start++;
+
+    // count the runs of the set
+    Int_t nruns = 0;
+    while (start + nruns < fNRunIndex && fRunIndex[start + nruns] <= last_run) nruns++;
 
     // create run array
     Int_t* runs = new Int_t[nruns];
 
     // read all runs
-    for (Int_t i = 0; i < nruns; i++)
-    {
-        // get next run
-        TObjString* rn = (TObjString*) run_numbers.At(i);
-
-        // save run number
-        runs[i] = atoi(rn->GetString().Data());
-    }
-
-    // clean-up
-    delete res;
+    for (Int_t i = 0; i < nruns; i++) runs[i] = fRunIndex[start + i];
 
     // write number of runs
     if (outNruns) *outNruns = nruns;
@@ -987,31 +1526,19 @@ Int_t TCMySQLManager::GetSetForRun(const Char_t* data, const Char_t* calibration
     // check for data
     if (!GetCalibData(data)) return -1;
 
-    // get number of sets
-    Int_t nSet = GetNsets(data, calibration);
-    if (!nSet) return -1;
+    // get the set catalog
+    TCSetCatalog* cat = GetSetCatalog(data, calibration);
+    if (!cat || !cat->GetNsets()) return -1;
 
     // check if run exists
-    TString tmp;
-    if (!SearchRunEntry(run, "run", tmp))
+    if (!HasRun(run))
     {
         if (!fSilence) Error("GetSetForRun", "Run has no valid run number!");
         return -1;
     }
 
-    // loop over sets
-    for (Int_t i = 0; i < nSet; i++)
-    {
-        // get first and last run
-        Int_t first_run = GetFirstRunOfSet(data, calibration, i);
-        Int_t last_run = GetLastRunOfSet(data, calibration, i);
-
-        // check if run is in this set
-        if (run >= first_run && run <= last_run) return i;
-    }
-
-    // no set found here
-    return -1;
+    // look up the set in the interval index
+    return cat->FindSet(run);
 }
 
 //______________________________________________________________________________
@@ -1041,6 +1568,149 @@ Bool_t TCMySQLManager::ReadParametersRun(const Char_t* data, const Char_t* calib
     return ReadParameters(data, calibration, set, par, length);
 }
 
+//______________________________________________________________________________
+Bool_t TCMySQLManager::ReadParametersRunMulti(Int_t nData, const Char_t** data,
+                                              const Char_t* calibration, Int_t run,
+                                              Double_t** par, Int_t* length,
+                                              Bool_t* outRead)
+{
+    // Read the parameters of the 'nData' calibration data 'data' for the
+    // calibration identifier 'calibration' valid for the run 'run' from the
+    // database. 'length[i]' parameters of the data 'data[i]' are written to
+    // the value array 'par[i]'.
+    // The sets are resolved once using the cached set catalogs and the values
+    // of all data having the same number of parameters are read using a single
+    // query. If 'outRead' is not zero, the success of reading the i-th data is
+    // stored in 'outRead[i]'.
+    // Return kTRUE if all data were read, otherwise kFALSE.
+
+    // init read flags
+    if (outRead)
+        for (Int_t i = 0; i < nData; i++) outRead[i] = kFALSE;
+
+    // check number of data
+    if (nData <= 0) return kFALSE;
+
+    // check if run exists
+    if (!HasRun(run))
+    {
+        if (!fSilence) Error("ReadParametersRunMulti", "Run has no valid run number!");
+        return kFALSE;
+    }
+
+    // resolve the first run of the set of each data
+    Int_t first_run[nData];
+    Bool_t done[nData];
+    for (Int_t i = 0; i < nData; i++)
+    {
+        // init
+        first_run[i] = 0;
+        done[i] = kTRUE;
+
+        // get data
+        TCCalibData* d = GetCalibData(data[i]);
+        if (!d) continue;
+
+        // check the number of parameters
+        if (length[i] <= 0 || length[i] > d->GetSize())
+        {
+            if (!fSilence) Error("ReadParametersRunMulti", "Cannot read %d parameters of '%s' having %d parameters!",
+                                 length[i], d->GetTitle(), d->GetSize());
+            continue;
+        }
+
+        // get the set
+        TCSetCatalog* cat = GetSetCatalog(data[i], calibration);
+        Int_t set = cat ? cat->FindSet(run) : -1;
+
+        // check set
+        if (set == -1)
+        {
+            if (!fSilence) Error("ReadParametersRunMulti", "No set of '%s' found for run %d",
+                                 d->GetTitle(), run);
+            continue;
+        }
+
+        // mark data as to be read
+        first_run[i] = cat->GetFirstRun(set);
+        done[i] = kFALSE;
+    }
+
+    // read all data having the same number of parameters in one query
+    Int_t nRead = 0;
+    for (Int_t i = 0; i < nData; i++)
+    {
+        // skip data already processed
+        if (done[i]) continue;
+
+        // create the query for all data of this length
+        TString query;
+        for (Int_t j = i; j < nData; j++)
+        {
+            // skip data already processed or having another length
+            if (done[j] || length[j] != length[i]) continue;
+
+            // combine selections
+            if (query.Length()) query.Append(" UNION ALL ");
+
+            // add selection of this data
+            query.Append(TString::Format("SELECT %d", j));
+            for (Int_t k = 0; k < length[j]; k++) query.Append(TString::Format(", par_%03d", k));
+            query.Append(TString::Format(" FROM %s WHERE "
+                                         "calibration = '%s' AND "
+                                         "first_run = %d",
+                                         GetCalibData(data[j])->GetTableName(),
+                                         calibration, first_run[j]));
+
+            // mark data as processed
+            done[j] = kTRUE;
+        }
+
+        // read from database
+        TSQLResult* res = SendQuery(query.Data(), "ReadParametersRunMulti");
+
+        // check result
+        if (!res)
+        {
+            if (!fSilence) Error("ReadParametersRunMulti", "Could not read the parameters of run %d!", run);
+            continue;
+        }
+
+        // loop over rows (data index in field 0, parameters start at field 1)
+        TSQLRow* row;
+        while ((row = res->Next()))
+        {
+            // get the data index
+            Int_t idx = atoi(row->GetField(0));
+
+            // check the data index and the number of values
+            if (idx < 0 || idx >= nData || res->GetFieldCount() != length[idx]+1)
+            {
+                if (!fSilence) Error("ReadParametersRunMulti", "Unexpected row of data %d read for run %d!", idx, run);
+                delete row;
+                continue;
+            }
+
+            // read the parameters
+            for (Int_t k = 0; k < length[idx]; k++) par[idx][k] = atof(row->GetField(k+1));
+            if (outRead) outRead[idx] = kTRUE;
+            nRead++;
+
+            // user information
+            if (!fSilence) Info("ReadParametersRunMulti", "Read %d parameters of '%s' from the database",
+                                length[idx], GetCalibData(data[idx])->GetTitle());
+
+            // clean-up
+            delete row;
+        }
+
+        // clean-up
+        delete res;
+    }
+
+    return nRead == nData ? kTRUE : kFALSE;
+}
+
 //______________________________________________________________________________
 Bool_t TCMySQLManager::ReadParameters(const Char_t* data, const Char_t* calibration, Int_t set,
                                       Double_t* par, Int_t length)
@@ -1049,7 +1719,6 @@ Bool_t TCMySQLManager::ReadParameters(const Char_t* data, const Char_t* calibrat
     // for the calibration identifier 'calibration' from the database to the value array 'par'.
     // Return kFALSE if an error occurred, otherwise kTRUE.
 
-    TString query;
     Char_t table[256];
 
     // get data
@@ -1074,40 +1743,36 @@ Bool_t TCMySQLManager::ReadParameters(const Char_t* data, const Char_t* calibrat
         return kFALSE;
     }
 
-    // create the query
-    query.Form("SELECT * FROM %s WHERE "
-               "calibration = '%s' AND "
-               "first_run = %d",
-               table, calibration, first_run);
+    // prepare the statement
+    TSQLStatement* stmt = CreateParStatement("SELECT", table, length);
 
-    // read from database
-    TSQLResult* res = SendQuery(query.Data());
+    // bind the set and read from database
+    TStopwatch t;
+    Bool_t res = stmt &&
+                 stmt->SetString(0, calibration, 256) &&
+                 stmt->SetInt(1, first_run) &&
+                 stmt->Process() &&
+                 stmt->StoreResult();
 
-    // check result
-    if (!res)
-    {
-        if (!fSilence) Error("ReadParameters", "No calibration found for set %d of '%s'!",
-                             set, d->GetTitle());
-        return kFALSE;
-    }
-
-    // get data (parameters start at field 5)
-    TSQLRow* row = res->Next();
+    // get data
+    Bool_t row = res && stmt->NextResultRow();
+    if (row)
+        for (Int_t i = 0; i < length; i++) par[i] = stmt->GetDouble(i);
+    if (IsInstrumented())
+        RecordQuery("ReadParameters", TString::Format("SELECT (prepared) FROM %s", table).Data(),
+                    1000.*t.RealTime(), row ? 1 : 0);
 
-    // check row
+    // check result
     if (!row)
     {
         if (!fSilence) Error("ReadParameters", "No calibration found for set %d of '%s'!",
                              set, d->GetTitle());
-        delete res;
+        if (stmt) delete stmt;
         return kFALSE;
     }
 
-    for (Int_t i = 0; i < length; i++) par[i] = atof(row->GetField(i+5));
-
     // clean-up
-    delete row;
-    delete res;
+    delete stmt;
 
     // user information
     if (!fSilence) Info("ReadParameters", "Read %d parameters of '%s' from the database",
@@ -1148,23 +1813,27 @@ Bool_t TCMySQLManager::WriteParameters(const Char_t* data, const Char_t* calibra
         return kFALSE;
     }
 
-    // prepare the insert query
-    TString query = TString::Format("UPDATE %s SET ", table);
-
-    // read all parameters and write them to new query
-    for (Int_t j = 0; j < length; j++)
-    {
-        // append parameter to query
-        query.Append(TString::Format("par_%03d = %.17g", j, par[j]));
-        if (j != length - 1) query.Append(",");
-    }
+    // prepare the statement
+    TSQLStatement* stmt = CreateParStatement("UPDATE", table, length);
 
-    // finish query
-    query.Append(TString::Format(" WHERE calibration = '%s' AND first_run = %d",
-                                 calibration, first_run));
+    // bind all parameters and the set
+    Bool_t res = stmt ? kTRUE : kFALSE;
+    for (Int_t j = 0; res && j < length; j++) res = stmt->SetDouble(j, par[j]);
+    if (res) res = stmt->SetString(length, calibration, 256);
+    if (res) res = stmt->SetInt(length+1, first_run);
 
     // write data to database
-    Bool_t res = SendExec(query.Data());
+    TStopwatch t;
+    if (res) res = stmt->Process();
+    if (IsInstrumented())
+        RecordQuery("WriteParameters", TString::Format("UPDATE (prepared) %s", table).Data(),
+                    1000.*t.RealTime(), 0);
+
+    // clean-up
+    if (stmt) delete stmt;
+
+    // invalidate cached sets (change time)
+    InvalidateSetCatalog(data, calibration);
 
     // check result
     if (!res)
@@ -1334,7 +2003,7 @@ Bool_t TCMySQLManager::UpgradeDatabase(Int_t version)
     for (Int_t i = 0; i < nQuery; i++)
     {
         // send query
-        Bool_t res = SendExec(query[i]);
+        Bool_t res = SendExec(query[i], "UpgradeDatabase");
 
         // check result
         if (!res) Error("UpgradeDatabase", "Could not execute query %d!", i+1);
@@ -1371,7 +2040,7 @@ Bool_t TCMySQLManager::AddNewDataTable(const Char_t* data)
     if (!d) return kFALSE;
 
     // check if table exists already
-    if (SendExec(TString::Format("SELECT 1 from %s LIMIT 1", d->GetTableName())))
+    if (SendExec(TString::Format("SELECT 1 from %s LIMIT 1", d->GetTableName()), "AddNewDataTable"))
     {
         if (!fSilence) Error("AddNewDataTable", "Data table for '%s' exists already!", data);
         return kFALSE;
@@ -1462,8 +2131,14 @@ void TCMySQLManager::AddRunFiles(const Char_t* path, const Char_t* target,
         return;
     }
 
+    // prepare the insert statement head
+    TString ins_head = TString::Format("INSERT INTO %s (run, path, filename, time, description, run_note, size, target) "
+                                       "VALUES ",
+                                       TCConfig::kCalibMainTableName);
+
     // loop over runs
-    Int_t nRunAdded = 0;
+    TString* rows = new TString[nRun];
+    Bool_t* added = new Bool_t[nRun];
     for (Int_t i = 0; i < nRun; i++)
     {
         TCACQUFile* f = r.GetFile(i);
@@ -1472,40 +2147,47 @@ void TCMySQLManager::AddRunFiles(const Char_t* path, const Char_t* target,
         strptime(f->GetTime(), "%a %b %d %H:%M:%S %Y", &tm);
         strftime(time, sizeof(time), "%Y-%m-%d %H:%M:%S", &tm);
 
-        // prepare the insert query
-        TString ins_query = TString::Format("INSERT INTO %s (run, path, filename, time, description, run_note, size, target) "
-                                            "VALUES ( "
-                                            "%d, "
-                                            "\"%s\", "
-                                            "\"%s\", "
-                                            "\"%s\", "
-                                            "\"%s\", "
-                                            "\"%s\", "
-                                            "%lld, "
-                                            "\"%s\" )",
-                                            TCConfig::kCalibMainTableName,
-                                            f->GetRun(),
-                                            path,
-                                            f->GetFileName(),
-                                            time,
-                                            f->GetDescription(),
-                                            f->GetRunNote(),
-                                            f->GetSize(),
-                                            target);
-
-        // try to write data to database
-        Bool_t res = SendExec(ins_query.Data());
-        if (!res)
+        // prepare the row
+        rows[i].Form("( "
+                     "%d, "
+                     "\"%s\", "
+                     "\"%s\", "
+                     "\"%s\", "
+                     "\"%s\", "
+                     "\"%s\", "
+                     "%lld, "
+                     "\"%s\" )",
+                     f->GetRun(),
+                     path,
+                     f->GetFileName(),
+                     time,
+                     f->GetDescription(),
+                     f->GetRunNote(),
+                     f->GetSize(),
+                     target);
+    }
+
+    // try to write data to database
+    Int_t nRunAdded = InsertBulk("AddRunFiles", ins_head.Data(), nRun, rows, added);
+
+    // report failed runs
+    for (Int_t i = 0; i < nRun; i++)
+    {
+        if (!added[i])
         {
+            TCACQUFile* f = r.GetFile(i);
             Warning("AddRunFiles", "Run %d of file '%s/%s' could not be added to the database!",
                     f->GetRun(), path, f->GetFileName());
         }
-        else
-        {
-            nRunAdded++;
-        }
     }
 
+    // clean-up
+    delete [] rows;
+    delete [] added;
+
+    // invalidate cached run numbers
+    InvalidateRunIndex();
+
     // user information
     if (!fSilence) Info("AddRunFiles", "Added %d runs to the database", nRunAdded);
 }
@@ -1534,7 +2216,11 @@ void TCMySQLManager::AddRun(Int_t run, const Char_t* target, const Char_t* desc)
                                         t);
 
     // try to write data to database
-    Bool_t res = SendExec(ins_query.Data());
+    Bool_t res = SendExec(ins_query.Data(), "AddRun");
+
+    // invalidate cached run numbers
+    InvalidateRunIndex();
+
     if (!res)
     {
         if (!fSilence) Warning("AddRun", "Run %d could not be added to the database!", run);
@@ -1784,7 +2470,11 @@ Bool_t TCMySQLManager::ChangeCalibrationName(const Char_t* calibration, const Ch
                    d->GetTableName(), newCalibration, calibration);
 
         // read from database
-        Bool_t res = SendExec(query.Data());
+        Bool_t res = SendExec(query.Data(), "ChangeCalibrationName");
+
+        // invalidate cached sets
+        InvalidateSetCatalog(d->GetName(), calibration);
+        InvalidateSetCatalog(d->GetName(), newCalibration);
 
         // check result
         if (!res)
@@ -1834,7 +2524,10 @@ Bool_t TCMySQLManager::ChangeCalibrationDescription(const Char_t* calibration, c
                    d->GetTableName(), newDesc, calibration);
 
         // read from database
-        Bool_t res = SendExec(query.Data());
+        Bool_t res = SendExec(query.Data(), "ChangeCalibrationDescription");
+
+        // invalidate cached sets
+        InvalidateSetCatalog(d->GetName(), calibration);
 
         // check result
         if (!res)
@@ -1924,7 +2617,10 @@ Bool_t TCMySQLManager::ChangeCalibrationRunRange(const Char_t* calibration, cons
             // execute the query
             query.Form("UPDATE %s SET first_run = %d WHERE calibration = '%s' and first_run = %d",
                        d->GetTableName(), firstRun, calibration, oldFirstRun);
-            Bool_t res = SendExec(query.Data());
+            Bool_t res = SendExec(query.Data(), "ChangeCalibrationRunRange");
+
+            // invalidate cached sets
+            InvalidateSetCatalog(d->GetName(), calibration);
 
             // check result
             if (!res)
@@ -1947,7 +2643,10 @@ Bool_t TCMySQLManager::ChangeCalibrationRunRange(const Char_t* calibration, cons
             // execute the query
             query.Form("UPDATE %s SET last_run = %d WHERE calibration = '%s' and last_run = %d",
                        d->GetTableName(), lastRun, calibration, oldLastRun);
-            Bool_t res = SendExec(query.Data());
+            Bool_t res = SendExec(query.Data(), "ChangeCalibrationRunRange");
+
+            // invalidate cached sets
+            InvalidateSetCatalog(d->GetName(), calibration);
 
             // check result
             if (!res)
@@ -1995,7 +2694,10 @@ Bool_t TCMySQLManager::RemoveCalibration(const Char_t* calibration, const Char_t
                d->GetTableName(), calibration);
 
     // read from database
-    Bool_t res = SendExec(query.Data());
+    Bool_t res = SendExec(query.Data(), "RemoveCalibration");
+
+    // invalidate cached sets
+    InvalidateSetCatalog(data, calibration);
 
     // check result
     if (!res)
@@ -2204,23 +2906,24 @@ void TCMySQLManager::CreateMainTable()
     if (!fSilence) Info("CreateMainTable", "Creating main CaLib table");
 
     // delete the old table if it exists
-    SendExec(TString::Format("DROP TABLE IF EXISTS %s", TCConfig::kCalibMainTableName).Data());
+    SendExec(TString::Format("DROP TABLE IF EXISTS %s", TCConfig::kCalibMainTableName).Data(), "CreateMainTable");
+    InvalidateRunIndex();
 
     // create the table
     SendExec(TString::Format("CREATE TABLE %s ( %s )",
-                             TCConfig::kCalibMainTableName, TCConfig::kCalibMainTableFormat).Data());
+                             TCConfig::kCalibMainTableName, TCConfig::kCalibMainTableFormat).Data(), "CreateMainTable");
 
     // add timestamp update mechanism
     if (fDBType == kMySQL)
     {
-        SendExec(TString::Format("ALTER TABLE %s DROP changed", TCConfig::kCalibMainTableName).Data());
+        SendExec(TString::Format("ALTER TABLE %s DROP changed", TCConfig::kCalibMainTableName).Data(), "CreateMainTable");
         SendExec(TString::Format("ALTER TABLE %s ADD changed TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP "
-                                 "ON UPDATE CURRENT_TIMESTAMP", TCConfig::kCalibMainTableName).Data());
+                                 "ON UPDATE CURRENT_TIMESTAMP", TCConfig::kCalibMainTableName).Data(), "CreateMainTable");
     }
     else if (fDBType == kSQLite)
     {
         // delete the old timestamp update trigger if it exists
-        SendExec(TString::Format("DROP TRIGGER IF EXISTS timestamp_update_%s", TCConfig::kCalibMainTableName).Data());
+        SendExec(TString::Format("DROP TRIGGER IF EXISTS timestamp_update_%s", TCConfig::kCalibMainTableName).Data(), "CreateMainTable");
 
         // create the timestamp update trigger
         SendExec(TString::Format("CREATE TRIGGER after_%s_update "
@@ -2231,7 +2934,7 @@ void TCMySQLManager::CreateMainTable()
                                  "BEGIN "
                                  "UPDATE %s SET changed = CURRENT_TIMESTAMP WHERE run = OLD.run; "
                                  "END",
-                                 TCConfig::kCalibMainTableName, TCConfig::kCalibMainTableName, TCConfig::kCalibMainTableName).Data());
+                                 TCConfig::kCalibMainTableName, TCConfig::kCalibMainTableName, TCConfig::kCalibMainTableName).Data(), "CreateMainTable");
     }
 }
 
@@ -2255,7 +2958,8 @@ Bool_t TCMySQLManager::CreateDataTable(const Char_t* data, Int_t nElem)
     if (!fSilence) Info("CreateDataTable", "Adding data table '%s' for %d elements", table, nElem);
 
     // delete the old table if it exists
-    SendExec(TString::Format("DROP TABLE IF EXISTS %s", table));
+    SendExec(TString::Format("DROP TABLE IF EXISTS %s", table), "CreateDataTable");
+    InvalidateSetCatalogs();
 
     // prepare CREATE TABLE query
     TString query;
@@ -2273,7 +2977,7 @@ Bool_t TCMySQLManager::CreateDataTable(const Char_t* data, Int_t nElem)
     query.Append(" )");
 
     // submit the query
-    if (!SendExec(query.Data()))
+    if (!SendExec(query.Data(), "CreateDataTable"))
     {
         if (!fSilence) Error("CreateDataTable", "An error occurred during data table creation for '%s'!", data);
         return kFALSE;
@@ -2282,14 +2986,14 @@ Bool_t TCMySQLManager::CreateDataTable(const Char_t* data, Int_t nElem)
     // add timestamp update mechanism
     if (fDBType == kMySQL)
     {
-        SendExec(TString::Format("ALTER TABLE %s DROP changed", table).Data());
+        SendExec(TString::Format("ALTER TABLE %s DROP changed", table).Data(), "CreateDataTable");
         SendExec(TString::Format("ALTER TABLE %s ADD changed TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP "
-                                 "ON UPDATE CURRENT_TIMESTAMP AFTER last_run", table).Data());
+                                 "ON UPDATE CURRENT_TIMESTAMP AFTER last_run", table).Data(), "CreateDataTable");
     }
     else if (fDBType == kSQLite)
     {
         // delete the old timestamp update trigger if it exists
-        SendExec(TString::Format("DROP TRIGGER IF EXISTS timestamp_update_%s", table).Data());
+        SendExec(TString::Format("DROP TRIGGER IF EXISTS timestamp_update_%s", table).Data(), "CreateDataTable");
 
         // create the timestamp update trigger
         SendExec(TString::Format("CREATE TRIGGER after_%s_update "
@@ -2300,7 +3004,7 @@ Bool_t TCMySQLManager::CreateDataTable(const Char_t* data, Int_t nElem)
                                  "BEGIN "
                                  "UPDATE %s SET changed = CURRENT_TIMESTAMP WHERE calibration = OLD.calibration AND first_run = old.first_run ; "
                                  "END",
-                                 table, table, table).Data());
+                                 table, table, table).Data(), "CreateDataTable");
     }
 
     return kTRUE;
@@ -2318,7 +3022,7 @@ TList* TCMySQLManager::SearchDistinctEntries(const Char_t* field, const Char_t*
 
     // get all entries
     query.Form("SELECT DISTINCT %s from %s", field, table);
-    TSQLResult* res = SendQuery(query.Data());
+    TSQLResult* res = SendQuery(query.Data(), "SearchDistinctEntries");
 
     // check result
     if (!res)
@@ -2492,27 +3196,29 @@ Bool_t TCMySQLManager::AddDataSet(const Char_t* data, const Char_t* calibration,
         return kFALSE;
     }
 
-    // prepare the insert query
-    TString ins_query_1 = TString::Format("INSERT INTO %s (calibration, description, first_run, last_run",
-                                          ctable);
-    TString ins_query_2 = TString::Format(" VALUES ( '%s', '%s', %d, %d",
-                                          calibration, desc, first_run, last_run);
-
-    // read all parameters and update the partial queries
-    for (Int_t j = 0; j < length; j++)
-    {
-        // append parameter to query
-        ins_query_1.Append(TString::Format(", par_%03d", j));
-        ins_query_2.Append(TString::Format(", %.17g", par[j]));
-    }
+    // prepare the statement
+    TSQLStatement* stmt = CreateParStatement("INSERT", ctable, length);
 
-    // finalize query
-    ins_query_1.Append(")");
-    ins_query_2.Append(")");
-    ins_query_1.Append(ins_query_2.Data());
+    // bind the set information and all parameters
+    Bool_t res = stmt ? kTRUE : kFALSE;
+    if (res) res = stmt->SetString(0, calibration, 256);
+    if (res) res = stmt->SetString(1, desc, 1024);
+    if (res) res = stmt->SetInt(2, first_run);
+    if (res) res = stmt->SetInt(3, last_run);
+    for (Int_t j = 0; res && j < length; j++) res = stmt->SetDouble(j+4, par[j]);
 
     // write data to database
-    Bool_t res = SendExec(ins_query_1.Data());
+    TStopwatch t;
+    if (res) res = stmt->Process();
+    if (IsInstrumented())
+        RecordQuery("AddDataSet", TString::Format("INSERT (prepared) INTO %s", ctable).Data(),
+                    1000.*t.RealTime(), 0);
+
+    // clean-up
+    if (stmt) delete stmt;
+
+    // invalidate cached sets
+    InvalidateSetCatalog(data, calibration);
 
     // check result
     if (!res)
@@ -2626,7 +3332,10 @@ Bool_t TCMySQLManager::RemoveDataSet(const Char_t* data, const Char_t* calibrati
                table, calibration, first_run);
 
     // read from database
-    Bool_t res = SendExec(query.Data());
+    Bool_t res = SendExec(query.Data(), "RemoveDataSet");
+
+    // invalidate cached sets
+    InvalidateSetCatalog(data, calibration);
 
     // check result
     if (!res)
@@ -2713,7 +3422,7 @@ Bool_t TCMySQLManager::SplitDataSet(const Char_t* data, const Char_t* calibratio
                TCConfig::kCalibMainTableName, lastRunFirstSet);
 
     // read from database
-    TSQLResult* res = SendQuery(query.Data());
+    TSQLResult* res = SendQuery(query.Data(), "SplitDataSet");
     if (!res)
     {
         if (!fSilence) Error("SplitDataSet", "Cannot find first run of second set!");
@@ -3251,104 +3960,75 @@ Int_t TCMySQLManager::DumpRuns(TCContainer* container, Int_t first_run, Int_t la
     // Dump the run information from run 'first_run' to run 'last_run' to
     // the CaLib container 'container'.
     // If first_run and last_run is zero all available runs will be dumped.
+    // All runs are read using one query.
     // Return the number of dumped runs.
 
     TString query;
-    TString tmp;
 
     // create the query
-    if (!first_run && !last_run)
-    {
-        query.Form("SELECT run FROM %s "
-                   "ORDER by run",
-                   TCConfig::kCalibMainTableName);
-    }
-    else
-    {
-        query.Form("SELECT run FROM %s "
-                   "WHERE run >= %d "
-                   "AND run <= %d "
-                   "ORDER by run",
-                   TCConfig::kCalibMainTableName, first_run, last_run);
-    }
+    query.Form("SELECT run, path, filename, time, description, run_note, size, scr_n, scr_bad, "
+               "target, target_pol, target_pol_deg, beam_pol, beam_pol_deg FROM %s ",
+               TCConfig::kCalibMainTableName);
+    if (first_run || last_run)
+        query.Append(TString::Format("WHERE run >= %d AND run <= %d ", first_run, last_run));
+    query.Append("ORDER by run");
 
     // read from database
-    TSQLResult* res = SendQuery(query.Data());
+    TSQLResult* res = SendQuery(query.Data(), "DumpRuns");
 
-    // create list for run numbers
-    TList run_numbers;
-    run_numbers.SetOwner(kTRUE);
-
-    // read all rows/runs
-    TSQLRow* r = res->Next();
-    while (r)
+    // check result
+    if (!res)
     {
-        run_numbers.Add(new TObjString(r->GetField(0)));
-        delete r;
-        r = res->Next();
+        if (!fSilence) Error("DumpRuns", "Could not read the runs!");
+        return 0;
     }
 
-    // get number of runs
-    Int_t nruns = run_numbers.GetSize();
-
-    // loop over runs
-    for (Int_t i = 0; i < nruns; i++)
+    // loop over rows/runs
+    Int_t nruns = 0;
+    TSQLRow* row;
+    while ((row = res->Next()))
     {
-        // get next run
-        TObjString* rn = (TObjString*) run_numbers.At(i);
+        // get the fields (empty string for missing fields)
+        const Char_t* f[14];
+        for (Int_t i = 0; i < 14; i++) f[i] = row->GetField(i) ? row->GetField(i) : "";
 
         // get run number
-        Int_t run_number = atoi(rn->GetString().Data());
+        Int_t run_number = atoi(f[0]);
 
         // add new run
         TCRun* run = container->AddRun(run_number);
 
-        // set path
-        if (SearchRunEntry(run_number, "path", tmp)) run->SetPath(tmp.Data());
-
-        // set filename
-        if (SearchRunEntry(run_number, "filename", tmp)) run->SetFileName(tmp.Data());
-
-        // set time
-        if (SearchRunEntry(run_number, "time", tmp)) run->SetTime(tmp.Data());
-
-        // set description
-        if (SearchRunEntry(run_number, "description", tmp)) run->SetDescription(tmp.Data());
-
-        // set run_note
-        if (SearchRunEntry(run_number, "run_note", tmp)) run->SetRunNote(tmp.Data());
+        // set path, filename, time, description and run note
+        run->SetPath(f[1]);
+        run->SetFileName(f[2]);
+        run->SetTime(f[3]);
+        run->SetDescription(f[4]);
+        run->SetRunNote(f[5]);
 
         // set size
-        if (SearchRunEntry(run_number, "size", tmp))
-        {
-            Long64_t size;
-            sscanf(tmp.Data(), "%lld", &size);
-            run->SetSize(size);
-        }
-
-        // set scaler reads
-        if (SearchRunEntry(run_number, "scr_n", tmp)) run->SetNScalerReads(atoi(tmp.Data()));
-
-        // set bad scaler reads
-        if (SearchRunEntry(run_number, "scr_bad", tmp)) run->SetBadScalerReads(tmp.Data());
-
-        // set target
-        if (SearchRunEntry(run_number, "target", tmp)) run->SetTarget(tmp.Data());
+        Long64_t size = 0;
+        sscanf(f[6], "%lld", &size);
+        run->SetSize(size);
 
-        // set target polarization
-        if (SearchRunEntry(run_number, "target_pol", tmp)) run->SetTargetPol(tmp.Data());
+        // set scaler reads and bad scaler reads
+        run->SetNScalerReads(atoi(f[7]));
+        run->SetBadScalerReads(f[8]);
 
-        // set target polarization degree
-        if (SearchRunEntry(run_number, "target_pol_deg", tmp)) run->SetTargetPolDeg(atof(tmp.Data()));
+        // set target, target polarization and target polarization degree
+        run->SetTarget(f[9]);
+        run->SetTargetPol(f[10]);
+        run->SetTargetPolDeg(atof(f[11]));
 
-        // set beam polarization
-        if (SearchRunEntry(run_number, "beam_pol", tmp)) run->SetBeamPol(tmp.Data());
-
-        // set beam polarization degree
-        if (SearchRunEntry(run_number, "beam_pol_deg", tmp)) run->SetBeamPolDeg(atof(tmp.Data()));
+        // set beam polarization and beam polarization degree
+        run->SetBeamPol(f[12]);
+        run->SetBeamPolDeg(atof(f[13]));
 
         // user information
         if (!fSilence) Info("DumpRuns", "Dumped run %d", run_number);
+
+        // clean-up
+        delete row;
+        nruns++;
     }
 
     // clean-up
@@ -3359,13 +4039,17 @@ Int_t TCMySQLManager::DumpRuns(TCContainer* container, Int_t first_run, Int_t la
 
 //______________________________________________________________________________
 Int_t TCMySQLManager::DumpCalibrations(TCContainer* container, const Char_t* calibration,
-                                       const Char_t* data)
+                                       const Char_t* data, Int_t first_run, Int_t last_run)
 {
     // Dump calibrations of the calibration data 'data' with the calibration
     // identifier 'calibration' to the CaLib container 'container'.
+    // If 'first_run' and 'last_run' are not both zero only the sets containing
+    // runs from 'first_run' to 'last_run' are dumped.
+    // The sets are read in chunks of TCConfig::kDumpChunkSize sets.
     // Return the number of dumped calibrations.
 
-    Char_t tmp[256];
+    TString query;
+    Char_t table[256];
 
     // get data
     TCCalibData* d = GetCalibData(data);
@@ -3377,43 +4061,88 @@ Int_t TCMySQLManager::DumpCalibrations(TCContainer* container, const Char_t* cal
     // create the parameter array
     Double_t par[nPar];
 
-    // get the number of sets
-    Int_t nSet = GetNsets(data, calibration);
-
-    // check calibration
-    if (!nSet)
+    // get the data table
+    if (!SearchTable(data, table))
     {
-        if (!fSilence) Error("DumpCalibrations", "No sets of '%s' of the calibration '%s' found!",
-                             d->GetTitle(), calibration);
+        if (!fSilence) Error("DumpCalibrations", "No data table found!");
         return 0;
     }
 
-    // loop over sets
-    for (Int_t i = 0; i < nSet; i++)
-    {
-        // read parameters
-        ReadParameters(data, calibration, i, par, nPar);
+    // create the query
+    query = "SELECT description, first_run, last_run, changed";
+    for (Int_t j = 0; j < nPar; j++) query.Append(TString::Format(", par_%03d", j));
+    query.Append(TString::Format(" FROM %s WHERE calibration = '%s' ", table, calibration));
+    if (first_run || last_run)
+        query.Append(TString::Format("AND last_run >= %d AND first_run <= %d ", first_run, last_run));
+
+    // read the sets in chunks ordered by the first run (values are read as
+    // binary doubles; a statement stores its complete result in memory, so
+    // the chunks bound the memory used for large calibrations)
+    Int_t nSet = 0;
+    Int_t lastFirstRun = 0;
+    for (;;)
+    {
+        // create the query of the chunk
+        TString chunk = query;
+        if (nSet) chunk.Append(TString::Format("AND first_run > %d ", lastFirstRun));
+        chunk.Append(TString::Format("ORDER BY first_run ASC LIMIT %d", TCConfig::kDumpChunkSize));
 
-        // add the calibration
-        TCCalibration* c = container->AddCalibration(calibration);
+        // read from database
+        TStopwatch t;
+        TSQLStatement* stmt = IsConnected() ? fDB->Statement(chunk.Data()) : 0;
+        Bool_t res = stmt && stmt->Process() && stmt->StoreResult();
+        if (!res)
+        {
+            if (IsInstrumented()) RecordQuery("DumpCalibrations", chunk.Data(), 1000.*t.RealTime(), 0);
+            if (!fSilence) Error("DumpCalibrations", "Could not read the sets of '%s' of the calibration '%s'!",
+                                 d->GetTitle(), calibration);
+            if (stmt) delete stmt;
+            return 0;
+        }
+
+        // loop over sets
+        Int_t nChunk = 0;
+        while (stmt->NextResultRow())
+        {
+            // add the calibration
+            TCCalibration* c = container->AddCalibration(calibration);
 
-        // set calibration data
-        c->SetCalibData(data);
+            // set calibration data
+            c->SetCalibData(data);
 
-        // set description
-        GetDescriptionOfSet(data, calibration, i, tmp);
-        c->SetDescription(tmp);
+            // set description
+            c->SetDescription(stmt->IsNull(0) ? "" : stmt->GetString(0));
 
-        // set first and last run
-        c->SetFirstRun(GetFirstRunOfSet(data, calibration, i));
-        c->SetLastRun(GetLastRunOfSet(data, calibration, i));
+            // set first and last run
+            lastFirstRun = stmt->GetInt(1);
+            c->SetFirstRun(lastFirstRun);
+            c->SetLastRun(stmt->GetInt(2));
 
-        // set fill time
-        GetChangeTimeOfSet(data, calibration, i, tmp);
-        c->SetChangeTime(tmp);
+            // set fill time
+            c->SetChangeTime(stmt->IsNull(3) ? "" : stmt->GetString(3));
 
-        // set parameters
-        c->SetParameters(nPar, par);
+            // set parameters
+            for (Int_t j = 0; j < nPar; j++) par[j] = stmt->GetDouble(j+4);
+            c->SetParameters(nPar, par);
+
+            nChunk++;
+        }
+        if (IsInstrumented()) RecordQuery("DumpCalibrations", chunk.Data(), 1000.*t.RealTime(), nChunk);
+
+        // clean-up
+        delete stmt;
+
+        // check for last chunk
+        nSet += nChunk;
+        if (nChunk < TCConfig::kDumpChunkSize) break;
+    }
+
+    // check calibration
+    if (!nSet)
+    {
+        if (!fSilence) Error("DumpCalibrations", "No sets of '%s' of the calibration '%s' found!",
+                             d->GetTitle(), calibration);
+        return 0;
     }
 
     // user information
@@ -3424,10 +4153,13 @@ Int_t TCMySQLManager::DumpCalibrations(TCContainer* container, const Char_t* cal
 }
 
 //______________________________________________________________________________
-Int_t TCMySQLManager::DumpAllCalibrations(TCContainer* container, const Char_t* calibration)
+Int_t TCMySQLManager::DumpAllCalibrations(TCContainer* container, const Char_t* calibration,
+                                          Int_t first_run, Int_t last_run)
 {
     // Dump all calibrations with the calibration identifier 'calibration' to
     // the CaLib container 'container'.
+    // If 'first_run' and 'last_run' are not both zero only the sets containing
+    // runs from 'first_run' to 'last_run' are dumped.
     // Return the number of dumped calibrations.
 
     Int_t nDump = 0;
@@ -3438,7 +4170,7 @@ Int_t TCMySQLManager::DumpAllCalibrations(TCContainer* container, const Char_t*
     while ((d = (TCCalibData*)next()))
     {
         // dump calibrations
-        if (Int_t nd = DumpCalibrations(container, calibration, d->GetName())) nDump += nd;
+        if (Int_t nd = DumpCalibrations(container, calibration, d->GetName(), first_run, last_run)) nDump += nd;
     }
 
     return nDump;
@@ -3453,61 +4185,76 @@ Int_t TCMySQLManager::ImportRuns(TCContainer* container)
     // get number of runs
     Int_t nRun = container->GetNRuns();
 
+    // prepare the insert statement head
+    TString ins_head = TString::Format("INSERT INTO %s (run, path, filename, time, description, run_note, size, scr_n, scr_bad, "
+                                       "target, target_pol, target_pol_deg, beam_pol, beam_pol_deg) "
+                                       "VALUES ",
+                                       TCConfig::kCalibMainTableName);
+
     // loop over runs
-    Int_t nRunAdded = 0;
+    TString* rows = new TString[nRun];
+    Bool_t* added = new Bool_t[nRun];
     for (Int_t i = 0; i < nRun; i++)
     {
         // get the run
         TCRun* r = container->GetRun(i);
 
-        // prepare the insert query
-        TString ins_query = TString::Format("INSERT INTO %s (run, path, filename, time, description, run_note, size, scr_n, scr_bad, "
-                                            "target, target_pol, target_pol_deg, beam_pol, beam_pol_deg) "
-                                            "VALUES ( "
-                                            "%d, "
-                                            "'%s', "
-                                            "'%s', "
-                                            "'%s', "
-                                            "'%s', "
-                                            "'%s', "
-                                            "%lld, "
-                                            "%d, "
-                                            "'%s', "
-                                            "'%s', "
-                                            "'%s', "
-                                            "%lf, "
-                                            "'%s', "
-                                            "%lf )",
-                                            TCConfig::kCalibMainTableName,
-                                            r->GetRun(),
-                                            r->GetPath(),
-                                            r->GetFileName(),
-                                            r->GetTime(),
-                                            r->GetDescription(),
-                                            r->GetRunNote(),
-                                            r->GetSize(),
-                                            r->GetNScalerReads(),
-                                            r->GetBadScalerReads(),
-                                            r->GetTarget(),
-                                            r->GetTargetPol(),
-                                            r->GetTargetPolDeg(),
-                                            r->GetBeamPol(),
-                                            r->GetBeamPolDeg());
-
-        // try to write data to database
-        Bool_t res = SendExec(ins_query.Data());
-        if (res == kFALSE)
+        // prepare the row
+        rows[i].Form("( "
+                     "%d, "
+                     "'%s', "
+                     "'%s', "
+                     "'%s', "
+                     "'%s', "
+                     "'%s', "
+                     "%lld, "
+                     "%d, "
+                     "'%s', "
+                     "'%s', "
+                     "'%s', "
+                     "%lf, "
+                     "'%s', "
+                     "%lf )",
+                     r->GetRun(),
+                     r->GetPath(),
+                     r->GetFileName(),
+                     r->GetTime(),
+                     r->GetDescription(),
+                     r->GetRunNote(),
+                     r->GetSize(),
+                     r->GetNScalerReads(),
+                     r->GetBadScalerReads(),
+                     r->GetTarget(),
+                     r->GetTargetPol(),
+                     r->GetTargetPolDeg(),
+                     r->GetBeamPol(),
+                     r->GetBeamPolDeg());
+    }
+
+    // try to write data to database
+    Int_t nRunAdded = InsertBulk("ImportRuns", ins_head.Data(), nRun, rows, added);
+
+    // report runs
+    for (Int_t i = 0; i < nRun; i++)
+    {
+        if (!added[i])
         {
             Warning("ImportRuns", "Run %d could not be added to the database!",
-                    r->GetRun());
+                    container->GetRun(i)->GetRun());
         }
         else
         {
-            if (!fSilence) Info("ImportRuns", "Added run %d to the database", r->GetRun());
-            nRunAdded++;
+            if (!fSilence) Info("ImportRuns", "Added run %d to the database", container->GetRun(i)->GetRun());
         }
     }
 
+    // clean-up
+    delete [] rows;
+    delete [] added;
+
+    // invalidate cached run numbers
+    InvalidateRunIndex();
+
     // user information
     if (!fSilence) Info("ImportRuns", "Added %d runs to the database", nRunAdded);
 
@@ -3529,36 +4276,55 @@ Int_t TCMySQLManager::ImportCalibrations(TCContainer* container, const Char_t* n
     // get number of calibrations
     Int_t nCalib = container->GetNCalibrations();
 
-    // loop over calibrations
+    // loop over batches of calibrations
     Int_t nCalibAdded = 0;
-    for (Int_t i = 0; i < nCalib; i++)
+    for (Int_t first = 0; first < nCalib; first += fBulkSize)
     {
-        // get the calibration
-        TCCalibration* c = container->GetCalibration(i);
+        Int_t last = TMath::Min(first + fBulkSize, nCalib);
+        Int_t nBatchAdded = 0;
+
+        // add the batch in one transaction
+        BeginTransaction();
 
-        // skip unwanted calibration data
-        if (data != 0 && strcmp(c->GetCalibData(), data)) continue;
+        // loop over calibrations
+        for (Int_t i = first; i < last; i++)
+        {
+            // get the calibration
+            TCCalibration* c = container->GetCalibration(i);
 
-        // add the set with new calibration identifer or the same
-        const Char_t* calibration;
-        if (newCalibName) calibration = newCalibName;
-        else calibration = c->GetCalibration();
+            // skip unwanted calibration data
+            if (data != 0 && strcmp(c->GetCalibData(), data)) continue;
 
-        TCCalibData* d = GetCalibData(c->GetCalibData());
-        if (!d) continue;
+            // add the set with new calibration identifer or the same
+            const Char_t* calibration;
+            if (newCalibName) calibration = newCalibName;
+            else calibration = c->GetCalibration();
 
-        // add the set
-        if (AddDataSet(c->GetCalibData(), calibration, c->GetDescription(),
-                       c->GetFirstRun(), c->GetLastRun(), c->GetParameters(), c->GetNParameters(), kTRUE))
-        {
-            if (!fSilence) Info("ImportCalibrations", "Added calibration '%s' of '%s' to the database",
-                                calibration, d->GetTitle());
-            nCalibAdded++;
+            TCCalibData* d = GetCalibData(c->GetCalibData());
+            if (!d) continue;
+
+            // add the set
+            if (AddDataSet(c->GetCalibData(), calibration, c->GetDescription(),
+                           c->GetFirstRun(), c->GetLastRun(), c->GetParameters(), c->GetNParameters(), kTRUE))
+            {
+                if (!fSilence) Info("ImportCalibrations", "Added calibration '%s' of '%s' to the database",
+                                    calibration, d->GetTitle());
+                nBatchAdded++;
+            }
+            else
+            {
+                if (!fSilence) Error("ImportCalibrations", "Calibration '%s' of '%s' could not be added to the database!",
+                                     calibration, d->GetTitle());
+            }
         }
+
+        // commit the batch
+        if (CommitTransaction()) nCalibAdded += nBatchAdded;
         else
         {
-            if (!fSilence) Error("ImportCalibrations", "Calibration '%s' of '%s' could not be added to the database!",
-                                 calibration, d->GetTitle());
+            RollbackTransaction();
+            if (!fSilence) Error("ImportCalibrations", "Could not commit calibrations %d to %d to the database!",
+                                 first, last-1);
         }
     }
 
@@ -3674,7 +4440,8 @@ void TCMySQLManager::Export(const Char_t* filename, Int_t first_run, Int_t last_
     // If 'first_run' is -1 or 'last_run' is -1 no run information is exported.
     //
     // If 'calibration' is non-zero the calibration with the identifier 'calibration'
-    // is exported.
+    // is exported. If a run range is given only the sets containing runs from
+    // 'first_run' to 'last_run' are exported, otherwise all sets are exported.
 
     // create new container
     TCContainer* container = new TCContainer(TCConfig::kCaLibDumpName);
@@ -3692,10 +4459,11 @@ void TCMySQLManager::Export(const Char_t* filename, Int_t first_run, Int_t last_
         }
     }
 
-    // dump runs to container
+    // dump calibrations to container
     if (calibration)
     {
-        DumpAllCalibrations(container, calibration);
+        if (first_run > 0 && last_run > 0) DumpAllCalibrations(container, calibration, first_run, last_run);
+        else DumpAllCalibrations(container, calibration);
         if (!fSilence)
         {
             if (container->GetNCalibrations())
@@ -3866,10 +4634,236 @@ void TCMySQLManager::Import(const Char_t* filename, Bool_t runs, Bool_t calibrat
     delete c;
 }
 
+//______________________________________________________________________________
+Int_t TCMySQLManager::CopyTable(TSQLServer* target, const Char_t* table, const Char_t* filter)
+{
+    // Copy the rows of the table 'table' matching the SQL condition 'filter'
+    // (all rows if 'filter' is 0) to the same table of the SQLite database
+    // 'target'. Existing rows of the target table are replaced.
+    // The rows are read in chunks of fBulkSize rows ordered by the primary key
+    // and written in one transaction per chunk, so that the memory usage does
+    // not depend on the size of the table.
+    // Return the number of copied rows or -1 if an error occurred.
+
+    TString query;
+
+    // check server connection
+    if (!IsConnected())
+    {
+        if (!fSilence) Error("CopyTable", "No connection to the database!");
+        return -1;
+    }
+
+    // check the table type (primary key)
+    Bool_t isMain = !strcmp(table, TCConfig::kCalibMainTableName);
+
+    // count the rows to copy
+    query.Form("SELECT COUNT(*) FROM %s", table);
+    if (filter) query.Append(TString::Format(" WHERE %s", filter));
+    TSQLResult* res = SendQuery(query.Data(), "CopyTable");
+    if (!res)
+    {
+        if (!fSilence) Error("CopyTable", "Could not read the table '%s'!", table);
+        return -1;
+    }
+    TSQLRow* row = res->Next();
+    Int_t nRows = row ? atoi(row->GetField(0)) : 0;
+    if (row) delete row;
+    delete res;
+
+    // loop over chunks
+    Int_t nCopied = 0;
+    Int_t lastRun = 0;
+    TString lastCalib;
+    for (;;)
+    {
+        // create the selection of the next chunk (continue after the last key)
+        TString cond = filter ? TString::Format("(%s)", filter) : TString("1 = 1");
+        if (nCopied)
+        {
+            if (isMain) cond.Append(TString::Format(" AND run > %d", lastRun));
+            else cond.Append(TString::Format(" AND (calibration > '%s' OR "
+                                             "(calibration = '%s' AND first_run > %d))",
+                                             lastCalib.Data(), lastCalib.Data(), lastRun));
+        }
+        query.Form("SELECT * FROM %s WHERE %s ORDER BY %s LIMIT %d",
+                   table, cond.Data(), isMain ? "run" : "calibration, first_run", fBulkSize);
+
+        // read the chunk
+        TSQLStatement* src = fDB->Statement(query.Data());
+        if (!src || !src->Process() || !src->StoreResult())
+        {
+            if (!fSilence) Error("CopyTable", "Could not read the table '%s'!", table);
+            if (src) delete src;
+            return -1;
+        }
+
+        // get the columns and the indices of the primary key
+        Int_t nField = src->GetNumFields();
+        Int_t keyRun = -1;
+        Int_t keyCalib = -1;
+        Bool_t isDouble[nField];
+        TString sql = TString::Format("INSERT OR REPLACE INTO %s (", table);
+        for (Int_t i = 0; i < nField; i++)
+        {
+            TString name(src->GetFieldName(i));
+            if (name == (isMain ? "run" : "first_run")) keyRun = i;
+            if (name == "calibration") keyCalib = i;
+            isDouble[i] = name.BeginsWith("par_") || name.EndsWith("_deg");
+            sql.Append(i ? ", " : "");
+            sql.Append(name);
+        }
+        sql.Append(") VALUES (");
+        for (Int_t i = 0; i < nField; i++) sql.Append(i ? ", ?" : "?");
+        sql.Append(")");
+
+        // prepare the insert statement
+        TSQLStatement* dst = target->Statement(sql.Data(), fBulkSize);
+        if (!dst)
+        {
+            if (!fSilence) Error("CopyTable", "Could not write to the table '%s'!", table);
+            delete src;
+            return -1;
+        }
+
+        // copy the rows of the chunk in one transaction
+        Int_t nChunk = 0;
+        Bool_t ok = target->Exec("BEGIN TRANSACTION");
+        while (ok && src->NextResultRow())
+        {
+            ok = dst->NextIteration();
+            for (Int_t i = 0; ok && i < nField; i++)
+            {
+                if (src->IsNull(i)) ok = dst->SetNull(i);
+                else if (isDouble[i]) ok = dst->SetDouble(i, src->GetDouble(i));
+                else
+                {
+                    const Char_t* v = src->GetString(i);
+                    ok = dst->SetString(i, v, TMath::Max(256, (Int_t)strlen(v)+1));
+                }
+            }
+
+            // remember the primary key
+            if (keyRun >= 0) lastRun = src->GetInt(keyRun);
+            if (keyCalib >= 0) lastCalib = src->GetString(keyCalib);
+            nChunk++;
+        }
+        if (ok && nChunk) ok = dst->Process();
+        if (ok) ok = target->Exec("COMMIT");
+        else target->Exec("ROLLBACK");
+
+        // clean-up
+        delete dst;
+        delete src;
+
+        // check result
+        if (!ok)
+        {
+            if (!fSilence) Error("CopyTable", "Could not write to the table '%s'!", table);
+            return -1;
+        }
+
+        // user information
+        nCopied += nChunk;
+        if (!fSilence) Info("CopyTable", "Copied %d of %d rows of the table '%s'", nCopied, nRows, table);
+
+        // check for last chunk
+        if (nChunk < fBulkSize) break;
+    }
+
+    return nCopied;
+}
+
+//______________________________________________________________________________
+Int_t TCMySQLManager::RemoveDeletedRows(TSQLServer* target, const Char_t* table)
+{
+    // Remove all rows of the table 'table' of the SQLite database 'target'
+    // whose primary key does not exist anymore in the table 'table' of the
+    // current database.
+    // Return the number of removed rows or -1 if an error occurred.
+
+    // check the table type (primary key)
+    Bool_t isMain = !strcmp(table, TCConfig::kCalibMainTableName);
+    TString query = TString::Format("SELECT %s FROM %s",
+                                    isMain ? "run" : "calibration, first_run", table);
+
+    // read the primary keys of the current database
+    TSQLResult* res = SendQuery(query.Data(), "RemoveDeletedRows");
+    if (!res)
+    {
+        if (!fSilence) Error("RemoveDeletedRows", "Could not read the table '%s'!", table);
+        return -1;
+    }
+    THashTable keys(1024, 2);
+    keys.SetOwner(kTRUE);
+    TSQLRow* row;
+    while ((row = res->Next()))
+    {
+        if (isMain) keys.Add(new TObjString(row->GetField(0)));
+        else keys.Add(new TObjString(TString::Format("%s/%s", row->GetField(0), row->GetField(1))));
+        delete row;
+    }
+    delete res;
+
+    // read the primary keys of the target database
+    res = target->Query(query.Data());
+    if (!res)
+    {
+        if (!fSilence) Error("RemoveDeletedRows", "Could not read the table '%s' of the replica!", table);
+        return -1;
+    }
+
+    // collect the deletions of rows not existing anymore
+    TList del;
+    del.SetOwner(kTRUE);
+    while ((row = res->Next()))
+    {
+        if (isMain)
+        {
+            if (!keys.FindObject(row->GetField(0)))
+                del.Add(new TObjString(TString::Format("DELETE FROM %s WHERE run = %s",
+                                                       table, row->GetField(0))));
+        }
+        else
+        {
+            if (!keys.FindObject(TString::Format("%s/%s", row->GetField(0), row->GetField(1)).Data()))
+                del.Add(new TObjString(TString::Format("DELETE FROM %s WHERE calibration = '%s' "
+                                                       "AND first_run = %s",
+                                                       table, row->GetField(0), row->GetField(1))));
+        }
+        delete row;
+    }
+    delete res;
+
+    // delete the rows in one transaction
+    Int_t nDel = del.GetSize();
+    if (!nDel) return 0;
+    Bool_t ok = target->Exec("BEGIN TRANSACTION");
+    TIter next(&del);
+    TObjString* s;
+    while (ok && (s = (TObjString*)next())) ok = target->Exec(s->GetString().Data());
+    if (ok) ok = target->Exec("COMMIT");
+    else target->Exec("ROLLBACK");
+
+    // check result
+    if (!ok)
+    {
+        if (!fSilence) Error("RemoveDeletedRows", "Could not remove rows of the table '%s' of the replica!", table);
+        return -1;
+    }
+
+    // user information
+    if (!fSilence) Info("RemoveDeletedRows", "Removed %d rows of the table '%s'", nDel, table);
+
+    return nDel;
+}
+
 //______________________________________________________________________________
 Bool_t TCMySQLManager::ExportDatabase(const Char_t* filename)
 {
     // Export the complete database to the SQLite database 'filename'.
+    // The tables are copied in chunks without loading the whole database
+    // into memory.
 
     Char_t tmp[256];
     Char_t fn[256];
@@ -3897,65 +4891,176 @@ Bool_t TCMySQLManager::ExportDatabase(const Char_t* filename)
         return kFALSE;
     }
 
-    // create new container
-    TCContainer* container = new TCContainer(TCConfig::kCaLibDumpName);
-
-    // dump runs to container
-    Int_t nRunExp = TCMySQLManager::GetManager()->DumpRuns(container);
-    if (!fSilence) Info("ExportDatabase", "Exported %d runs to '%s'", nRunExp, fn);
-
-    // get all calibrations
-    TList* c = TCMySQLManager::GetManager()->GetAllCalibrations();
-
-    // dump all calibrations to container
-    Int_t nCalibExp = 0;
-    Int_t nCalib = c->GetSize();
-    if (!fSilence) Info("ExportDatabase", "Exporting %d calibrations to '%s'", nCalib, fn);
-    for (Int_t i = 0; i < nCalib; i++)
-    {
-        TObjString* s = (TObjString*) c->At(i);
-        nCalibExp += TCMySQLManager::GetManager()->DumpAllCalibrations(container, s->GetString().Data());
-        if (!fSilence) Info("ExportDatabase", "Exported calibration '%s'", s->GetString().Data());
-    }
-
     // backup original database config
     TSQLServer* db_orig = fDB;
     ServerType_t type_orig = fDBType;
 
     // configure db connection to SQLite database
+    ClearCache();
     fDB = db;
     fDBType = kSQLite;
 
     // init the database
-    InitDatabase(kFALSE);
-
-    // import runs
-    Int_t nRunImp = TCMySQLManager::GetManager()->ImportRuns(container);
-
-    // import calibrations
-    Int_t nCalibImp = TCMySQLManager::GetManager()->ImportCalibrations(container);
+    Bool_t err = !InitDatabase(kFALSE);
 
     // restore original db connection
+    ClearCache();
     fDB = db_orig;
     fDBType = type_orig;
 
+    // copy the main table
+    if (!err && CopyTable(db, TCConfig::kCalibMainTableName) < 0) err = kTRUE;
+
+    // copy the data tables
+    TIter next(fData);
+    TCCalibData* d;
+    while (!err && (d = (TCCalibData*)next()))
+    {
+        if (CopyTable(db, d->GetTableName()) < 0) err = kTRUE;
+    }
+
     // clean-up
-    delete c;
-    delete container;
     delete db;
 
-    // make some checks
-    if (nRunImp != nRunExp)
+    // check for errors
+    if (err)
+    {
+        if (!fSilence) Error("ExportDatabase", "Could not export the database to '%s'!", fn);
+        return kFALSE;
+    }
+
+    if (!fSilence) Info("ExportDatabase", "Exported the database to '%s'", fn);
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t TCMySQLManager::SyncReplica(const Char_t* replicaFile)
+{
+    // Synchronize the SQLite replica 'replicaFile' of this database.
+    // If the replica does not exist yet, the complete database is exported.
+    // Otherwise only the rows whose change time is not older than the last
+    // synchronization point stored in the replica are copied and the rows
+    // deleted in this database are removed from the replica.
+    // Return kTRUE on success, otherwise kFALSE.
+
+    Char_t tmp[256];
+    Char_t fn[256];
+
+    // expand filename
+    Char_t* fnt = gSystem->ExpandPathName(replicaFile);
+    strcpy(fn, fnt);
+    delete fnt;
+
+    // get the synchronization point (current time of this database)
+    TSQLResult* res = SendQuery("SELECT CURRENT_TIMESTAMP", "SyncReplica");
+    TSQLRow* row = res ? res->Next() : 0;
+    TString syncTime = row ? row->GetField(0) : "";
+    if (row) delete row;
+    if (res) delete res;
+    if (syncTime == "")
+    {
+        if (!fSilence) Error("SyncReplica", "Could not read the current time of the database!");
+        return kFALSE;
+    }
+
+    // create new replica
+    Bool_t isNew = gSystem->AccessPathName(fn);
+    if (isNew && !ExportDatabase(fn)) return kFALSE;
+
+    // open replica
+    sprintf(tmp, "sqlite://%s", fn);
+    TSQLServer* db = TSQLServer::Connect(tmp, "", "");
+
+    // check DB connection
+    if (!db || db->IsZombie())
     {
-        if (!fSilence) Error("ExportDatabase", "Could not export all runs!");
+        if (!fSilence) Error("SyncReplica", "Cannot connect to the replica '%s'!", fn);
         return kFALSE;
     }
-    if (nCalibImp != nCalibExp)
+
+    // create the synchronization table
+    db->Exec(TString::Format("CREATE TABLE IF NOT EXISTS %s ( last_sync VARCHAR(64) )",
+                             TCConfig::kCalibSyncTableName).Data());
+
+    // update the replica
+    Bool_t err = kFALSE;
+    if (!isNew)
+    {
+        // read the last synchronization point
+        TString lastSync;
+        res = db->Query(TString::Format("SELECT last_sync FROM %s", TCConfig::kCalibSyncTableName).Data());
+        row = res ? res->Next() : 0;
+        if (row && row->GetField(0)) lastSync = row->GetField(0);
+        if (row) delete row;
+        if (res) delete res;
+
+        // selection of the changed rows (copy all rows if there was no synchronization)
+        TString filter = TString::Format("changed >= '%s'", lastSync.Data());
+        if (lastSync == "")
+        {
+            if (!fSilence) Warning("SyncReplica", "No synchronization point found in '%s' - copying all rows", fn);
+        }
+        else
+        {
+            if (!fSilence) Info("SyncReplica", "Synchronizing changes since %s", lastSync.Data());
+        }
+
+        // create missing data tables in the replica
+        TSQLServer* db_orig = fDB;
+        ServerType_t type_orig = fDBType;
+        ClearCache();
+        fDB = db;
+        fDBType = kSQLite;
+        TIter nextNew(fData);
+        TCCalibData* d;
+        while ((d = (TCCalibData*)nextNew()))
+        {
+            TSQLResult* r = db->Query(TString::Format("SELECT COUNT(*) FROM %s", d->GetTableName()).Data());
+            if (r) delete r;
+            else if (!CreateDataTable(d->GetName(), d->GetSize())) err = kTRUE;
+        }
+        ClearCache();
+        fDB = db_orig;
+        fDBType = type_orig;
+
+        // synchronize the main table
+        const Char_t* f = lastSync == "" ? 0 : filter.Data();
+        if (!err && CopyTable(db, TCConfig::kCalibMainTableName, f) < 0) err = kTRUE;
+        if (!err && RemoveDeletedRows(db, TCConfig::kCalibMainTableName) < 0) err = kTRUE;
+
+        // synchronize the data tables
+        TIter next(fData);
+        while (!err && (d = (TCCalibData*)next()))
+        {
+            if (CopyTable(db, d->GetTableName(), f) < 0) err = kTRUE;
+            else if (RemoveDeletedRows(db, d->GetTableName()) < 0) err = kTRUE;
+        }
+    }
+
+    // store the synchronization point
+    if (!err)
+    {
+        err = !db->Exec("BEGIN TRANSACTION") ||
+              !db->Exec(TString::Format("DELETE FROM %s", TCConfig::kCalibSyncTableName).Data()) ||
+              !db->Exec(TString::Format("INSERT INTO %s (last_sync) VALUES ('%s')",
+                                        TCConfig::kCalibSyncTableName, syncTime.Data()).Data()) ||
+              !db->Exec("COMMIT");
+    }
+
+    // clean-up
+    delete db;
+
+    // check for errors
+    if (err)
     {
-        if (!fSilence) Error("ExportDatabase", "Could not export all calibrations!");
+        if (!fSilence) Error("SyncReplica", "Could not synchronize the replica '%s'!", fn);
         return kFALSE;
     }
 
+    if (!fSilence) Info("SyncReplica", "Synchronized the replica '%s' (synchronization point %s)",
+                        fn, syncTime.Data());
+
     return kTRUE;
 }
 
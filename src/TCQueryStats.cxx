@@ -0,0 +1,141 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCQueryStats                                                         //
+//                                                                      //
+// Latency and row statistics of the database queries of one call site. //
+//                                                                      //
+// The latencies are filled into a histogram with 10 logarithmic bins   //
+// per decade starting at 1 us, i.e. the quantiles are accurate to      //
+// about 12% while the memory used is constant.                         //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "TMath.h"
+
+#include "TCQueryStats.h"
+
+ClassImp(TCQueryStats)
+
+// init static class members
+const Int_t TCQueryStats::kNBins;
+const Double_t TCQueryStats::kMinTime = 1e-3;
+
+//______________________________________________________________________________
+void TCQueryStats::Reset()
+{
+    // Reset the statistics.
+
+    fN = 0;
+    fTotal = 0;
+    fMin = 0;
+    fMax = 0;
+    fRows = 0;
+    for (Int_t i = 0; i < kNBins; i++) fBins[i] = 0;
+}
+
+//______________________________________________________________________________
+void TCQueryStats::Fill(Double_t time, Long64_t rows)
+{
+    // Add a query that took 'time' milliseconds and returned 'rows' rows.
+
+    // update counters
+    if (!fN || time < fMin) fMin = time;
+    if (time > fMax) fMax = time;
+    fN++;
+    fTotal += time;
+    if (rows > 0) fRows += rows;
+
+    // fill latency histogram
+    Int_t bin = time > kMinTime ? (Int_t)(10.*TMath::Log10(time / kMinTime)) : 0;
+    if (bin >= kNBins) bin = kNBins - 1;
+    fBins[bin]++;
+}
+
+//______________________________________________________________________________
+Double_t TCQueryStats::GetQuantile(Double_t q) const
+{
+    // Return the 'q'-quantile of the query times in milliseconds estimated
+    // by the center of the corresponding latency bin.
+
+    // check entries
+    if (!fN) return 0;
+
+    // find the bin
+    Double_t n = q * fN;
+    Long64_t sum = 0;
+    Int_t bin = kNBins - 1;
+    for (Int_t i = 0; i < kNBins; i++)
+    {
+        sum += fBins[i];
+        if (sum >= n)
+        {
+            bin = i;
+            break;
+        }
+    }
+
+    // calculate bin center and stay within the observed range
+    Double_t t = kMinTime * TMath::Power(10., (bin + 0.5) / 10.);
+    if (t < fMin) t = fMin;
+    if (t > fMax) t = fMax;
+
+    return t;
+}
+
+//______________________________________________________________________________
+Int_t TCQueryStats::Compare(const TObject* obj) const
+{
+    // Compare the total query time to the one of the statistics 'obj'.
+
+    Double_t t = ((TCQueryStats*)obj)->GetTotal();
+    if (fTotal > t) return 1;
+    else if (fTotal < t) return -1;
+    else return 0;
+}
+
+//______________________________________________________________________________
+TString TCQueryStats::GetJSON() const
+{
+    // Return the statistics as JSON object.
+
+    return TString::Format("{ \"site\": \"%s\", \"count\": %lld, \"total_ms\": %.3f, "
+                           "\"min_ms\": %.3f, \"max_ms\": %.3f, \"p50_ms\": %.3f, "
+                           "\"p99_ms\": %.3f, \"rows\": %lld }",
+                           GetName(), fN, fTotal, GetMin(), fMax,
+                           GetQuantile(0.5), GetQuantile(0.99), fRows);
+}
+
+//______________________________________________________________________________
+TString TCQueryStats::GetTableHeader()
+{
+    // Return the header of the statistics table.
+
+    return TString::Format("%-28s %10s %12s %10s %10s %10s %10s %12s",
+                           "Call site", "Count", "Total [ms]", "Min [ms]", "Max [ms]",
+                           "p50 [ms]", "p99 [ms]", "Rows");
+}
+
+//______________________________________________________________________________
+TString TCQueryStats::GetTableRow() const
+{
+    // Return the statistics as row of the statistics table.
+
+    return TString::Format("%-28s %10lld %12.3f %10.3f %10.3f %10.3f %10.3f %12lld",
+                           GetName(), fN, fTotal, GetMin(), fMax,
+                           GetQuantile(0.5), GetQuantile(0.99), fRows);
+}
+
+//______________________________________________________________________________
+void TCQueryStats::Print(Option_t* option) const
+{
+    // Print the content of this class.
+
+    printf("%s\n", GetTableHeader().Data());
+    printf("%s\n", GetTableRow().Data());
+}
+
@@ -0,0 +1,490 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCRunHistoStore                                                      //
+//                                                                      //
+// Prefix-sum store of the per-run histograms of one histogram.         //
+//                                                                      //
+// The store file contains the histogram of every run ('Run_<run>')     //
+// and, every 'interval' runs, the cumulative sum of all preceding      //
+// runs ('Sum_<n>' = sum of the first n*interval runs). The sum over    //
+// any contiguous run range is then calculated from two checkpoints     //
+// and at most 2*interval single-run histograms instead of summing all  //
+// runs of the range. This makes trying different set boundaries cheap. //
+// The checkpoints are stored in double precision as they are           //
+// subtracted from each other.                                          //
+//                                                                      //
+// The size and modification time of every run file are recorded when   //
+// building the store. IsUpToDate() compares them to the current files  //
+// so that a stale or incomplete store is not used.                     //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "TFile.h"
+#include "TH1.h"
+#include "TArrayI.h"
+#include "TArrayL64.h"
+#include "TH2.h"
+#include "TH3.h"
+#include "TSystem.h"
+#include "TNamed.h"
+#include "TMath.h"
+#include "TError.h"
+
+#include "TCRunHistoStore.h"
+#include "TCMySQLManager.h"
+
+ClassImp(TCRunHistoStore)
+
+// init static class members
+const Int_t TCRunHistoStore::kVersion;
+
+//______________________________________________________________________________
+TCRunHistoStore::TCRunHistoStore(const Char_t* filename)
+{
+    // Constructor opening the store file 'filename'.
+
+    // init members
+    fFile = 0;
+    fInterval = 0;
+    fNRun = 0;
+    fRuns = 0;
+    fSizes = 0;
+    fMTimes = 0;
+
+    // open the file
+    TFile* f = TFile::Open(filename);
+    if (!f || f->IsZombie())
+    {
+        Error("TCRunHistoStore", "Could not open the store file '%s'!", filename);
+        if (f) delete f;
+        return;
+    }
+
+    // read the store information
+    TArrayI* runs = 0;
+    TArrayI* info = 0;
+    TArrayL64* sizes = 0;
+    TArrayL64* mtimes = 0;
+    f->GetObject("Runs", runs);
+    f->GetObject("Info", info);
+    f->GetObject("Sizes", sizes);
+    f->GetObject("MTimes", mtimes);
+    TNamed* name = (TNamed*) f->Get("HistoName");
+    Bool_t valid = runs && info && sizes && mtimes && name &&
+                   info->GetSize() >= 2 && info->At(1) >= 1 &&
+                   sizes->GetSize() == runs->GetSize() && mtimes->GetSize() == runs->GetSize();
+    if (info && info->GetSize() && info->At(0) != kVersion)
+    {
+        Error("TCRunHistoStore", "'%s' has the format version %d instead of %d - please rebuild it!",
+              filename, info->At(0), kVersion);
+        valid = kFALSE;
+    }
+    else if (!valid)
+    {
+        Error("TCRunHistoStore", "'%s' is not a valid store file!", filename);
+    }
+    if (!valid)
+    {
+        if (runs) delete runs;
+        if (info) delete info;
+        if (sizes) delete sizes;
+        if (mtimes) delete mtimes;
+        if (name) delete name;
+        delete f;
+        return;
+    }
+
+    // set members
+    fFile = f;
+    fHistoName = name->GetTitle();
+    fInterval = info->At(1);
+    fNRun = runs->GetSize();
+    fRuns = new Int_t[fNRun];
+    fSizes = new Long64_t[fNRun];
+    fMTimes = new Long64_t[fNRun];
+    for (Int_t i = 0; i < fNRun; i++)
+    {
+        fRuns[i] = runs->At(i);
+        fSizes[i] = sizes->At(i);
+        fMTimes[i] = mtimes->At(i);
+    }
+
+    // clean-up
+    delete runs;
+    delete info;
+    delete sizes;
+    delete mtimes;
+    delete name;
+}
+
+//______________________________________________________________________________
+TCRunHistoStore::~TCRunHistoStore()
+{
+    // Destructor.
+
+    if (fFile) delete fFile;
+    if (fRuns) delete [] fRuns;
+    if (fSizes) delete [] fSizes;
+    if (fMTimes) delete [] fMTimes;
+}
+
+//______________________________________________________________________________
+void TCRunHistoStore::GetFileKey(const Char_t* filename, Long64_t* outSize, Long64_t* outMTime)
+{
+    // Save the size and the modification time of the file 'filename' to
+    // 'outSize' and 'outMTime'. Both are set to -1 if the file does not exist.
+
+    Long_t id, flags, modtime;
+    Long64_t size;
+    if (gSystem->GetPathInfo(filename, &id, &size, &flags, &modtime))
+    {
+        *outSize = -1;
+        *outMTime = -1;
+    }
+    else
+    {
+        *outSize = size;
+        *outMTime = modtime;
+    }
+}
+
+//______________________________________________________________________________
+TH1* TCRunHistoStore::CreateDoubleHisto(const TH1* h)
+{
+    // Return an empty histogram in double precision having the binning of the
+    // histogram 'h'. Return 0 for unsupported dimensions.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    const TAxis* x = h->GetXaxis();
+    const TAxis* y = h->GetYaxis();
+    const TAxis* z = h->GetZaxis();
+
+    // create the histogram
+    TH1* hD = 0;
+    if (h->GetDimension() == 1)
+        hD = new TH1D(h->GetName(), h->GetTitle(),
+                      x->GetNbins(), x->GetXmin(), x->GetXmax());
+    else if (h->GetDimension() == 2)
+        hD = new TH2D(h->GetName(), h->GetTitle(),
+                      x->GetNbins(), x->GetXmin(), x->GetXmax(),
+                      y->GetNbins(), y->GetXmin(), y->GetXmax());
+    else if (h->GetDimension() == 3)
+        hD = new TH3D(h->GetName(), h->GetTitle(),
+                      x->GetNbins(), x->GetXmin(), x->GetXmax(),
+                      y->GetNbins(), y->GetXmin(), y->GetXmax(),
+                      z->GetNbins(), z->GetXmin(), z->GetXmax());
+    if (!hD) return 0;
+
+    // copy variable binnings
+    if (x->GetXbins()->GetSize()) hD->GetXaxis()->Set(x->GetNbins(), x->GetXbins()->GetArray());
+    if (y->GetXbins()->GetSize()) hD->GetYaxis()->Set(y->GetNbins(), y->GetXbins()->GetArray());
+    if (z->GetXbins()->GetSize()) hD->GetZaxis()->Set(z->GetNbins(), z->GetXbins()->GetArray());
+
+    // keep the sums of squares of weights
+    if (h->GetSumw2N()) hD->Sumw2();
+
+    return hD;
+}
+
+//______________________________________________________________________________
+Bool_t TCRunHistoStore::IsUpToDate(Int_t first_run, Int_t last_run, Int_t nRun, const Int_t* runs,
+                                   const Char_t* filePat) const
+{
+    // Check if the runs of the store from 'first_run' to 'last_run' are
+    // exactly the 'nRun' runs 'runs' and if their files, constructed by
+    // replacing 'RUN' in 'filePat' by the run number, did not change since
+    // the store was built.
+    // Return kFALSE if the store cannot be used for this run range, otherwise
+    // kTRUE.
+
+    // check store
+    if (!fFile) return kFALSE;
+
+    // find the range of run indices [a, e)
+    Int_t a = 0;
+    while (a < fNRun && fRuns[a] < first_run) a++;
+    Int_t e = a;
+    while (e < fNRun && fRuns[e] <= last_run) e++;
+
+    // check the number of runs
+    if (e - a != nRun) return kFALSE;
+
+    // sort the runs
+    Int_t index[nRun];
+    TMath::Sort(nRun, runs, index, kFALSE);
+
+    // loop over runs
+    for (Int_t i = 0; i < nRun; i++)
+    {
+        // check run
+        if (fRuns[a+i] != runs[index[i]]) return kFALSE;
+
+        // check file
+        TString fn(filePat);
+        fn.ReplaceAll("RUN", TString::Format("%d", fRuns[a+i]));
+        Long64_t size, mtime;
+        GetFileKey(fn.Data(), &size, &mtime);
+        if (size != fSizes[a+i] || mtime != fMTimes[a+i]) return kFALSE;
+    }
+
+    return kTRUE;
+}
+
+//______________________________________________________________________________
+TH1* TCRunHistoStore::GetRunHisto(Int_t index) const
+{
+    // Return the histogram of the 'index'-th run or 0 if it is not stored.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    TH1* h = (TH1*) fFile->Get(TString::Format("Run_%d", fRuns[index]).Data());
+    if (h) h->ResetBit(kMustCleanup);
+
+    return h;
+}
+
+//______________________________________________________________________________
+TH1* TCRunHistoStore::GetCheckpoint(Int_t c) const
+{
+    // Return the sum of the first 'c'*fInterval runs or 0 if it is empty.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    if (c <= 0) return 0;
+
+    TH1* h = (TH1*) fFile->Get(TString::Format("Sum_%d", c).Data());
+    if (h) h->ResetBit(kMustCleanup);
+
+    return h;
+}
+
+//______________________________________________________________________________
+void TCRunHistoStore::AddHisto(TH1*& hSum, TH1* h, Double_t c)
+{
+    // Add the histogram 'h' scaled by 'c' to the sum 'hSum' and destroy it.
+    // The sum is created if 'hSum' is 0.
+
+    // check histogram
+    if (!h) return;
+
+    // first histogram
+    if (!hSum && c == 1)
+    {
+        hSum = h;
+        return;
+    }
+
+    // create empty sum
+    if (!hSum)
+    {
+        hSum = (TH1*) h->Clone();
+        hSum->Reset();
+    }
+
+    // add/subtract bin contents (errors are subtracted as well)
+    if (c == 1) hSum->Add(h);
+    else
+    {
+        Int_t n = hSum->GetNcells();
+        Bool_t sumw2 = hSum->GetSumw2N() && h->GetSumw2N();
+        for (Int_t i = 0; i < n; i++)
+        {
+            hSum->SetBinContent(i, hSum->GetBinContent(i) + c*h->GetBinContent(i));
+            if (sumw2) hSum->GetSumw2()->fArray[i] += c*h->GetSumw2()->fArray[i];
+        }
+        hSum->SetEntries(hSum->GetEntries() + c*h->GetEntries());
+    }
+
+    // clean-up
+    delete h;
+}
+
+//______________________________________________________________________________
+TH1* TCRunHistoStore::GetSum(Int_t first_run, Int_t last_run) const
+{
+    // Return the sum of the histograms of all runs from 'first_run' to
+    // 'last_run'. Return 0 if there is no such run.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    // check store
+    if (!fFile) return 0;
+
+    // find the range of run indices [a, e)
+    Int_t a = 0;
+    while (a < fNRun && fRuns[a] < first_run) a++;
+    Int_t e = a;
+    while (e < fNRun && fRuns[e] <= last_run) e++;
+    if (a >= e) return 0;
+
+    // do not keep histograms in memory
+    Bool_t status = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(kFALSE);
+
+    // find the inner checkpoints
+    Int_t ca = (a + fInterval - 1) / fInterval;
+    Int_t ce = e / fInterval;
+
+    TH1* hSum = 0;
+    if (ca < ce)
+    {
+        // difference of the checkpoints
+        AddHisto(hSum, GetCheckpoint(ce));
+        AddHisto(hSum, GetCheckpoint(ca), -1);
+
+        // runs before the first and after the last checkpoint
+        for (Int_t i = a; i < ca*fInterval; i++) AddHisto(hSum, GetRunHisto(i));
+        for (Int_t i = ce*fInterval; i < e; i++) AddHisto(hSum, GetRunHisto(i));
+
+        // recalculate statistics
+        if (hSum) hSum->ResetStats();
+    }
+    else
+    {
+        // sum up the single runs
+        for (Int_t i = a; i < e; i++) AddHisto(hSum, GetRunHisto(i));
+    }
+
+    // set name
+    if (hSum) hSum->SetName(fHistoName.Data());
+
+    // restore directory status
+    TH1::AddDirectory(status);
+
+    return hSum;
+}
+
+//______________________________________________________________________________
+TH1* TCRunHistoStore::GetSetSum(const Char_t* data, const Char_t* calibration, Int_t set) const
+{
+    // Return the sum of the histograms of all runs of the set 'set' of the
+    // calibration data 'data' and the calibration identifier 'calibration'.
+    // NOTE: the histogram has to be destroyed by the caller.
+
+    TCMySQLManager* m = TCMySQLManager::GetManager();
+
+    return GetSum(m->GetFirstRunOfSet(data, calibration, set),
+                  m->GetLastRunOfSet(data, calibration, set));
+}
+
+//______________________________________________________________________________
+Bool_t TCRunHistoStore::Build(const Char_t* filename, const Char_t* name,
+                              Int_t nRun, const Int_t* runs, const Char_t* filePat,
+                              Int_t interval)
+{
+    // Build the store file 'filename' for the histogram 'name' using the 'nRun'
+    // runs 'runs'. The run files are constructed by replacing 'RUN' in 'filePat'
+    // by the run number. A checkpoint is written every 'interval' runs.
+    // The size and modification time of the run files are recorded.
+    // Return kFALSE if an error occurred, otherwise kTRUE.
+
+    // check arguments
+    if (interval < 1 || !nRun)
+    {
+        Error("Build", "No runs or bad checkpoint interval given!");
+        return kFALSE;
+    }
+
+    // sort runs
+    Int_t index[nRun];
+    TMath::Sort(nRun, runs, index, kFALSE);
+
+    // do not keep histograms in memory
+    Bool_t status = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(kFALSE);
+
+    // create the store file
+    TFile* out = new TFile(filename, "recreate");
+    if (out->IsZombie())
+    {
+        Error("Build", "Could not create the store file '%s'!", filename);
+        delete out;
+        TH1::AddDirectory(status);
+        return kFALSE;
+    }
+
+    // loop over runs
+    TArrayI sorted(nRun);
+    TArrayL64 sizes(nRun);
+    TArrayL64 mtimes(nRun);
+    TH1* hSum = 0;
+    Int_t nAdded = 0;
+    for (Int_t i = 0; i < nRun; i++)
+    {
+        Int_t run = runs[index[i]];
+        sorted[i] = run;
+
+        // write the checkpoint of the preceding runs
+        if (i && i % interval == 0 && hSum)
+        {
+            out->cd();
+            hSum->Write(TString::Format("Sum_%d", i / interval).Data());
+        }
+
+        // record the run file
+        TString fn(filePat);
+        fn.ReplaceAll("RUN", TString::Format("%d", run));
+        GetFileKey(fn.Data(), &sizes[i], &mtimes[i]);
+
+        // open the run file
+        TFile* f = TFile::Open(fn.Data());
+        if (!f || f->IsZombie())
+        {
+            Warning("Build", "Could not open file '%s'", fn.Data());
+            if (f) delete f;
+            continue;
+        }
+
+        // get histogram
+        TH1* h = (TH1*) f->Get(name);
+        if (!h || !h->InheritsFrom("TH1"))
+        {
+            Warning("Build", "Histogram '%s' was not found in file '%s'", name, fn.Data());
+            if (h) delete h;
+            delete f;
+            continue;
+        }
+        h->ResetBit(kMustCleanup);
+
+        // write the run histogram
+        out->cd();
+        h->Write(TString::Format("Run_%d", run).Data());
+
+        // add to the cumulative sum (double precision)
+        if (!hSum) hSum = CreateDoubleHisto(h);
+        if (hSum) hSum->Add(h);
+        delete h;
+        nAdded++;
+
+        // clean-up
+        delete f;
+    }
+
+    // write the last checkpoint
+    out->cd();
+    if (nRun % interval == 0 && hSum) hSum->Write(TString::Format("Sum_%d", nRun / interval).Data());
+
+    // write the store information
+    TArrayI info(2);
+    info[0] = kVersion;
+    info[1] = interval;
+    out->WriteObjectAny(&sorted, "TArrayI", "Runs");
+    out->WriteObjectAny(&sizes, "TArrayL64", "Sizes");
+    out->WriteObjectAny(&mtimes, "TArrayL64", "MTimes");
+    out->WriteObjectAny(&info, "TArrayI", "Info");
+    TNamed hname("HistoName", name);
+    hname.Write();
+
+    // clean-up
+    if (hSum) delete hSum;
+    delete out;
+    TH1::AddDirectory(status);
+
+    // user information
+    Info("Build", "Stored histogram '%s' of %d of %d runs in '%s'", name, nAdded, nRun, filename);
+
+    return kTRUE;
+}
+
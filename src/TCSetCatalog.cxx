@@ -0,0 +1,108 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCSetCatalog                                                         //
+//                                                                      //
+// In-memory catalog of the sets of one calibration data and            //
+// calibration identifier.                                              //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "TMath.h"
+
+#include "TCSetCatalog.h"
+
+ClassImp(TCSetCatalog)
+
+//______________________________________________________________________________
+TCSetCatalog::~TCSetCatalog()
+{
+    // Destructor.
+
+    if (fFirstRun) delete [] fFirstRun;
+    if (fLastRun) delete [] fLastRun;
+    if (fChanged) delete [] fChanged;
+    if (fDesc) delete [] fDesc;
+}
+
+//______________________________________________________________________________
+void TCSetCatalog::AddSet(Int_t first_run, Int_t last_run,
+                          const Char_t* changed, const Char_t* desc)
+{
+    // Append the set with the run range 'first_run' to 'last_run', the change
+    // time 'changed' and the description 'desc' to the catalog.
+    // NOTE: sets have to be added in ascending order of their first run.
+
+    // enlarge arrays if necessary
+    if (fNset == fCapacity)
+    {
+        Int_t cap = fCapacity ? 2*fCapacity : 16;
+
+        Int_t* first = new Int_t[cap];
+        Int_t* last = new Int_t[cap];
+        TString* chg = new TString[cap];
+        TString* dsc = new TString[cap];
+
+        // copy old entries
+        for (Int_t i = 0; i < fNset; i++)
+        {
+            first[i] = fFirstRun[i];
+            last[i] = fLastRun[i];
+            chg[i] = fChanged[i];
+            dsc[i] = fDesc[i];
+        }
+
+        // replace old arrays
+        if (fFirstRun) delete [] fFirstRun;
+        if (fLastRun) delete [] fLastRun;
+        if (fChanged) delete [] fChanged;
+        if (fDesc) delete [] fDesc;
+        fFirstRun = first;
+        fLastRun = last;
+        fChanged = chg;
+        fDesc = dsc;
+        fCapacity = cap;
+    }
+
+    // add the set
+    fFirstRun[fNset] = first_run;
+    fLastRun[fNset] = last_run;
+    fChanged[fNset] = changed ? changed : "";
+    fDesc[fNset] = desc ? desc : "";
+    fNset++;
+}
+
+//______________________________________________________________________________
+Int_t TCSetCatalog::FindSet(Int_t run) const
+{
+    // Return the number of the set the run 'run' belongs to using a binary
+    // search over the sorted set intervals.
+    // Return -1 if there is no such set.
+
+    // check for sets
+    if (!fNset) return -1;
+
+    // find the last set starting before or at the run
+    Long64_t set = TMath::BinarySearch((Long64_t)fNset, fFirstRun, run);
+
+    // check if run is in this set
+    if (set >= 0 && run <= fLastRun[set]) return (Int_t)set;
+    else return -1;
+}
+
+//______________________________________________________________________________
+void TCSetCatalog::Print(Option_t* option) const
+{
+    // Print the content of this class.
+
+    printf("CaLib Set Catalog '%s'\n", GetName());
+    printf("Number of sets : %d\n", fNset);
+    for (Int_t i = 0; i < fNset; i++)
+        printf("Set %3d        : %d to %d (changed %s)\n",
+               i, fFirstRun[i], fLastRun[i], fChanged[i].Data());
+}
+
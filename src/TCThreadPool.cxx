@@ -0,0 +1,245 @@
+/*************************************************************************
+ * Author: Thomas Strub
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+//                                                                      //
+// TCThreadPool                                                         //
+//                                                                      //
+// CaLib thread pool namespace                                          //
+//                                                                      //
+// Runs a number of independent tasks on a pool of worker threads.      //
+// The tasks are handed out in ascending order to the next idle worker. //
+// Callers have to write the results of each task to a task-specific    //
+// location and combine them afterwards in a fixed order to obtain      //
+// results that do not depend on the number of threads.                 //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "TThread.h"
+#include "TMutex.h"
+#include "TFile.h"
+#include "TError.h"
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+#include "TROOT.h"
+#endif
+
+#include "TCThreadPool.h"
+#include "TCReadConfig.h"
+
+// state shared by the workers of one pool run
+struct TCThreadPoolState
+{
+    TCThreadPool::TaskFunc_t fFunc;     // task function
+    void* fArg;                         // user argument
+    Int_t fNTask;                       // number of tasks
+    Int_t fNext;                        // next task to be processed
+    TMutex* fMutex;                     // mutex protecting fNext
+};
+
+// state of a concurrent file opening
+struct TCThreadPoolOpen
+{
+    const TString* fNames;              // file names
+    TFile** fFiles;                     // opened files
+    Int_t* fStatus;                     // file status
+};
+
+//______________________________________________________________________________
+static void TCThreadPoolOpenTask(Int_t task, void* arg)
+{
+    // Open the file of the task 'task'. The key list of the file is read
+    // when opening.
+
+    TCThreadPoolOpen* s = (TCThreadPoolOpen*) arg;
+
+    // try to open the file
+    TFile* f = TFile::Open(s->fNames[task].Data(), "READ");
+
+    // check for non-existing file
+    if (!f)
+    {
+        s->fFiles[task] = 0;
+        s->fStatus[task] = TCThreadPool::kFileNotOpened;
+    }
+    // check for bad file
+    else if (f->IsZombie())
+    {
+        delete f;
+        s->fFiles[task] = 0;
+        s->fStatus[task] = TCThreadPool::kFileZombie;
+    }
+    else
+    {
+        s->fFiles[task] = f;
+        s->fStatus[task] = TCThreadPool::kFileOK;
+    }
+}
+
+//______________________________________________________________________________
+static void* TCThreadPoolWorker(void* arg)
+{
+    // Worker thread function processing tasks until all tasks are done.
+
+    TCThreadPoolState* s = (TCThreadPoolState*) arg;
+
+    for (;;)
+    {
+        // get the next task
+        s->fMutex->Lock();
+        Int_t task = s->fNext++;
+        s->fMutex->UnLock();
+
+        // check if all tasks are done
+        if (task >= s->fNTask) break;
+
+        // process task
+        (*s->fFunc)(task, s->fArg);
+    }
+
+    return 0;
+}
+
+//______________________________________________________________________________
+Int_t TCThreadPool::GetNThreads()
+{
+    // Return the number of worker threads configured via Parallel.Threads.
+    // Return 1 (serial processing) if nothing was configured.
+
+    Int_t n = TCReadConfig::GetReader()->GetConfigInt("Parallel.Threads");
+    return n > 1 ? n : 1;
+}
+
+//______________________________________________________________________________
+Int_t TCThreadPool::GetNIOThreads()
+{
+    // Return the number of threads for I/O bound tasks (e.g. opening files on
+    // a network file system) configured via Parallel.IOThreads. Return the
+    // number of worker threads (see GetNThreads()) if nothing was configured.
+
+    Int_t n = TCReadConfig::GetReader()->GetConfigInt("Parallel.IOThreads");
+    return n > 0 ? n : GetNThreads();
+}
+
+//______________________________________________________________________________
+Int_t TCThreadPool::LimitIOThreads(Int_t nThreads)
+{
+    // Return the number of threads that can be used for tasks reading from
+    // ROOT files when 'nThreads' threads are requested. The configured number
+    // of I/O threads is used if 'nThreads' is negative.
+    // ROOT 5 does not support reading files in several threads (the global
+    // directory and the streamer infos are shared even after
+    // TThread::Initialize()), so 1 is returned in this case.
+
+    // get number of threads
+    if (nThreads < 0) nThreads = GetNIOThreads();
+
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,0,0)
+    // refuse multi-threaded I/O
+    if (nThreads > 1)
+    {
+        static Bool_t warned = kFALSE;
+        if (!warned)
+            Warning("TCThreadPool::LimitIOThreads", "Reading files in several threads requires ROOT 6 - using one thread");
+        warned = kTRUE;
+        nThreads = 1;
+    }
+#endif
+
+    return nThreads;
+}
+
+//______________________________________________________________________________
+void TCThreadPool::EnableThreadSafety()
+{
+    // Enable the thread-safety of ROOT (global mutexes, thread-local
+    // gDirectory etc.). Has to be called before objects are read from files
+    // in several threads.
+
+    static Bool_t enabled = kFALSE;
+    if (enabled) return;
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+    ROOT::EnableThreadSafety();
+#else
+    TThread::Initialize();
+#endif
+    enabled = kTRUE;
+}
+
+//______________________________________________________________________________
+void TCThreadPool::Run(Int_t nTask, TaskFunc_t func, void* arg, Int_t nThreads)
+{
+    // Call the task function 'func' with the user argument 'arg' for the tasks
+    // 0 to 'nTask'-1 using 'nThreads' worker threads. The configured number of
+    // threads is used if 'nThreads' is negative. The tasks are processed
+    // serially in the calling thread if less than two threads are requested.
+
+    // get number of threads
+    if (nThreads < 0) nThreads = GetNThreads();
+    if (nThreads > nTask) nThreads = nTask;
+
+    // serial processing
+    if (nThreads < 2)
+    {
+        for (Int_t i = 0; i < nTask; i++) (*func)(i, arg);
+        return;
+    }
+
+    // init ROOT for threads
+    EnableThreadSafety();
+
+    // init shared state
+    TMutex mutex;
+    TCThreadPoolState s;
+    s.fFunc = func;
+    s.fArg = arg;
+    s.fNTask = nTask;
+    s.fNext = 0;
+    s.fMutex = &mutex;
+
+    // start the workers
+    TThread* threads[nThreads];
+    for (Int_t i = 0; i < nThreads; i++)
+    {
+        threads[i] = new TThread(TCThreadPoolWorker, &s);
+        threads[i]->Run();
+    }
+
+    // wait for the workers
+    for (Int_t i = 0; i < nThreads; i++)
+    {
+        threads[i]->Join();
+        delete threads[i];
+    }
+}
+
+//______________________________________________________________________________
+void TCThreadPool::OpenFiles(Int_t nFile, const TString* names, TFile** outFiles,
+                             Int_t* outStatus, Int_t nThreads)
+{
+    // Open the 'nFile' files 'names' concurrently using 'nThreads' threads and
+    // save them in the order of the names to 'outFiles'. The status of each
+    // file (see EFileStatus) is saved to 'outStatus'. Files that could not be
+    // opened or are zombies are set to 0. The configured number of I/O threads
+    // is used if 'nThreads' is negative (see also LimitIOThreads()).
+    // NOTE: the current directory is not changed.
+
+    // get number of threads
+    nThreads = LimitIOThreads(nThreads);
+
+    // save the current directory, since it will be changed when opening the files
+    TDirectory* currdir = gDirectory;
+
+    // open the files
+    TCThreadPoolOpen s;
+    s.fNames = names;
+    s.fFiles = outFiles;
+    s.fStatus = outStatus;
+    Run(nFile, TCThreadPoolOpenTask, &s, nThreads);
+
+    // recover the current directory
+    if (currdir) currdir->cd();
+}
+
@@ -19,9 +19,115 @@
 #include "TCWriteARCalib.h"
 #include "TCMySQLManager.h"
 #include "TCReadARCalib.h"
+#include "TCCalibData.h"
 
 ClassImp(TCWriteARCalib)
 
+// values of the calibration file set from the calibration data
+enum EARCalibSetter
+{
+    kARCalib_Offset,
+    kARCalib_TDCGain,
+    kARCalib_Pedestal,
+    kARCalib_ADCGain,
+    kARCalib_EnergyLow,
+    kARCalib_Z,
+    kARCalib_TW_Par0,
+    kARCalib_TW_Par1,
+    kARCalib_TW_Par2,
+    kARCalib_TW_Par3,
+    kARCalib_SG_Pedestal,
+    kARCalib_SG_ADCGain
+};
+
+// calibration data written to the calibration file of a detector
+struct TCARCalibEntry
+{
+    CalibDetector_t fDetector;              // detector
+    const Char_t* fData;                    // calibration data
+    EARCalibSetter fSetter;                 // value set from the data
+};
+
+static const TCARCalibEntry kARCalibTable[] =
+{
+    { kDETECTOR_TAGG,  "Data.Tagger.T0",    kARCalib_Offset      },
+    { kDETECTOR_CB,    "Data.CB.T0",        kARCalib_Offset      },
+    { kDETECTOR_CB,    "Data.CB.E1",        kARCalib_ADCGain     },
+    { kDETECTOR_CB,    "Data.CB.Walk.Par0", kARCalib_TW_Par0     },
+    { kDETECTOR_CB,    "Data.CB.Walk.Par1", kARCalib_TW_Par1     },
+    { kDETECTOR_CB,    "Data.CB.Walk.Par2", kARCalib_TW_Par2     },
+    { kDETECTOR_CB,    "Data.CB.Walk.Par3", kARCalib_TW_Par3     },
+    { kDETECTOR_TAPS,  "Data.TAPS.T0",      kARCalib_Offset      },
+    { kDETECTOR_TAPS,  "Data.TAPS.T1",      kARCalib_TDCGain     },
+    { kDETECTOR_TAPS,  "Data.TAPS.LG.E0",   kARCalib_Pedestal    },
+    { kDETECTOR_TAPS,  "Data.TAPS.LG.E1",   kARCalib_ADCGain     },
+    { kDETECTOR_TAPS,  "Data.TAPS.CFD",     kARCalib_EnergyLow   },
+    { kDETECTOR_TAPS,  "Data.TAPS.SG.E0",   kARCalib_SG_Pedestal },
+    { kDETECTOR_TAPS,  "Data.TAPS.SG.E1",   kARCalib_SG_ADCGain  },
+    { kDETECTOR_PID,   "Data.PID.Phi",      kARCalib_Z           },
+    { kDETECTOR_PID,   "Data.PID.T0",       kARCalib_Offset      },
+    { kDETECTOR_PID,   "Data.PID.E0",       kARCalib_Pedestal    },
+    { kDETECTOR_PID,   "Data.PID.E1",       kARCalib_ADCGain     },
+    { kDETECTOR_VETO,  "Data.Veto.T0",      kARCalib_Offset      },
+    { kDETECTOR_VETO,  "Data.Veto.T1",      kARCalib_TDCGain     },
+    { kDETECTOR_VETO,  "Data.Veto.E0",      kARCalib_Pedestal    },
+    { kDETECTOR_VETO,  "Data.Veto.E1",      kARCalib_ADCGain     },
+    { kDETECTOR_VETO,  "Data.Veto.LED",     kARCalib_EnergyLow   },
+    { kDETECTOR_PIZZA, "Data.Pizza.Phi",    kARCalib_Z           },
+    { kDETECTOR_PIZZA, "Data.Pizza.T0",     kARCalib_Offset      },
+    { kDETECTOR_PIZZA, "Data.Pizza.E0",     kARCalib_Pedestal    },
+    { kDETECTOR_PIZZA, "Data.Pizza.E1",     kARCalib_ADCGain     }
+};
+static const Int_t kNARCalibEntries = sizeof(kARCalibTable) / sizeof(TCARCalibEntry);
+
+// maximum number of calibration data of one detector
+static const Int_t kNARCalibMaxData = 10;
+
+//______________________________________________________________________________
+static Int_t GetARCalibLength(EARCalibSetter s, Int_t nDet, Int_t nDetTW, Int_t nDetSG)
+{
+    // Return the number of values set by the setter 's' using the number of
+    // elements 'nDet', time walks 'nDetTW' and TAPS SG elements 'nDetSG'.
+
+    switch (s)
+    {
+        case kARCalib_TW_Par0:
+        case kARCalib_TW_Par1:
+        case kARCalib_TW_Par2:
+        case kARCalib_TW_Par3:
+            return nDetTW;
+        case kARCalib_SG_Pedestal:
+        case kARCalib_SG_ADCGain:
+            return nDetSG;
+        default:
+            return nDet;
+    }
+}
+
+//______________________________________________________________________________
+static void SetARCalibValue(EARCalibSetter s, TCReadARCalib* r, TCReadARCalib* rSG,
+                            Int_t i, Double_t v)
+{
+    // Set the value 'v' of the i-th element using the setter 's'. Elements and
+    // time walks are taken from 'r', TAPS SG elements from 'rSG'.
+
+    switch (s)
+    {
+        case kARCalib_Offset:      r->GetElement(i)->SetOffset(v);      break;
+        case kARCalib_TDCGain:     r->GetElement(i)->SetTDCGain(v);     break;
+        case kARCalib_Pedestal:    r->GetElement(i)->SetPedestal(v);    break;
+        case kARCalib_ADCGain:     r->GetElement(i)->SetADCGain(v);     break;
+        case kARCalib_EnergyLow:   r->GetElement(i)->SetEnergyLow(v);   break;
+        case kARCalib_Z:           r->GetElement(i)->SetZ(v);           break;
+        case kARCalib_TW_Par0:     r->GetTimeWalk(i)->SetPar0(v);       break;
+        case kARCalib_TW_Par1:     r->GetTimeWalk(i)->SetPar1(v);       break;
+        case kARCalib_TW_Par2:     r->GetTimeWalk(i)->SetPar2(v);       break;
+        case kARCalib_TW_Par3:     r->GetTimeWalk(i)->SetPar3(v);       break;
+        case kARCalib_SG_Pedestal: rSG->GetElement(i)->SetPedestal(v);  break;
+        case kARCalib_SG_ADCGain:  rSG->GetElement(i)->SetADCGain(v);   break;
+    }
+}
+
 //______________________________________________________________________________
 TCWriteARCalib::TCWriteARCalib(CalibDetector_t det, const Char_t* templateFile)
 {
@@ -58,157 +164,60 @@ void TCWriteARCalib::Write(const Char_t* calibFile,
     Int_t nDetSG = 0;
     if (rSG) nDetSG = rSG->GetNelements();
 
-    // create parameter array
-    Double_t par[nDet];
-
-    // check the detetector
-    switch (fDetector)
+    // collect the calibration data of the detector
+    const Char_t* data[kNARCalibMaxData];
+    Int_t length[kNARCalibMaxData];
+    EARCalibSetter setter[kNARCalibMaxData];
+    Int_t nData = 0;
+    for (Int_t i = 0; i < kNARCalibEntries; i++)
     {
-        case kDETECTOR_TAGG:
-        {
-            // read time offset
-            if (m->ReadParametersRun("Data.Tagger.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
+        const TCARCalibEntry& e = kARCalibTable[i];
 
-            break;
+        // skip data of other detectors
+        if (e.fDetector != fDetector) continue;
 
-        }
-        case kDETECTOR_CB:
-        {
-            // read time offset
-            if (m->ReadParametersRun("Data.CB.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
-
-            // read ADC gain
-            if (m->ReadParametersRun("Data.CB.E1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetADCGain(par[i]);
-
-            if (nDetTW)
-            {
-                // read time walk parameter 0
-                if (m->ReadParametersRun("Data.CB.Walk.Par0", calibration, run, par, nDetTW))
-                    for (Int_t i = 0; i < nDetTW; i++) r->GetTimeWalk(i)->SetPar0(par[i]);
-
-                // read time walk parameter 1
-                if (m->ReadParametersRun("Data.CB.Walk.Par1", calibration, run, par, nDetTW))
-                    for (Int_t i = 0; i < nDetTW; i++) r->GetTimeWalk(i)->SetPar1(par[i]);
-
-                // read time walk parameter 2
-                if (m->ReadParametersRun("Data.CB.Walk.Par2", calibration, run, par, nDetTW))
-                    for (Int_t i = 0; i < nDetTW; i++) r->GetTimeWalk(i)->SetPar2(par[i]);
-
-                // read time walk parameter 3
-                if (m->ReadParametersRun("Data.CB.Walk.Par3", calibration, run, par, nDetTW))
-                    for (Int_t i = 0; i < nDetTW; i++) r->GetTimeWalk(i)->SetPar3(par[i]);
-            }
-
-            break;
-        }
-        case kDETECTOR_TAPS:
-        {
-            // read time offset
-            if (m->ReadParametersRun("Data.TAPS.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
-
-            // read TDC gain
-            if (m->ReadParametersRun("Data.TAPS.T1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetTDCGain(par[i]);
-
-            // read ADC pedestal
-            if (m->ReadParametersRun("Data.TAPS.LG.E0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetPedestal(par[i]);
-
-            // read ADC gain
-            if (m->ReadParametersRun("Data.TAPS.LG.E1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetADCGain(par[i]);
-
-            // read CFD threshold
-            if (m->ReadParametersRun("Data.TAPS.CFD", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetEnergyLow(par[i]);
-
-            if (nDetSG)
-            {
-                // read SG ADC pedestal
-                if (m->ReadParametersRun("Data.TAPS.SG.E0", calibration, run, par, nDetSG))
-                    for (Int_t i = 0; i < nDetSG; i++) rSG->GetElement(i)->SetPedestal(par[i]);
-
-                // read SG ADC gain
-                if (m->ReadParametersRun("Data.TAPS.SG.E1", calibration, run, par, nDetSG))
-                    for (Int_t i = 0; i < nDetSG; i++) rSG->GetElement(i)->SetADCGain(par[i]);
-            }
-
-            break;
-        }
-        case kDETECTOR_PID:
-        {
-            // read phi angle
-            if (m->ReadParametersRun("Data.PID.Phi", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetZ(par[i]);
-
-            // read time offset
-            if (m->ReadParametersRun("Data.PID.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
-
-            // read ADC pedestal
-            if (m->ReadParametersRun("Data.PID.E0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetPedestal(par[i]);
+        // get the number of values in the template
+        Int_t n = GetARCalibLength(e.fSetter, nDet, nDetTW, nDetSG);
+        if (!n) continue;
 
-            // read ADC gain
-            if (m->ReadParametersRun("Data.PID.E1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetADCGain(par[i]);
-
-            break;
-        }
-        case kDETECTOR_VETO:
+        // check the number of values against the data table
+        TCCalibData* d = m->GetCalibData(e.fData);
+        if (!d) continue;
+        if (n > d->GetSize())
         {
-            // read time offset
-            if (m->ReadParametersRun("Data.Veto.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
-
-            // read TDC gain
-            if (m->ReadParametersRun("Data.Veto.T1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetTDCGain(par[i]);
-
-            // read ADC pedestal
-            if (m->ReadParametersRun("Data.Veto.E0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetPedestal(par[i]);
-
-            // read ADC gain
-            if (m->ReadParametersRun("Data.Veto.E1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetADCGain(par[i]);
-
-            // read LED thresholds
-            if (m->ReadParametersRun("Data.Veto.LED", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetEnergyLow(par[i]);
-
-            break;
+            Error("Write", "Template has %d values for '%s' but the data has only %d parameters - skipping!",
+                  n, e.fData, d->GetSize());
+            continue;
         }
-        case kDETECTOR_PIZZA:
-        {
-            // read phi angle
-            if (m->ReadParametersRun("Data.Pizza.Phi", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetZ(par[i]);
 
-            // read time offset
-            if (m->ReadParametersRun("Data.Pizza.T0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetOffset(par[i]);
+        // add data
+        data[nData] = e.fData;
+        length[nData] = n;
+        setter[nData++] = e.fSetter;
+    }
 
-            // read ADC pedestal
-            if (m->ReadParametersRun("Data.Pizza.E0", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetPedestal(par[i]);
+    // create parameter arrays
+    Double_t* par[kNARCalibMaxData];
+    Bool_t isRead[kNARCalibMaxData];
+    for (Int_t i = 0; i < nData; i++) par[i] = new Double_t[length[i]];
 
-            // read ADC gain
-            if (m->ReadParametersRun("Data.Pizza.E1", calibration, run, par, nDet))
-                for (Int_t i = 0; i < nDet; i++) r->GetElement(i)->SetADCGain(par[i]);
+    // read all parameters at once
+    if (nData) m->ReadParametersRunMulti(nData, data, calibration, run, par, length, isRead);
 
-            break;
-        }
-        case kDETECTOR_NODET:
-        {
-            break;
-        }
+    // set the parameters
+    for (Int_t i = 0; i < nData; i++)
+    {
+        // skip data that could not be read
+        if (!isRead[i]) continue;
+
+        // set the values
+        for (Int_t j = 0; j < length[i]; j++)
+            SetARCalibValue(setter[i], r, rSG, j, par[i][j]);
     }
 
+    // clean-up
+    for (Int_t i = 0; i < nData; i++) delete [] par[i];
+
     // open the template file
     std::ifstream ftemp;
     ftemp.open(fTemplate);